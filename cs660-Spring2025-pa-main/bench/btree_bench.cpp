@@ -0,0 +1,93 @@
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A YCSB-like benchmark for concurrent BTreeFile access.
+ *
+ * Usage: btree_bench [records] [operations per thread] [max threads] [olc|blink]
+ *
+ * For every thread count (1, 2, 4, ... up to max threads) the benchmark loads `records` keys into a fresh tree with
+ * all threads inserting disjoint keys, then runs the YCSB core workloads on it with uniformly chosen keys:
+ *   C: 100% reads, B: 95% reads and 5% updates, A: 50% reads and 50% updates.
+ * Updates insert an existing key with a new value. Records are two INT columns, so that the default data set stays
+ * resident in the buffer pool and the benchmark measures latching rather than I/O. The last argument selects the
+ * concurrency protocol of the tree (see BTreeOptions).
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename Body>
+    double run(size_t num_threads, size_t ops_per_thread, const Body &body) {
+        std::vector<std::thread> threads;
+        auto start = Clock::now();
+        for (size_t t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t] { body(t); });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return num_threads * ops_per_thread / elapsed.count() / 1e6;
+    }
+
+    double workload(db::BTreeFile &file, size_t num_threads, size_t records, size_t ops, int update_percent) {
+        return run(num_threads, ops, [&](size_t t) {
+            std::mt19937_64 rng(t + 1);
+            std::uniform_int_distribution<int> key(0, static_cast<int>(records) - 1);
+            std::uniform_int_distribution<int> percent(0, 99);
+            size_t found = 0;
+            for (size_t i = 0; i < ops; i++) {
+                int k = key(rng);
+                if (percent(rng) < update_percent) {
+                    file.insertTuple({{k, static_cast<int>(i)}});
+                } else {
+                    found += file.find(k).has_value();
+                }
+            }
+            if (update_percent < 100 && found == 0) {
+                std::fprintf(stderr, "no key found\n");
+            }
+        });
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? std::stoul(argv[1]) : 8000;
+    size_t ops = argc > 2 ? std::stoul(argv[2]) : 200000;
+    size_t max_threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    db::BTreeOptions options{.blink = argc > 4 && std::string(argv[4]) == "blink"};
+
+    db::TupleDesc td({db::type_t::INT, db::type_t::INT}, {"key", "value"});
+    std::printf("records=%zu ops/thread=%zu protocol=%s (Mops/s)\n", records, ops, options.blink ? "blink" : "olc");
+    std::printf("%8s %10s %10s %10s %10s\n", "threads", "load", "C", "B", "A");
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        std::string name = "btree_bench.db";
+        std::remove(name.c_str());
+        db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, options));
+        auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+
+        size_t per_thread = records / num_threads;
+        double load = run(num_threads, per_thread, [&](size_t t) {
+            for (size_t i = 0; i < per_thread; i++) {
+                int k = static_cast<int>(i * num_threads + t);
+                file.insertTuple({{k, k}});
+            }
+        });
+        size_t loaded = per_thread * num_threads;
+        double c = workload(file, num_threads, loaded, ops, 0);
+        double b = workload(file, num_threads, loaded, ops, 5);
+        double a = workload(file, num_threads, loaded, ops, 50);
+        std::printf("%8zu %10.3f %10.3f %10.3f %10.3f\n", num_threads, load, c, b, a);
+
+        db::getDatabase().remove(name);
+        std::remove(name.c_str());
+    }
+    return 0;
+}
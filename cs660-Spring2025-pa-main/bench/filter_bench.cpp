@@ -0,0 +1,69 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/**
+ * Compares filtering a HeapFile on an INT column by deserializing every tuple against pushing the predicate down
+ * into the scan, where it is evaluated on the page bytes (see Selection).
+ *
+ * Usage: filter_bench [records] [scans]
+ *
+ * Tuples have an INT, a DOUBLE and a CHAR field. The predicate `value < 10` selects 1% of them and the values are
+ * spread over every page, so the zone map cannot skip any page.
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename Body>
+    double measure(size_t records, size_t scans, const Body &body) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < scans; i++) {
+            body();
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return records * scans / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t scans = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    db::TupleDesc td({db::type_t::INT, db::type_t::DOUBLE, db::type_t::CHAR}, {"value", "price", "name"});
+    const char *name = "filter_bench.heap";
+    std::remove(name);
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    auto &heap = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    size_t expected = 0;
+    for (size_t i = 0; i < records; i++) {
+        int value = static_cast<int>(i * 7919 % 1000);
+        heap.insertTuple({{value, i * 0.5, "name"}});
+        expected += value < 10;
+    }
+    db::Predicate predicate{0, db::op_t::LT, 10};
+
+    size_t tuple_rows = 0;
+    double tuples = measure(records, scans, [&] {
+        for (auto it = heap.begin(); it != heap.end(); ++it) {
+            tuple_rows += predicate.matches(*it);
+        }
+    });
+    size_t pushed_rows = 0;
+    double pushed = measure(records, scans, [&] {
+        heap.scanViews({predicate}, [&](const db::TupleView &) { pushed_rows++; });
+    });
+    if (tuple_rows != expected * scans || pushed_rows != tuple_rows) {
+        std::fprintf(stderr, "wrong count\n");
+        return 1;
+    }
+
+    std::printf("records=%zu pages=%zu scans=%zu (Mrows/s)\n", records, heap.getNumPages(), scans);
+    std::printf("%8s %10.3f\n%8s %10.3f\n", "tuple", tuples, "pushdown", pushed);
+
+    db::getDatabase().remove(name);
+    std::remove(name);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/PaxFile.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/**
+ * Compares SUM over an INT column for row (HeapFile) and PAX (PaxFile) pages.
+ *
+ * Usage: pax_bench [records] [scans]
+ *
+ * Tuples have two INT, one DOUBLE and two CHAR fields, 144 bytes in total, so the summed column is a small fraction
+ * of every row. The default number of records fits in the buffer pool, so the scans measure how many bytes pass
+ * through the CPU caches rather than I/O. Both files are scanned `scans` times through their scan API.
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename Body>
+    double measure(size_t records, size_t scans, const Body &body) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < scans; i++) {
+            body();
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return records * scans / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t scans = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    db::TupleDesc td({db::type_t::INT, db::type_t::INT, db::type_t::DOUBLE, db::type_t::CHAR, db::type_t::CHAR},
+                     {"id", "value", "price", "name", "comment"});
+    const char *heap_name = "pax_bench.heap";
+    const char *pax_name = "pax_bench.pax";
+    std::remove(heap_name);
+    std::remove(pax_name);
+    db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, td));
+    db::getDatabase().add(std::make_unique<db::PaxFile>(pax_name, td));
+    auto &heap = dynamic_cast<db::HeapFile &>(db::getDatabase().get(heap_name));
+    auto &pax = dynamic_cast<db::PaxFile &>(db::getDatabase().get(pax_name));
+    long expected = 0;
+    for (size_t i = 0; i < records; i++) {
+        int value = static_cast<int>(i % 1000);
+        db::Tuple t({static_cast<int>(i), value, i * 0.5, "name" + std::to_string(i), "comment"});
+        heap.insertTuple(t);
+        pax.insertTuple(t);
+        expected += value;
+    }
+
+    long row_sum = 0;
+    double row = measure(records, scans, [&] {
+        heap.scanViews({}, [&](const db::TupleView &t) { row_sum += t.getInt(1); });
+    });
+    long pax_sum = 0;
+    double columnar = measure(records, scans, [&] {
+        pax.scanColumn(1, [&](const uint8_t *value) {
+            int v;
+            std::memcpy(&v, value, sizeof(v));
+            pax_sum += v;
+        });
+    });
+    if (row_sum != expected * static_cast<long>(scans) || pax_sum != row_sum) {
+        std::fprintf(stderr, "wrong sum\n");
+        return 1;
+    }
+
+    std::printf("records=%zu pages=%zu scans=%zu (Mrows/s)\n", records, heap.getNumPages(), scans);
+    std::printf("%8s %10.3f\n%8s %10.3f\n", "row", row, "pax", columnar);
+
+    db::getDatabase().remove(heap_name);
+    db::getDatabase().remove(pax_name);
+    std::remove(heap_name);
+    std::remove(pax_name);
+    return 0;
+}
@@ -1,34 +1,240 @@
 #pragma once
 
+#include <db/BloomFilter.hpp>
+#include <db/BufferPool.hpp>
 #include <db/DbFile.hpp>
+#include <db/Key.hpp>
+#include <memory>
+#include <optional>
 
 namespace db {
 
-    class BTreeFile : public DbFile {
-        static constexpr size_t root_id = 0;
-        size_t key_index;
+    template<typename Key>
+    struct BasicLeafPage;
+
+    template<typename Key>
+    struct BasicIndexPage;
+
+    /**
+     * @brief Options of a BTreeFile
+     * @note The options describe the page layout, so a file has to be opened with the options it was created with.
+     */
+    struct BTreeOptions {
+        /**
+         * Use Lehman-Yao B-link trees instead of optimistic lock coupling. Index pages keep a high key and a right link
+         * and leaves use `LeafPageHeader::next_leaf`, so a reader that lands on a page that was split concurrently
+         * moves right instead of restarting from the root, and never waits for a split to reach the parent.
+         */
+        bool blink = false;
+
+        /**
+         * Keep tuples with equal keys instead of replacing them. Tuples with equal keys are stored side by side in
+         * insertion order and may span several leaves, so lookups start at the leftmost leaf that may hold the key.
+         * Not supported together with `blink`.
+         */
+        bool duplicates = false;
+
+        /**
+         * Store the keys of a leaf as the difference from the smallest key its parent allows, in as few bytes as the
+         * key range of the leaf needs (frame-of-reference encoding). Leaves deep in a dense tree cover narrow ranges,
+         * so their keys take one or two bytes instead of four and more tuples fit in a page. Compressed leaves hand
+         * out tuples decoded into a buffer instead of views into the page. Only for `BTreeFile` with fixed-length
+         * tuples and without `duplicates`.
+         */
+        bool compress = false;
+
+        /**
+         * The number of bytes of a page, see validPageSize. Larger pages raise the fanout of the index pages, so the
+         * tree gets shallower and a lookup reads fewer pages, at the cost of reading and writing more bytes per page.
+         */
+        size_t page_size = DEFAULT_PAGE_SIZE;
+    };
+
+    /**
+     * @brief Counters of the Bloom filter of a BTreeFile
+     */
+    struct BloomFilterStats {
+        /// The number of lookups checked against the filter
+        size_t probes = 0;
+
+        /// The number of lookups answered from the filter without accessing a page
+        size_t negatives = 0;
+
+        /// The number of lookups that passed the filter but found no tuple
+        size_t false_positives = 0;
+
+        /// The measured fraction of lookups for missing keys that passed the filter
+        double false_positive_rate = 0;
+
+        /// The false positive rate expected from the fill of the filter
+        double estimated_false_positive_rate = 0;
+    };
 
+    /**
+     * @brief A B+tree file ordered by a key of type `Key`
+     * @details `Key` is `int`, `double` or `NormalizedKey`. `int` and `double` keys are stored natively in the index
+     * pages, while `NormalizedKey` covers CHAR and composite keys using their memcmp-able encoding.
+     *
+     * The tree can be used by several threads at once. It uses optimistic lock coupling: every page has a version
+     * latch (see OptLatch), readers never lock and instead validate the versions of the pages they read, restarting
+     * if a writer got in between. Inserts lock the leaf they modify, and lock a parent only to split one of its
+     * children. Full inner nodes are split on the way down so that a split never propagates further than one level.
+     * Iterators are not isolated from concurrent inserts: a split may move tuples past an open iterator.
+     *
+     * With `BTreeOptions::blink` the tree uses B-link semantics instead: readers validate each page on its own and move
+     * right when a key is beyond the page, writers lock one page at a time and post splits to the parent afterwards.
+     */
+    template<typename Key>
+    class BasicBTreeFile : public DbFile {
     public:
+        using key_type = typename KeyTraits<Key>::key_type;
+
+    private:
+        static constexpr size_t root_id = 0;
+        KeyDesc kd;
+        size_t key_size;
+        BTreeOptions options;
+
+        std::unique_ptr<BloomFilter> bloom;
+        size_t bloom_bits_per_key = 0;
+        mutable std::atomic<size_t> bloom_probes = 0;
+        mutable std::atomic<size_t> bloom_negatives = 0;
+        mutable std::atomic<size_t> bloom_false_positives = 0;
+
+        bool tryInsert(const Tuple &t, const key_type &key);
+
+        void insertBLink(const Tuple &t, const key_type &key);
+
+        size_t descendBLink(const key_type &key, std::vector<size_t> &path);
+
+        PinnedPage lockParent(std::vector<size_t> &path, size_t child, const key_type &key, size_t level);
+
+        void splitRoot(PinnedPage &root);
+
+        std::optional<Tuple> findBLink(const key_type &key) const;
 
+        bool findLeaf(const key_type *key, PinnedPage &leaf, uint64_t &version) const;
+
+        bool tryFind(const key_type &key, std::optional<Tuple> &result) const;
+
+        void skipExhausted(Iterator &it) const;
+
+        class LeafCursor;
+
+        /// Interpret a page as a leaf with the layout of this tree
+        BasicLeafPage<Key> leafPage(Page &page) const;
+
+        /// Interpret a page as an index page with the layout of this tree
+        BasicIndexPage<Key> indexPage(Page &page) const;
+
+    public:
         /**
          * @brief Initialize a BTreeFile
          *
          * @param key_index the index of the key in the tuple
+         * @param options the layout and concurrency options of the tree
+         * @throws std::logic_error if the key field type does not match `Key`, or the options are not supported
+         */
+        BasicBTreeFile(const std::string &name, const TupleDesc &td, size_t key_index, const BTreeOptions &options = {});
+
+        /**
+         * @brief Initialize a BTreeFile with a key made of one or more fields
+         *
+         * @param key_indices the indices of the key fields, most significant first
+         * @param options the layout and concurrency options of the tree
+         * @throws std::logic_error if the key fields do not match `Key`, or the options are not supported
+         */
+        BasicBTreeFile(const std::string &name, const TupleDesc &td, const std::vector<size_t> &key_indices,
+                       const BTreeOptions &options = {});
+
+        /**
+         * @brief Get the fields that form the key
+         */
+        const KeyDesc &getKeyDesc() const;
+
+        /**
+         * @brief Keep a Bloom filter of the keys in memory
+         * @details The filter is built from the tuples in the file and updated by every insert. From then on, find()
+         * answers most lookups for missing keys without accessing a page. Deleted keys stay in the filter until it is
+         * rebuilt by another call or by bulkLoad().
+         * @param expected_keys the number of keys to size the filter for, at least the number of tuples in the file
+         * @param bits_per_key the number of bits per key; 10 bits give about 1% false positives
+         * @note Not safe to call while other threads use the file.
+         */
+        void enableBloomFilter(size_t expected_keys = 0, size_t bits_per_key = 10);
+
+        /**
+         * @brief Drop the Bloom filter
+         * @note Not safe to call while other threads use the file.
          */
-        BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index);
+        void disableBloomFilter();
+
+        /**
+         * @brief Get the counters of the Bloom filter since it was enabled
+         */
+        BloomFilterStats getBloomFilterStats() const;
 
         /**
          * @brief Insert a tuple into the file
          * @details Insert a tuple into the file. Traverse the BTree from the root to find the leaf node to insert the tuple.
-         * If the leaf node is full, split the node and insert the new key and child to the parent node. This process is repeated
-         * until no more split is needed. If the root node is split, create a create two new nodes with the contents of the root
-         * and set the root to be the parent of the two new nodes.
+         * Index nodes on the path that would be filled by one more key are split on the way down and the traversal
+         * restarts, so the parent of a leaf always has room. If the leaf node is full, split the node and insert the new
+         * key and child to the parent node. If the root node is split, create a create two new nodes with the contents of
+         * the root and set the root to be the parent of the two new nodes.
          * @param t the tuple to insert
          */
         void insertTuple(const Tuple &t) override;
 
+        /**
+         * @brief Delete the tuple an iterator points to
+         * @details The tuple is removed from its leaf. Leaves are never merged, so a leaf may become empty.
+         * @param it the iterator that identifies the tuple to be deleted
+         * @throws std::runtime_error if the slot is not occupied
+         */
         void deleteTuple(const Iterator &it) override;
 
+        /**
+         * @brief Delete the tuple with the given key
+         * @param key the key to delete
+         * @return true if a tuple was deleted
+         */
+        bool erase(const key_type &key);
+
+        /**
+         * @brief Fill an empty tree from tuples sorted by key
+         * @details The leaves are written left to right and the index levels are built bottom-up, without searching the
+         * tree for every tuple. Pages are filled up to one entry below their capacity, so that the first inserts do
+         * not split them right away. A Bloom filter is rebuilt for the loaded keys.
+         * @param tuples the tuples in ascending key order, strictly ascending unless the tree keeps duplicates
+         * @throws std::logic_error if the tree is not empty or the tuples are not sorted
+         */
+        void bulkLoad(const std::vector<Tuple> &tuples);
+
+        /**
+         * @brief Get an iterator to the first tuple whose key is not less than the given key
+         * @details With a NormalizedKey made of the leading fields of the key, this is the first tuple with that prefix.
+         * @param key the key to look up
+         * @return the iterator, or end() if all keys are smaller
+         */
+        Iterator lowerBound(const key_type &key) const;
+
+        /**
+         * @brief Find the tuple with the given key
+         * @details Traverse the tree from the root to the leaf responsible for the key without taking any latch. With a
+         * Bloom filter, a key that is not in the filter is reported missing without traversing the tree.
+         * @param key the key to look up
+         * @return the tuple (the first one inserted if the tree keeps duplicates), or std::nullopt if no tuple has
+         * this key
+         */
+        std::optional<Tuple> find(const key_type &key) const;
+
+        /**
+         * @brief Find all tuples with the given key
+         * @param key the key to look up
+         * @return the tuples in insertion order, at most one unless the tree keeps duplicates
+         */
+        std::vector<Tuple> findAll(const key_type &key) const;
+
         /**
          * @brief Get a tuple from the database file.
          * @details Get a tuple from the database file by reading the tuple from the page.
@@ -37,6 +243,18 @@ namespace db {
          */
         Tuple getTuple(const Iterator &it) const override;
 
+        void getTuple(const Iterator &it, Tuple &t) const override;
+
+        /**
+         * @brief Get a view of a tuple inside its leaf
+         * @details The slot is validated against the leaf, but the view itself is not protected from concurrent
+         * writers: it may change under the reader if another thread modifies the leaf.
+         * @note With `BTreeOptions::compress`, the view owns a copy of the decoded tuple instead, so each view stays
+         * valid on its own; getting it allocates.
+         * @throws std::runtime_error if the slot is not occupied
+         */
+        TupleView getView(const Iterator &it) const override;
+
         /**
          * @brief Advance the iterator to the next tuple.
          * @details Advance the iterator to the next tuple by moving to the next slot of the page.
@@ -45,6 +263,8 @@ namespace db {
          */
         void next(Iterator &it) const override;
 
+        bool nextBatch(Iterator &it, Batch &batch) const override;
+
         /**
          * @brief Get the iterator to the first tuple of the leftmost leaf (head).
          * @details Traverse the tree to reach the head leaf and return the first tuple.
@@ -58,5 +278,27 @@ namespace db {
          * @return The iterator to the end of the file.
          */
         Iterator end() const override;
+
+        /**
+         * @brief Open a cursor on the first tuple that keeps its leaf pinned
+         * @details Like an Iterator, the cursor validates the leaf size against concurrent writers but is not isolated
+         * from them.
+         */
+        std::unique_ptr<Cursor> cursor() const override;
     };
+
+    using BTreeFile = BasicBTreeFile<int>;
+
+    /**
+     * @brief Open a tree the way it was created
+     * @details The key type and the options are taken from the format in the layout, so that a catalog can open a
+     * tree from what it recorded of the file.
+     * @param name The name of the file.
+     * @param td The schema of the file.
+     * @param page_size The page size of the file.
+     * @param layout The layout of the tree, see DbFile::getLayout.
+     * @return A BasicBTreeFile of the key type the tree was created with.
+     */
+    std::unique_ptr<DbFile> openBTreeFile(const std::string &name, const TupleDesc &td, size_t page_size,
+                                          const FileLayout &layout);
 } // namespace db
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+#include <string_view>
+
+namespace db {
+    /// The number of tuples in a full Batch
+    constexpr size_t BATCH_SIZE = 1024;
+
+    /**
+     * @brief Up to BATCH_SIZE tuples, stored column by column
+     * @details Every selected field is kept in an array of its own: INT fields as `int`, DOUBLE fields as `double`
+     * and CHAR and VARCHAR fields as `std::string_view` into characters owned by the batch. DICT fields keep their
+     * codes and views of their values in the dictionary. The arrays are allocated
+     * once, so filling a batch does not allocate, and consumers can run plain loops over `[0, size())` that the
+     * compiler can vectorize. The batch is filled by DbFile::nextBatch.
+     */
+    class Batch {
+        struct Column {
+            size_t field;
+            size_t offset;
+            type_t type;
+            std::vector<int> ints;
+            std::vector<double> doubles;
+            std::vector<std::string_view> strings;
+            std::vector<char> chars;
+            std::vector<uint32_t> codes;
+        };
+
+        const TupleDesc *td;
+        std::vector<size_t> fields;
+        std::vector<Column> columns;
+        size_t count = 0;
+
+        const Column &column(size_t i, type_t type) const;
+
+    public:
+        /**
+         * @brief Create an empty batch of some fields of a TupleDesc
+         * @param td the TupleDesc of the tuples, which must outlive the batch
+         * @param fields the indices of the fields to keep, in the order of the columns of the batch
+         * @throws std::out_of_range if a field does not exist
+         */
+        Batch(const TupleDesc &td, const std::vector<size_t> &fields);
+
+        /**
+         * @brief Create an empty batch of all the fields of a TupleDesc
+         */
+        explicit Batch(const TupleDesc &td);
+
+        Batch(const Batch &) = delete;
+
+        Batch &operator=(const Batch &) = delete;
+
+        Batch(Batch &&) = default;
+
+        Batch &operator=(Batch &&) = default;
+
+        const TupleDesc &getTupleDesc() const;
+
+        /**
+         * @brief Get the fields of the columns
+         */
+        const std::vector<size_t> &getFields() const;
+
+        /**
+         * @brief Get the number of tuples in the batch
+         */
+        size_t size() const;
+
+        bool empty() const;
+
+        bool full() const;
+
+        /**
+         * @brief Remove all the tuples
+         */
+        void clear();
+
+        /**
+         * @brief Keep only the first tuples
+         * @param size the number of tuples to keep, at most size()
+         */
+        void truncate(size_t size);
+
+        /**
+         * @brief Add the selected fields of a serialized tuple
+         * @throws std::logic_error if the batch is full
+         */
+        void append(const uint8_t *tuple);
+
+        /**
+         * @brief Get the values of an INT column
+         * @param i the index of the column, not of the field
+         * @throws std::logic_error if the field is not an INT
+         */
+        const int *ints(size_t i) const;
+
+        /**
+         * @brief Get the values of a DOUBLE column
+         * @param i the index of the column, not of the field
+         * @throws std::logic_error if the field is not a DOUBLE
+         */
+        const double *doubles(size_t i) const;
+
+        /**
+         * @brief Get the values of a CHAR, VARCHAR or DICT column
+         * @details The strings are owned by the batch and are valid until it is refilled, except the values of a DICT
+         * column, which are owned by the dictionary.
+         * @param i the index of the column, not of the field
+         * @throws std::logic_error if the field is not a CHAR, VARCHAR or DICT
+         */
+        const std::string_view *strings(size_t i) const;
+
+        /**
+         * @brief Get the codes of a DICT column, e.g. to group by codes rather than by strings
+         * @param i the index of the column, not of the field
+         * @throws std::logic_error if the field is not a DICT
+         */
+        const uint32_t *codes(size_t i) const;
+    };
+} // namespace db
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace db {
+
+    /**
+     * @brief An in-memory Bloom filter over 64-bit key hashes
+     * @details The filter answers whether a key may have been inserted: a negative answer is always right, a
+     * positive one is wrong with a probability that grows as the filter fills up. The bits are set with atomic
+     * operations, so inserts and probes may run concurrently.
+     */
+    class BloomFilter {
+        std::vector<std::atomic<uint64_t>> words;
+        size_t num_bits;
+        size_t num_hashes;
+
+    public:
+        /**
+         * @brief Create an empty filter
+         * @param expected_keys the number of keys the filter is sized for
+         * @param bits_per_key the number of bits per expected key; 10 bits give about 1% false positives
+         */
+        explicit BloomFilter(size_t expected_keys, size_t bits_per_key = 10);
+
+        /**
+         * @brief Add a key hash to the filter
+         */
+        void insert(uint64_t hash);
+
+        /**
+         * @brief Whether a key hash may have been added
+         */
+        bool mayContain(uint64_t hash) const;
+
+        /**
+         * @brief Get the number of bits of the filter
+         */
+        size_t bits() const;
+
+        /**
+         * @brief Get the number of bits set per key
+         */
+        size_t hashes() const;
+
+        /**
+         * @brief Estimate the false positive rate from the fraction of bits that are set
+         */
+        double estimatedFalsePositiveRate() const;
+    };
+
+} // namespace db
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <db/Key.hpp>
+
+namespace db {
+
+    struct BucketPageHeader {
+        /// The number of tuples in the page
+        uint16_t size;
+
+        /// The number of hash bits shared by all keys in the bucket
+        uint8_t local_depth;
+    };
+
+    /**
+     * @brief A bucket of an extendible hash file
+     * @details The page has a header of type BucketPageHeader, followed by `BucketPageHeader::size` tuples in no
+     * particular order. Keys are unique within the bucket.
+     */
+    struct BucketPage {
+        const TupleDesc &td;
+
+        /// The fields of a tuple that form the key
+        const KeyDesc &kd;
+
+        uint16_t capacity;
+
+        BucketPageHeader *header;
+        uint8_t *data;
+
+        /**
+         * @brief Wrap a page with a bucket page
+         * @param page the page contents
+         * @param td the tuple descriptor
+         * @param kd the key fields
+         */
+        BucketPage(Page &page, const TupleDesc &td, const KeyDesc &kd);
+
+        /**
+         * @brief Find the slot of the tuple with the given key
+         * @return the slot, or `header->size` if no tuple has this key
+         */
+        size_t find(const NormalizedKey &key) const;
+
+        /**
+         * @brief Insert a tuple into the page
+         * @details If a tuple with the same key exists, it is replaced.
+         * @return false if the key is new and the page is full
+         */
+        bool insertTuple(const Tuple &t);
+
+        /**
+         * @brief Remove the tuple at the specified slot
+         * @details The last tuple of the page takes its place.
+         * @throws std::runtime_error if the slot is not occupied
+         */
+        void remove(size_t slot);
+
+        /**
+         * @brief Get the tuple at the specified slot
+         * @throws std::runtime_error if the slot is not occupied
+         */
+        Tuple getTuple(size_t slot) const;
+
+        /**
+         * @brief Get a view of the tuple at the specified slot, pointing into the page
+         * @throws std::runtime_error if the slot is not occupied
+         */
+        TupleView getView(size_t slot) const;
+    };
+
+} // namespace db
@@ -1,30 +1,97 @@
 #pragma once
 
+#include <db/Latch.hpp>
+#include <db/WriteAheadLog.hpp>
 #include <db/types.hpp>
+#include <bit>
+#include <condition_variable>
+#include <future>
 #include <list>
+#include <memory>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace db {
+    class DbFile;
+
     constexpr size_t DEFAULT_NUM_PAGES = 50;
 
+    /// The number of page sizes, one frame size class each: the powers of two from DEFAULT_PAGE_SIZE to MAX_PAGE_SIZE
+    constexpr size_t NUM_PAGE_SIZES = std::bit_width(MAX_PAGE_SIZE / DEFAULT_PAGE_SIZE);
+
 /**
  * @brief Represents a buffer pool for database pages.
  * @details The BufferPool class is responsible for managing the database pages in memory.
  * It provides functions to get a page, mark a page as dirty, and check the status of pages.
  * The class also supports flushing pages to disk and discarding pages from the buffer pool.
  * @note A BufferPool owns the Page objects that are stored in it.
+ * @note All methods are thread-safe. Pages returned by getPage may be evicted by any later call, so concurrent users
+ * access pages through pinPage/unpinPage and coordinate on the page contents with the page latch.
+ * @note Every page size has its own DEFAULT_NUM_PAGES frames, so files with large pages do not evict the pages of
+ * other files. A frame of a size class spans consecutive Page objects, and a page only evicts pages of its own size.
  */
     class BufferPool {
+        static constexpr size_t NUM_FRAMES = DEFAULT_NUM_PAGES * NUM_PAGE_SIZES;
+
         // TODO pa0: add private members
-        std::array<Page, DEFAULT_NUM_PAGES> pages;
-        std::array<PageId, DEFAULT_NUM_PAGES> pos_to_pid;
+        /// The frames of each size class; the operating system only backs the frames that are used
+        std::array<std::unique_ptr<Page[]>, NUM_PAGE_SIZES> pages;
+        std::array<PageId, NUM_FRAMES> pos_to_pid;
         std::unordered_map<const PageId, size_t> pid_to_pos;
         std::unordered_set<size_t> dirty;
-        std::vector<size_t> available;
-        std::list<size_t> lru_list;
+        std::array<std::vector<size_t>, NUM_PAGE_SIZES> available;
+        std::array<std::list<size_t>, NUM_PAGE_SIZES> lru_list;
         std::unordered_map<size_t, std::list<size_t>::iterator> pos_to_lru;
+        std::array<std::atomic<size_t>, NUM_FRAMES> pins{};
+        std::array<std::atomic<bool>, NUM_FRAMES> referenced{};
+        std::array<OptLatch, NUM_FRAMES> latches;
+        mutable std::shared_mutex mutex;
+
+        /// The log of the changes to the pages, see openLog
+        std::unique_ptr<WriteAheadLog> log;
+
+        /// The contents of each frame as of its last log record, laid out like `pages`
+        std::array<std::unique_ptr<Page[]>, NUM_PAGE_SIZES> logged;
+
+        /// The end of the last log record of each frame
+        std::array<lsn_t, NUM_FRAMES> page_lsn{};
+
+        /// The files written since the last checkpoint
+        std::unordered_set<std::string> unsynced;
+
+        /// Get the frame at a position: the frames of size class c are at positions c * DEFAULT_NUM_PAGES and up
+        Page &frame(size_t pos) const;
+
+        /// Get the contents of a frame as of its last log record
+        Page &loggedFrame(size_t pos) const;
+
+        /// Get the number of bytes of the frame at a position
+        static size_t frameSize(size_t pos);
+
+        /// Append a log record of the bytes of a frame that changed since its last record
+        void logPage(size_t pos);
+
+        /// Get the position of a frame
+        size_t position(const Page &page) const;
+
+        size_t load(const PageId &pid);
+
+        /// Write a dirty frame, logging it first, unless a writer holds its latch; return false if it stays dirty
+        bool flush(size_t pos);
+
+        void discard(size_t pos);
+
+        /// The files whose pages a prefetch is reading, once for each prefetch
+        std::unordered_multiset<std::string> prefetching;
+
+        /// Notified when a prefetch is done
+        std::condition_variable_any prefetched;
+
+        /// Read pages of a file that are not resident into available frames of size class c, reading them without
+        /// the lock, and return how many
+        size_t prefetch(const std::string &name, size_t c, const std::vector<size_t> &run);
 
     public:
         /**
@@ -53,6 +120,28 @@ namespace db {
          */
         Page &getPage(const PageId &pid);
 
+        /**
+         * @brief: Returns the page with the specified page id and pins it in the buffer pool.
+         * @param pid: The page id of the page to return.
+         * @return: The page with the specified page id.
+         * @throws std::runtime_error if every page of the file's page size in the buffer pool is pinned.
+         * @note A pinned page is not evicted until it is unpinned. Hits only take a shared lock: instead of moving the
+         * page to the front of the LRU list, the page is marked as referenced and gets a second chance on eviction.
+         */
+        Page &pinPage(const PageId &pid);
+
+        /**
+         * @brief: Releases a pin acquired with pinPage.
+         * @param page: The pinned page.
+         */
+        void unpinPage(const Page &page);
+
+        /**
+         * @brief: Returns the latch that protects the contents of a resident page.
+         * @param page: A page returned by getPage or pinPage.
+         */
+        OptLatch &getLatch(const Page &page);
+
         /**
          * @brief: Marks the page with the specified page id as dirty.
          * @param pid: The page id of the page to mark as dirty.
@@ -85,6 +174,7 @@ namespace db {
          * @brief: Flushes the page with the specified page id to disk.
          * @param pid: The page id of the page to flush.
          * @note This method should remove the page from dirty pages.
+         * @note A page whose latch a writer holds is being changed: it is not written and stays dirty.
          */
         void flushPage(const PageId &pid);
 
@@ -94,5 +184,108 @@ namespace db {
          * @note This method should call BufferPool::flushPage(pid).
          */
         void flushFile(const std::string &file);
+
+        /**
+         * @brief: Discards all pages of the specified file from the buffer pool.
+         * @param file: The name of the associated file.
+         * @note This method does NOT flush the pages to disk. It waits for the pages of the file that warmUp is
+         * reading.
+         */
+        void discardFile(const std::string &file);
+
+        /**
+         * @brief: Saves the page ids of the resident pages to a file, so that the next process can warm up with them.
+         * @param path: The file to write, replaced once it is complete.
+         * @throws std::runtime_error if the file cannot be written.
+         * @note Each size class is saved from the most to the least recently used page. Saving only copies the page
+         * ids under a shared lock, so it can be called periodically while the buffer pool serves pages.
+         */
+        void savePages(const std::string &path) const;
+
+        /**
+         * @brief: Loads the pages saved by savePages in the background.
+         * @details The saved ids are read before this returns, keeping those of files in the Database and below
+         * their number of pages. In the background, the hottest pages that fit in the available frames of their size
+         * class are sorted by file and page number, and each run of consecutive pages is read with one system call,
+         * without holding the lock of the buffer pool. Pages that are resident already and pages of files removed
+         * meanwhile are skipped. Warming up never evicts a page, so it does not compete with the pages loaded while
+         * it runs.
+         * @param path: The file written by savePages. If it does not exist, there is nothing to load.
+         * @return: The number of pages loaded, once they are loaded.
+         * @note The returned future waits for the warm-up when it is destroyed.
+         */
+        std::future<size_t> warmUp(const std::string &path);
+
+        /**
+         * @brief: Opens a write-ahead log of the changes to the pages, after replaying the changes it holds.
+         * @details From then on, the changes to the dirty pages are logged before the pages are written to their files,
+         * and commit makes them durable without writing the pages. See WriteAheadLog.
+         * @param path: The file of the log.
+         * @throws std::logic_error if a log is already open, or the buffer pool holds pages.
+         * @throws std::runtime_error if the log cannot be opened or replayed.
+         * @note The log has to be opened before the files it covers: replaying it writes to the files directly, and
+         * files read what they keep in memory, like their page count, when they are opened.
+         */
+        void openLog(const std::string &path);
+
+        /**
+         * @brief: Makes every change to the pages so far durable.
+         * @details The bytes that changed in each dirty page since it was last logged are appended to the log, which is
+         * then synced. Threads that commit at the same time share the sync. Pages whose latch a writer holds are
+         * left for a later commit, so that a change is only logged once it is whole: writers mark a page dirty while
+         * they hold its latch, before they change it.
+         * @throws std::logic_error if no log is open.
+         */
+        void commit();
+
+        /**
+         * @brief: Writes the dirty pages to their files, syncs the files, and empties the log.
+         * @details If a writer holds the latch of a dirty page, the page is not written and the log is kept.
+         * @throws std::logic_error if no log is open.
+         * @note No other thread may change pages meanwhile.
+         */
+        void checkpoint();
+
+        /**
+         * @brief: Returns the log opened with openLog, or null.
+         */
+        const WriteAheadLog *getLog() const;
+    };
+
+/**
+ * @brief A page pinned in a BufferPool for the lifetime of the object.
+ */
+    class PinnedPage {
+        BufferPool *bufferPool = nullptr;
+        Page *page = nullptr;
+        PageId pid;
+
+    public:
+        PinnedPage() = default;
+
+        PinnedPage(BufferPool &bufferPool, const PageId &pid);
+
+        ~PinnedPage();
+
+        PinnedPage(const PinnedPage &) = delete;
+
+        PinnedPage &operator=(const PinnedPage &) = delete;
+
+        PinnedPage(PinnedPage &&other) noexcept;
+
+        PinnedPage &operator=(PinnedPage &&other) noexcept;
+
+        Page &operator*() const { return *page; }
+
+        const PageId &getId() const { return pid; }
+
+        OptLatch &latch() const { return bufferPool->getLatch(*page); }
+
+        void markDirty() const { bufferPool->markDirty(pid); }
+
+        /**
+         * @brief Unpin the page before the object is destroyed.
+         */
+        void release();
     };
 } // namespace db
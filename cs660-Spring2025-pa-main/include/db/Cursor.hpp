@@ -0,0 +1,48 @@
+#pragma once
+
+#include <db/Iterator.hpp>
+
+namespace db {
+    /**
+     * @brief A forward scan over the tuples of a DbFile that keeps its current page pinned
+     * @details An Iterator is only a position: every dereference and every `++` looks the page up in the buffer pool
+     * again. A cursor pins the page it is on and wraps it once, so it only goes back to the buffer pool when it moves
+     * to another page. Cursors are created with DbFile::cursor and start on the first tuple of the file.
+     * @note A cursor keeps a buffer pool frame pinned until it moves past the last tuple or is destroyed.
+     */
+    class Cursor {
+    public:
+        virtual ~Cursor() = default;
+
+        /**
+         * @brief Whether the cursor is on a tuple, false once it moved past the last one
+         */
+        virtual bool valid() const = 0;
+
+        /**
+         * @brief Get a view of the current tuple, valid until the cursor moves or the page is modified
+         */
+        virtual TupleView view() const = 0;
+
+        /**
+         * @brief Get a copy of the current tuple
+         */
+        virtual Tuple get() const = 0;
+
+        /**
+         * @brief Copy the current tuple into an existing Tuple, reusing its storage
+         */
+        virtual void get(Tuple &t) const = 0;
+
+        /**
+         * @brief Move to the next tuple
+         */
+        virtual void next() = 0;
+
+        /**
+         * @brief Get the position of the current tuple, for the DbFile methods that take an Iterator
+         * @details The position is DbFile::end once the cursor is no longer valid.
+         */
+        virtual Iterator position() const = 0;
+    };
+} // namespace db
@@ -3,18 +3,41 @@
 #include <db/BufferPool.hpp>
 #include <db/DbFile.hpp>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 /**
  * @brief A database is a collection of files and a BufferPool.
  * @details The Database class is responsible for managing the database files.
  * It provides functions to add new database files, get the internal id of a file, and retrieve database files.
- * The class also supports removing all files from the catalog.
+ * The class also supports removing all files from the catalog, and saving the catalog to a file so that the next
+ * process can load it instead of adding every file again.
  * @note A Database owns the DbFile objects that are added to it.
  */
 namespace db {
     class Database {
         // TODO pa0: add private members
-        std::unordered_map<std::string, std::unique_ptr<DbFile>> files;
+        /// A file of the catalog, opened when it is first used
+        struct Entry {
+            std::unique_ptr<DbFile> file;
+
+            /// How to open the file, for a file loaded from a catalog
+            TupleDesc td;
+            size_t page_size = DEFAULT_PAGE_SIZE;
+            FileLayout layout;
+
+            /// For a SecondaryIndex, the heap file it indexes, its key fields in the heap, and whether it was attached
+            std::string heap;
+            std::vector<size_t> heap_key_indices;
+            bool attached = false;
+
+            std::once_flag opened;
+        };
+
+        /// Guards the map, not the files: the warm-up thread of the BufferPool looks files up by name
+        mutable std::shared_mutex mutex;
+
+        std::unordered_map<std::string, std::unique_ptr<Entry>> files;
 
         BufferPool bufferPool;
 
@@ -51,6 +74,8 @@ namespace db {
          * @return The removed file.
          * @throws std::logic_error if the name does not exist.
          * @note This method should call BufferPool::flushFile(name)
+         * @note The pages of the file are discarded from the BufferPool, so that a new file with the same name does not
+         * see them.
          * @note This method moves the DbFile ownership to the caller.
          */
         std::unique_ptr<DbFile> remove(const std::string &name);
@@ -62,6 +87,31 @@ namespace db {
          * @throws std::logic_error if the name does not exist.
          */
         DbFile &get(const std::string &name) const;
+
+        /**
+         * @brief Write the catalog to a file
+         * @details The catalog records the name, the schema, the page size and the layout of every file, so that
+         * loadCatalog can open each file the way it was created. A SecondaryIndex also records its heap file, its key
+         * fields and whether it is attached to the heap. The catalog is written to a temporary file that
+         * then replaces `path`, so a crash leaves either the old or the new catalog.
+         * @param path The file of the catalog.
+         * @throws std::logic_error if a file has DICT fields, whose dictionaries are not recorded.
+         * @throws std::runtime_error if the catalog cannot be written.
+         */
+        void saveCatalog(const std::string &path) const;
+
+        /**
+         * @brief Add the files of a catalog written by saveCatalog
+         * @details The files are not opened: each is opened when get or remove first asks for it, so loading a
+         * catalog reads one file however many files it lists. The exception are the indexes that were attached to
+         * their heap file: they are opened with their heap and attached again, so that the heap keeps them up to date
+         * from its first insert.
+         * @param path The file of the catalog.
+         * @throws std::logic_error if a file name already exists.
+         * @throws std::runtime_error if the catalog cannot be read or is not a catalog, or an index is not over a heap
+         * file.
+         */
+        void loadCatalog(const std::string &path);
     };
 
 /**
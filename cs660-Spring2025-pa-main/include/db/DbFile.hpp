@@ -2,9 +2,41 @@
 
 #include <db/Iterator.hpp>
 #include <db/types.hpp>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace db {
+    class Batch;
+    class Cursor;
+
+    /**
+     * @brief What a file records in its superblock about its page layout, besides the schema and the page size
+     */
+    struct FileLayout {
+        /// The kind of file and the options that change its pages, chosen by each kind of file
+        uint32_t format = 0;
+
+        /// The key fields of an index
+        std::vector<size_t> key_indices;
+
+        /// The page number of the root of an index
+        size_t root = 0;
+    };
+
+    /**
+     * @brief Bytes of a page to write back when a log is replayed, see DbFile::redo
+     */
+    struct PageUpdate {
+        size_t page;
+        size_t offset;
+        std::vector<uint8_t> bytes;
+    };
+
+    /// The number of files that keep a file descriptor open, see DbFile
+    constexpr size_t MAX_OPEN_FILES = 64;
 
 /**
  * @brief Represents a database file.
@@ -16,43 +48,101 @@ namespace db {
         mutable std::vector<size_t> reads;
         mutable std::vector<size_t> writes;
 
+        /// Guards reads and writes, which the buffer pool's threads append to concurrently
+        mutable std::mutex io_log;
+
         // TODO pa1: add private members
-        int fd;
+        /// The file descriptor, or -1 while the file is closed
+        mutable int fd = -1;
+
+        /// The number of reads and writes using the file descriptor, which keep it open
+        mutable size_t users = 0;
+
+        /// The position of the file among the open files
+        mutable std::list<const DbFile *>::iterator lru;
+
+        const FileLayout layout;
+
+        /// The number of pages recorded in the superblock
+        mutable size_t stored_pages = 0;
+
+        /// Write the superblock with a number of pages
+        void writeSuperblock(size_t pages) const;
+
+        /// Add the file to the open files, closing the least recently used one if there are too many
+        void track() const;
+
+        /// Get the file descriptor, reopening the file if it was closed, and keep it open until release()
+        int acquire() const;
+
+        /// Let the file descriptor be closed again
+        void release() const;
 
     protected:
         const std::string name;
         const TupleDesc td;
-        size_t numPages;
+        const size_t page_size;
+        std::atomic<size_t> numPages;
+
+        /// Get the number of pages recorded in the superblock, 0 until the first page of a new file is written
+        size_t getStoredPages() const;
 
     public:
         /**
          * @brief Construct a new Db File object with the specified file name and tuple descriptor
+         * @details The file starts with a superblock of DEFAULT_PAGE_SIZE bytes, followed by the pages. The superblock
+         * records a magic number and version, the page size, the schema, the layout and the number of allocated
+         * pages, so that opening a file reads one block and checks that it is opened the way it was created.
+         * A new file gets its superblock when it is created; the page count is updated before a page beyond it is
+         * written, and when the file is closed.
+         * At most MAX_OPEN_FILES files of the process keep their file descriptor open. Past that, opening a file or
+         * reading a page of a closed one closes the file descriptor of the least recently used file, which reopens
+         * it on its next read or write.
          * @param name of the file to be opened or created.
          * @param td tuple description of tuples in the file.
-         * @throws std::runtime_error if the file cannot be opened or if the `fstat` system call fails.
-         * @note This method calculates the number of pages in the file by dividing the file size (in bytes)
-         * by the `DEFAULT_PAGE_SIZE`.
+         * @param page_size the number of bytes of a page, see validPageSize.
+         * @param layout the kind of file and its key fields.
+         * @throws std::runtime_error if the file cannot be opened, if the `fstat` system call fails, or if the file
+         * has no valid superblock or was created with another page size, schema or layout.
+         * @throws std::logic_error if the page size is not supported, or the schema does not fit in the superblock.
          */
-        explicit DbFile(const std::string &name, const TupleDesc &td);
+        explicit DbFile(const std::string &name, const TupleDesc &td, size_t page_size = DEFAULT_PAGE_SIZE,
+                        const FileLayout &layout = {});
 
         /**
-         * @brief closes the file descriptor.
+         * @brief Records the number of pages in the superblock and closes the file descriptor.
          */
         virtual ~DbFile();
 
         const std::string &getName() const;
 
+        /**
+         * @brief Get the ids of the pages read so far, in order.
+         * @note Page I/O appends under a lock, but the returned vector is only stable while no other thread reads or
+         * writes pages of this file.
+         */
         const std::vector<size_t> &getReads() const;
 
+        /**
+         * @brief Get the ids of the pages written so far, in order.
+         * @note Same as getReads(): inspect it only while no other thread reads or writes pages of this file.
+         */
         const std::vector<size_t> &getWrites() const;
 
         /**
          * @brief Read a page from the file.
-         * @param page The page to read into.
+         * @param page The page to read into, with room for getPageSize() bytes.
          * @param id The page number of the page to be read. It determines the offset within the file.
          */
         void readPage(Page &page, size_t id) const;
 
+        /**
+         * @brief Read consecutive pages from the file with one system call.
+         * @param pages The pages to read into, one for each page number from `id` on.
+         * @param id The page number of the first page.
+         */
+        void readPages(const std::vector<Page *> &pages, size_t id) const;
+
         /**
          * @brief Write a page to the file.
          * @param page The page to write.
@@ -61,20 +151,82 @@ namespace db {
          */
         void writePage(const Page &page, size_t id) const;
 
+        /**
+         * @brief Wait until the pages written to the file are on disk.
+         * @throws std::runtime_error if the file cannot be synced.
+         */
+        void sync() const;
+
+        /**
+         * @brief Write logged changes to a file that is not open, see WriteAheadLog
+         * @details The page size is read from the superblock, and the page count is raised to cover the pages that
+         * are written. The file is synced before returning.
+         * @param name The name of the file.
+         * @param updates The changes, in the order they were logged.
+         * @return false if the file does not exist or is not a database file, so that there is nothing to redo.
+         * @throws std::runtime_error if the file cannot be written or synced.
+         */
+        static bool redo(const std::string &name, const std::vector<PageUpdate> &updates);
+
         virtual void insertTuple(const Tuple &t);
 
         virtual void deleteTuple(const Iterator &it);
 
         virtual Tuple getTuple(const Iterator &it) const;
 
+        /**
+         * @brief Read a tuple into an existing Tuple, reusing its storage
+         * @details The default implementation copies the result of getTuple; files override it to deserialize in
+         * place, so that a scan reading every tuple into the same Tuple does not allocate.
+         * @param it The iterator that identifies the tuple.
+         * @param t Receives the tuple.
+         */
+        virtual void getTuple(const Iterator &it, Tuple &t) const;
+
+        /**
+         * @brief Get a view of a tuple inside its page in the buffer pool
+         * @details Unlike getTuple, nothing is copied. The view points into the buffer pool frame, so it is only
+         * valid until the page is modified or evicted; reading another page of the file may evict it.
+         * @param it The iterator that identifies the tuple.
+         * @return The view of the tuple.
+         */
+        virtual TupleView getView(const Iterator &it) const;
+
         virtual void next(Iterator &it) const;
 
+        /**
+         * @brief Fill a batch with the next tuples of the file
+         * @details The batch is cleared, then filled with up to BATCH_SIZE tuples starting at `it`, which is left on
+         * the first tuple that did not fit, or end(). The default implementation copies one view at a time; files
+         * override it to copy a page at a time.
+         * @param it The position of the scan, starting at begin().
+         * @param batch The batch to fill.
+         * @return Whether the batch holds any tuples.
+         */
+        virtual bool nextBatch(Iterator &it, Batch &batch) const;
+
         virtual Iterator begin() const;
 
         virtual Iterator end() const;
 
+        /**
+         * @brief Open a cursor on the first tuple of the file
+         * @details The default implementation moves an Iterator; files override it to keep the current page pinned.
+         */
+        virtual std::unique_ptr<Cursor> cursor() const;
+
         size_t getNumPages() const;
 
+        /**
+         * @brief Get the number of bytes of a page of the file
+         */
+        size_t getPageSize() const;
+
         const TupleDesc &getTupleDesc() const;
+
+        /**
+         * @brief Get the kind of file and the key fields recorded in the superblock
+         */
+        const FileLayout &getLayout() const;
     };
 } // namespace db
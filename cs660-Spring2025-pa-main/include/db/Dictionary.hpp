@@ -0,0 +1,93 @@
+#pragma once
+
+#include <db/types.hpp>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace db {
+    /**
+     * @brief The distinct values of a dictionary-encoded CHAR field
+     * @details A DICT field stores the code of its value instead of the CHAR_SIZE characters: codes are assigned in
+     * order of first appearance and take 1, 2 or 4 bytes, so a column with a few hundred distinct values takes a
+     * single byte per tuple. Values longer than CHAR_SIZE are truncated, like CHAR values.
+     *
+     * A dictionary belongs to one file. It is kept in its own file next to it, where a new value is appended before
+     * its code is used, so that the codes stored in pages can always be decoded after a restart.
+     * @note All methods are thread-safe.
+     */
+    class Dictionary {
+        size_t code_width;
+        std::string path;
+        int fd = -1;
+
+        /// The values by code; a deque, so that views of existing values stay valid when values are added
+        std::deque<std::string> values;
+
+        /// The codes by value, viewing the strings in `values`
+        std::unordered_map<std::string_view, uint32_t> codes;
+
+        mutable std::shared_mutex mutex;
+
+    public:
+        /**
+         * @brief Open the dictionary stored in a file, creating the file if needed
+         * @param path the file of the dictionary, or empty to keep it in memory only
+         * @param width the number of bytes of a code: 1, 2 or 4
+         * @throws std::logic_error if the width is not 1, 2 or 4
+         * @throws std::runtime_error if the file cannot be opened or read
+         */
+        explicit Dictionary(const std::string &path = "", size_t width = 2);
+
+        ~Dictionary();
+
+        Dictionary(const Dictionary &) = delete;
+
+        Dictionary &operator=(const Dictionary &) = delete;
+
+        /**
+         * @brief Get the number of bytes of a code
+         */
+        size_t width() const;
+
+        /**
+         * @brief Get the number of distinct values
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the code of a value, adding the value if it is new
+         * @details A new value is synced to the file before its code is returned, so that no page logged or written
+         * with the code can outlive it in a crash.
+         * @throws std::logic_error if the value is new and all the codes of the width are taken
+         * @throws std::runtime_error if the value cannot be written to the file or synced
+         */
+        uint32_t encode(std::string_view value);
+
+        /**
+         * @brief Get the code of a value without adding it
+         * @return the code, or nothing if the value is not in the dictionary
+         */
+        std::optional<uint32_t> find(std::string_view value) const;
+
+        /**
+         * @brief Get the value of a code
+         * @return a view of the value, valid as long as the dictionary
+         * @throws std::out_of_range if the code is not assigned
+         */
+        std::string_view decode(uint32_t code) const;
+
+        /**
+         * @brief Write a code in `width()` bytes
+         */
+        void store(uint8_t *data, uint32_t code) const;
+
+        /**
+         * @brief Read a code of `width()` bytes
+         */
+        uint32_t load(const uint8_t *data) const;
+    };
+} // namespace db
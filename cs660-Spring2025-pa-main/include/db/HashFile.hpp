@@ -0,0 +1,127 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+#include <db/Key.hpp>
+#include <optional>
+
+namespace db {
+
+    /**
+     * @brief A file of tuples with unique keys, organized by extendible hashing
+     * @details Page 0 holds the global depth and the page numbers of the directory pages. The directory maps the low
+     * `global depth` bits of a key hash to a bucket page (see BucketPage). When a bucket overflows, only that bucket
+     * is split in two, doubling the directory first if the bucket already uses all of its bits. The directory is
+     * mirrored in memory, so a point read accesses a single bucket page no matter how big the file is.
+     *
+     * Like HeapFile, a HashFile is not safe for concurrent use.
+     */
+    class HashFile : public DbFile {
+        /// The directory never grows beyond what the page numbers in page 0 can address
+        static constexpr size_t MAX_GLOBAL_DEPTH = 19;
+
+        KeyDesc kd;
+
+        /// Describes a tuple made of the key fields only, as passed to find and erase
+        TupleDesc key_td;
+        KeyDesc key_kd;
+
+        mutable bool loaded = false;
+        mutable size_t global_depth = 0;
+        mutable std::vector<uint32_t> directory;
+        mutable std::vector<uint32_t> directory_pages;
+        mutable std::vector<bool> bucket_pages;
+
+        void load() const;
+
+        void create();
+
+        void writeHeader() const;
+
+        void writeDirectory(size_t begin, size_t end) const;
+
+        void doubleDirectory();
+
+        void splitBucket(size_t index);
+
+        size_t allocateBucket(uint8_t local_depth);
+
+        size_t directoryIndex(const NormalizedKey &key) const;
+
+        NormalizedKey normalizeKey(const Tuple &key) const;
+
+        void skipExhausted(Iterator &it) const;
+
+    public:
+        /**
+         * @brief Initialize a HashFile
+         * @param key_index the index of the key in the tuple
+         */
+        HashFile(const std::string &name, const TupleDesc &td, size_t key_index);
+
+        /**
+         * @brief Initialize a HashFile with a key made of one or more fields
+         * @param key_indices the indices of the key fields
+         * @throws std::logic_error if there are no key fields, too many key fields, or an index is out of range, or the
+         * tuples have VARCHAR fields
+         */
+        HashFile(const std::string &name, const TupleDesc &td, const std::vector<size_t> &key_indices);
+
+        const KeyDesc &getKeyDesc() const;
+
+        /**
+         * @brief Get the number of hash bits used by the directory
+         */
+        size_t getGlobalDepth() const;
+
+        /**
+         * @brief Insert a tuple into the file
+         * @details The tuple goes to the bucket of its key hash and replaces a tuple with the same key. A full bucket is
+         * split, which rewrites that bucket, the new one and the directory entries pointing to them.
+         * @throws std::runtime_error if the tuple is not compatible, or a bucket is full at the maximum depth
+         */
+        void insertTuple(const Tuple &t) override;
+
+        /**
+         * @brief Delete the tuple an iterator points to
+         * @details Buckets are never merged.
+         * @throws std::runtime_error if the slot is not occupied
+         */
+        void deleteTuple(const Iterator &it) override;
+
+        /**
+         * @brief Find the tuple with the given key
+         * @param key the key fields, in the order of the key indices
+         * @return the tuple, or std::nullopt if no tuple has this key
+         * @throws std::logic_error if the key does not match the key fields
+         */
+        std::optional<Tuple> find(const Tuple &key) const;
+
+        /**
+         * @brief Delete the tuple with the given key
+         * @param key the key fields, in the order of the key indices
+         * @return true if a tuple was deleted
+         * @throws std::logic_error if the key does not match the key fields
+         */
+        bool erase(const Tuple &key);
+
+        using DbFile::getTuple;
+
+        Tuple getTuple(const Iterator &it) const override;
+
+        TupleView getView(const Iterator &it) const override;
+
+        /**
+         * @brief Advance the iterator to the next tuple
+         * @details Tuples are visited bucket by bucket in page order, in no particular key order.
+         */
+        void next(Iterator &it) const override;
+
+        Iterator begin() const override;
+
+        /**
+         * @brief Get the iterator to the end of the file
+         * @details Page 0 is never a bucket, so {0, 0} stays the end while the file grows.
+         */
+        Iterator end() const override;
+    };
+} // namespace db
@@ -1,26 +1,91 @@
 #pragma once
 
 #include <db/DbFile.hpp>
+#include <db/Predicate.hpp>
+#include <db/ZoneMap.hpp>
+#include <functional>
 
 namespace db {
+    class SecondaryIndex;
+
     class HeapFile : public DbFile {
+        std::vector<SecondaryIndex *> indexes;
+
+        /// Summaries of the pages, learned by inserts into new pages and by scans
+        mutable ZoneMap zones;
+
     public:
         HeapFile(const std::string &name, const TupleDesc &td);
 
+        /**
+         * @brief Attach a secondary index to the file.
+         * @details An empty index is built from the tuples in the file, while an index that has entries, such as one
+         * reopened from its file, is attached as it is. From then on the index is updated by every insert and delete.
+         * @param index An index over this file, either empty or in step with the file.
+         * @throws std::logic_error if the index belongs to another file.
+         * @note The index has to outlive the file, or be detached with dropIndex before it is removed from the Database.
+         */
+        void addIndex(SecondaryIndex &index);
+
+        /**
+         * @brief Detach a secondary index from the file.
+         * @details The index is no longer updated. Its contents are left as they are.
+         */
+        void dropIndex(const SecondaryIndex &index);
+
+        const std::vector<SecondaryIndex *> &getIndexes() const;
+
         /**
          * @brief Insert a tuple to the database file.
          * @details Insert a tuple to the first available slot of the last page. If the last page is full, create a new page.
+         * Every attached index gets an entry for the tuple.
          * @param t The tuple to be inserted.
          */
         void insertTuple(const Tuple &t) override;
 
         /**
          * @brief Delete a tuple from the database file.
-         * @details Delete a tuple from the database file by marking the slot unused.
+         * @details Delete a tuple from the database file by marking the slot unused, and remove its index entries.
          * @param it The iterator that identifies the tuple to be deleted.
          */
         void deleteTuple(const Iterator &it) override;
 
+        /**
+         * @brief Visit the tuples that satisfy all the predicates.
+         * @details Pages whose zone map rules out one of the predicates are skipped without being read. Pages without
+         * a zone map, such as the pages of a reopened file, are read and summarized on the way.
+         * @param predicates The predicates, all of which must hold.
+         * @param callback Called with every matching tuple, in file order. It must not modify the file.
+         * @throws std::logic_error if a predicate does not apply to the tuples of the file.
+         */
+        void scan(const std::vector<Predicate> &predicates, const std::function<void(const Tuple &)> &callback) const;
+
+        /**
+         * @brief Visit the tuples that satisfy all the predicates, without copying them out of their pages.
+         * @details Like scan, but the predicates are evaluated on the page bytes and the callback gets a view, so
+         * nothing is allocated per tuple. Only the tuples the callback chooses to copy are materialized. On pages of
+         * fixed-length tuples, INT and DOUBLE predicates are evaluated on whole blocks of slots first (see Selection).
+         * @param predicates The predicates, all of which must hold.
+         * @param callback Called with every matching tuple, in file order. The view is only valid during the call.
+         * @throws std::logic_error if a predicate does not apply to the tuples of the file.
+         */
+        void scanViews(const std::vector<Predicate> &predicates,
+                       const std::function<void(const TupleView &)> &callback) const;
+
+        /**
+         * @brief Visit some of the fields of the tuples that satisfy all the predicates.
+         * @details Like scan, but only the listed fields of a matching tuple are deserialized, into a buffer reused
+         * for every tuple.
+         * @param predicates The predicates, all of which must hold. They may refer to any field.
+         * @param columns The indices of the fields to pass to the callback, described by `td.project(columns)`.
+         * @param callback Called with the projected fields of every matching tuple, in file order. The fields are
+         * only valid during the call.
+         * @throws std::logic_error if a predicate does not apply to the tuples of the file.
+         * @throws std::out_of_range if a column does not exist.
+         */
+        void scan(const std::vector<Predicate> &predicates, const std::vector<size_t> &columns,
+                  const std::function<void(const std::vector<field_t> &)> &callback) const;
+
         /**
          * @brief Get a tuple from the database file.
          * @details Get a tuple from the database file by reading the tuple from the page.
@@ -29,6 +94,10 @@ namespace db {
          */
         Tuple getTuple(const Iterator &it) const override;
 
+        void getTuple(const Iterator &it, Tuple &t) const override;
+
+        TupleView getView(const Iterator &it) const override;
+
         /**
          * @brief Advance the iterator to the next tuple.
          * @details Advance the iterator to the next tuple by moving to the next slot of the page.
@@ -37,6 +106,8 @@ namespace db {
          */
         void next(Iterator &it) const override;
 
+        bool nextBatch(Iterator &it, Batch &batch) const override;
+
         /**
          * @brief Get the iterator to the first tuple.
          * @details Get the iterator to the first tuple by finding the first occupied slot.
@@ -51,5 +122,7 @@ namespace db {
          * @return The iterator to the end of the file.
          */
         Iterator end() const override;
+
+        std::unique_ptr<Cursor> cursor() const override;
     };
 } // namespace db
@@ -1,14 +1,40 @@
 #pragma once
 
 #include <db/DbFile.hpp>
+#include <db/SlottedPage.hpp>
+#include <optional>
 
 namespace db {
+    /**
+     * @brief The header of a heap page whose tuples have VARCHAR fields
+     */
+    struct SlottedHeapPageHeader {
+        /// The number of slots, occupied or not
+        uint16_t slots;
+
+        /// The offset of the first tuple byte, see SlottedPage
+        uint16_t start;
+    };
+
+    /**
+     * @brief A page of a HeapFile
+     * @details Fixed-length tuples are stored in fixed slots after an occupancy bitmap. Tuples with VARCHAR fields use
+     * a slotted layout instead (see SlottedPage): slots keep their number while the page is compacted, and a deleted
+     * slot is reused by the next insert.
+     */
     class HeapPage {
         const TupleDesc &td;
         size_t capacity;
         uint8_t *header;
         uint8_t *data;
 
+        /// The slot directory of a page with variable-length tuples
+        std::optional<SlottedPage> slotted;
+
+        SlottedHeapPageHeader *slottedHeader() const;
+
+        const uint8_t *tuple(size_t slot) const;
+
     public:
         /**
          * @brief Wrap a page with a heap page.
@@ -28,7 +54,7 @@ namespace db {
 
         /**
          * @brief Get the end of the page.
-         * @return capacity can be used as the end of the page.
+         * @return capacity can be used as the end of the page, or the number of slots of a slotted page.
          */
         size_t end() const;
 
@@ -36,9 +62,11 @@ namespace db {
          * @brief Insert a tuple to the page.
          * @details Insert a tuple to the page by serializing the tuple to the page.
          * @param t The tuple to be inserted.
+         * @param slot If not null, receives the slot the tuple was written to.
          * @return True if the tuple is inserted successfully, false otherwise if the page is full.
+         * @throws std::logic_error if a VARCHAR value is too long
          */
-        bool insertTuple(const Tuple &t);
+        bool insertTuple(const Tuple &t, size_t *slot = nullptr);
 
         /**
          * @brief Delete a tuple from the page.
@@ -63,10 +91,31 @@ namespace db {
          */
         Tuple getTuple(size_t slot) const;
 
+        /**
+         * @brief Get a view of the tuple at the specified slot.
+         * @details The view points into the page, nothing is deserialized.
+         * @param slot The slot of the tuple.
+         * @return The view of the tuple.
+         */
+        TupleView getView(size_t slot) const;
+
         /**
          * @brief Advance the slot to the next occupied slot.
          * @details Advance the slot to the next occupied slot by scanning the header.
          */
         void next(size_t &slot) const;
+
+        /**
+         * @brief Get the occupancy bitmap, most significant bit first: slot `s` is occupied if bit `7 - s % 8` of byte
+         * `s / 8` is set.
+         * @throws std::logic_error if the page has the slotted layout.
+         */
+        const uint8_t *bitmap() const;
+
+        /**
+         * @brief Get the value of a field in slot 0; the value in slot `s` is `s * td.length()` bytes further.
+         * @throws std::logic_error if the page has the slotted layout.
+         */
+        const uint8_t *values(size_t field) const;
     };
 } // namespace db
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <db/Tuple.hpp>
+#include <db/Key.hpp>
 
 namespace db {
 
@@ -12,11 +12,21 @@ namespace db {
         bool index_children;
     };
 
-    struct IndexPage {
+    template<typename Key>
+    struct BasicIndexPage {
+        using key_type = typename KeyTraits<Key>::key_type;
+        using slot_type = typename KeyTraits<Key>::slot_type;
+
         uint16_t capacity;
 
+        /// The number of bytes of a key slot
+        size_t key_size;
+
+        /// Whether the page keeps a high key and a right link (B-link trees)
+        bool blink;
+
         IndexPageHeader *header;
-        int *keys;
+        slot_type *keys;
         size_t *children;
 
         /**
@@ -26,10 +36,70 @@ namespace db {
          * `IndexPageHeader::size + 1` page numbers. The keys are sorted in ascending order.
          * The capacity of the page is calculated based on the remaining size of the page.
          *
+         * In a B-link page the last key slot holds the high key (an upper bound of the keys in the subtree) and the last
+         * page number slot holds the right sibling of the page, so the capacity is one less than in a regular page.
+         *
          * @param page the page contents
-         * @param key_index the index of the key in the tuple
+         * @param key_size the number of bytes of a key slot (only needed for keys without a static size)
+         * @param blink whether the page keeps a high key and a right link
+         * @param page_size the number of bytes of the page
+         */
+        explicit BasicIndexPage(Page &page, size_t key_size = KeyTraits<Key>::static_size, bool blink = false,
+                                size_t page_size = DEFAULT_PAGE_SIZE);
+
+        /**
+         * @brief Get the number of keys in the page
+         * @details The size in the header is clamped to the capacity, see BasicLeafPage::size.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the i-th key
          */
-        explicit IndexPage(Page &page);
+        key_type key(size_t i) const;
+
+        /**
+         * @brief The right sibling of a B-link page, or 0 if the page is the rightmost page of its level
+         */
+        size_t &rightLink() const;
+
+        /**
+         * @brief The high key of a B-link page, only meaningful if the page has a right sibling
+         */
+        key_type highKey() const;
+
+        /**
+         * @brief Link a B-link page to its right sibling
+         * @param right the page number of the right sibling
+         * @param high_key the high key of the page (the smallest key of the right sibling)
+         */
+        void link(size_t right, const key_type &high_key);
+
+        /**
+         * @brief Whether a key is at or above the high key of a B-link page
+         * @details Such a key was moved to the right sibling by a split and the search has to continue there.
+         */
+        bool beyond(const key_type &key) const;
+
+        /**
+         * @brief Whether the page has a child with the given page number
+         */
+        bool hasChild(size_t child) const;
+
+        /**
+         * @brief Find the child that is responsible for a key
+         * @details Child `i` holds the keys in the range `[keys[i - 1], keys[i])`.
+         * @return the position of the child in `children`
+         */
+        size_t route(const key_type &key) const;
+
+        /**
+         * @brief Find the leftmost child that may hold a key
+         * @details With duplicate keys a run of equal keys may continue left of the separator that equals them, so a
+         * search for all of them starts one child further left than route().
+         * @return the position of the child in `children`
+         */
+        size_t lowerRoute(const key_type &key) const;
 
         /**
          * @brief Insert a new key with a corresponding child page number
@@ -37,15 +107,33 @@ namespace db {
          * @param child the child page number
          * @return true if the page is full and needs to be split
          */
-        bool insert(int key, size_t child);
+        bool insert(const key_type &key, size_t child);
+
+        /**
+         * @brief Insert a new key with the child that was split off another child
+         * @details The new child is placed right after `left`. Unlike insert(), this also works when the key equals
+         * other separators of the page, as happens with duplicate keys.
+         * @param key the key to insert
+         * @param child the child page number
+         * @param left the page number of the child that was split
+         * @return true if the page is full and needs to be split
+         */
+        bool insert(const key_type &key, size_t child, size_t left);
 
         /**
          * @brief Split the index page
          * @details The page is split into two pages. The old page contains the first half of the tuples, and the new page contains the second half.
+         * In a B-link page the new page takes over the right link and the high key, and the split key becomes the high
+         * key of the old page. The caller links the old page to the new one.
          * @param new_page a new empty page
          * @return the split key (this key is moved to the parent page)
          */
-        int split(IndexPage &new_page);
+        key_type split(BasicIndexPage &new_page);
+
+    private:
+        uint8_t *slot(size_t i) const;
     };
 
+    using IndexPage = BasicIndexPage<int>;
+
 } // namespace db
@@ -21,6 +21,12 @@ namespace db {
 
         Tuple operator*() const;
 
+        /**
+         * @brief Get a view of the current tuple without copying it out of its page
+         * @see DbFile::getView
+         */
+        TupleView view() const;
+
         Iterator &operator++();
 
         bool operator==(const Iterator &other) const { return page == other.page && slot == other.slot; }
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+#include <algorithm>
+#include <compare>
+#include <cstring>
+
+namespace db {
+    /// Maximum number of fields that can form a composite key (a secondary index adds a page and a slot field)
+    constexpr size_t MAX_KEY_FIELDS = 6;
+
+    /**
+     * @brief An order-preserving byte encoding of one or more key fields.
+     * @details INT and DOUBLE fields are encoded big-endian with their sign folded so that unsigned byte order matches
+     * numeric order, and CHAR fields keep their zero-padded bytes. Two keys therefore compare with a single memcmp,
+     * no matter how many fields or which types they are made of. A shorter key orders before every key it is a
+     * prefix of, so a key built from the leading fields of a composite key can be used as a search bound.
+     */
+    struct NormalizedKey {
+        std::string bytes;
+
+        std::strong_ordering operator<=>(const NormalizedKey &other) const;
+
+        bool operator==(const NormalizedKey &other) const = default;
+    };
+
+    /**
+     * @brief Hash a sequence of bytes
+     * @details FNV-1a followed by a 64-bit finalizer, so that every bit of the result depends on every input byte.
+     * The result is stable across runs and platforms, so it can be stored in files.
+     */
+    uint64_t hash_bytes(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Describes which fields of a tuple form the key.
+     * @details The description is a small fixed-size value so that pages can hold it by value without allocating.
+     */
+    class KeyDesc {
+        struct Field {
+            size_t index;
+            size_t offset;
+            type_t type;
+        };
+
+        std::array<Field, MAX_KEY_FIELDS> fields{};
+        size_t count = 0;
+        size_t width = 0;
+
+    public:
+        /**
+         * @brief Describe the key formed by the fields at the given indices
+         * @param td the tuple descriptor
+         * @param indices the indices of the key fields, most significant first
+         * @throws std::logic_error if there are no key fields, too many key fields, an index is out of range, or a key
+         * field is a VARCHAR
+         */
+        KeyDesc(const TupleDesc &td, const std::vector<size_t> &indices);
+
+        /**
+         * @brief Get the number of fields in the key
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the tuple index of the i-th key field
+         */
+        size_t index(size_t i) const;
+
+        /**
+         * @brief Get the offset of the i-th key field inside a serialized tuple
+         */
+        size_t offset(size_t i) const;
+
+        /**
+         * @brief Get the type of the i-th key field
+         */
+        type_t type(size_t i) const;
+
+        /**
+         * @brief Get the number of bytes of the normalized key
+         */
+        size_t normalizedSize() const;
+
+        /**
+         * @brief Normalize the key of a tuple
+         */
+        NormalizedKey normalize(const Tuple &t) const;
+
+        /**
+         * @brief Normalize the key of a serialized tuple
+         */
+        NormalizedKey normalize(const uint8_t *tuple) const;
+
+        /**
+         * @brief Compare the key of a serialized tuple with a normalized key
+         * @details The fields are normalized one at a time and the comparison stops at the first differing field.
+         * @return a negative value, zero or a positive value if the tuple key is less, equal or greater than the key
+         */
+        int compare(const uint8_t *tuple, const NormalizedKey &key) const;
+    };
+
+    /**
+     * @brief Compile-time description of how a key type is stored and compared
+     * @details Index pages store keys in slots of `size` bytes, leaf pages extract keys from serialized tuples.
+     * `int` and `double` keys are stored natively and compared with a single instruction, `NormalizedKey` covers
+     * CHAR and composite keys with slots exactly as wide as the normalized key.
+     */
+    template<typename Key>
+    struct KeyTraits;
+
+    template<typename T>
+    struct NativeKeyTraits {
+        using key_type = T;
+        using slot_type = T;
+
+        static constexpr size_t static_size = sizeof(T);
+
+        static key_type load(const uint8_t *slot, size_t) {
+            T key;
+            std::memcpy(&key, slot, sizeof(T));
+            return key;
+        }
+
+        static void store(uint8_t *slot, const key_type &key, size_t) { std::memcpy(slot, &key, sizeof(T)); }
+
+        static int compare(const uint8_t *slot, const key_type &key, size_t) {
+            T value = load(slot, sizeof(T));
+            return (value > key) - (value < key);
+        }
+
+        static uint64_t hash(key_type key) {
+            // Keys that compare equal hash equally, so -0.0 is hashed as 0.0.
+            if (key == 0) {
+                key = 0;
+            }
+            return hash_bytes(reinterpret_cast<const uint8_t *>(&key), sizeof(T));
+        }
+
+        static key_type extract(const Tuple &t, const KeyDesc &kd) { return std::get<T>(t.get_field(kd.index(0))); }
+
+        static key_type extract(const uint8_t *tuple, const KeyDesc &kd) { return load(tuple + kd.offset(0), 0); }
+
+        static int compare(const uint8_t *tuple, const key_type &key, const KeyDesc &kd) {
+            return compare(tuple + kd.offset(0), key, 0);
+        }
+    };
+
+    template<>
+    struct KeyTraits<int> : NativeKeyTraits<int> {
+        static constexpr type_t type = type_t::INT;
+    };
+
+    template<>
+    struct KeyTraits<double> : NativeKeyTraits<double> {
+        static constexpr type_t type = type_t::DOUBLE;
+    };
+
+    template<>
+    struct KeyTraits<NormalizedKey> {
+        using key_type = NormalizedKey;
+        using slot_type = uint8_t;
+
+        /// The slot size depends on the key fields and is only known at runtime
+        static constexpr size_t static_size = 0;
+
+        static key_type load(const uint8_t *slot, size_t size) {
+            return {std::string(reinterpret_cast<const char *>(slot), size)};
+        }
+
+        static void store(uint8_t *slot, const key_type &key, size_t size) {
+            std::memset(slot, 0, size);
+            std::memcpy(slot, key.bytes.data(), std::min(size, key.bytes.size()));
+        }
+
+        static int compare(const uint8_t *slot, const key_type &key, size_t size) {
+            size_t n = std::min(size, key.bytes.size());
+            int cmp = std::memcmp(slot, key.bytes.data(), n);
+            if (cmp != 0) {
+                return cmp;
+            }
+            return (size > key.bytes.size()) - (size < key.bytes.size());
+        }
+
+        static uint64_t hash(const key_type &key) {
+            return hash_bytes(reinterpret_cast<const uint8_t *>(key.bytes.data()), key.bytes.size());
+        }
+
+        static key_type extract(const Tuple &t, const KeyDesc &kd) { return kd.normalize(t); }
+
+        static key_type extract(const uint8_t *tuple, const KeyDesc &kd) { return kd.normalize(tuple); }
+
+        static int compare(const uint8_t *tuple, const key_type &key, const KeyDesc &kd) {
+            return kd.compare(tuple, key);
+        }
+    };
+
+    /**
+     * @brief Find the first position in a sorted array whose element is not less than (or, if `upper`, greater
+     * than) the key
+     * @details The loop body compiles to a conditional move, so the search has no data-dependent branches.
+     */
+    template<bool upper, typename T>
+    size_t branchless_search(const T *keys, size_t n, const T &key) {
+        if (n == 0) {
+            return 0;
+        }
+        const T *base = keys;
+        while (n > 1) {
+            size_t half = n / 2;
+            base = (upper ? !(key < base[half]) : base[half] < key) ? base + half : base;
+            n -= half;
+        }
+        return (base - keys) + (upper ? !(key < *base) : *base < key);
+    }
+} // namespace db
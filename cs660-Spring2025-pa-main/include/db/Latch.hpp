@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace db {
+
+/**
+ * @brief A version latch for optimistic lock coupling.
+ * @details Readers do not acquire the latch. They remember the version before reading and validate it afterwards,
+ * restarting if a writer changed the page in between. Writers lock the latch exclusively, either directly or by
+ * upgrading a version they read before. The version is even while the latch is free and it grows by one on lock and
+ * on unlock, so every modification produces a new version.
+ */
+    class OptLatch {
+        std::atomic<uint64_t> version{0};
+
+    public:
+        /**
+         * @brief Wait until no writer holds the latch and return the current version
+         */
+        uint64_t readLock() const {
+            uint64_t v = version.load(std::memory_order_acquire);
+            while (v & 1) {
+                std::this_thread::yield();
+                v = version.load(std::memory_order_acquire);
+            }
+            return v;
+        }
+
+        /**
+         * @brief Check that the latch was not locked since `v` was read
+         */
+        bool validate(uint64_t v) const {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return version.load(std::memory_order_relaxed) == v;
+        }
+
+        /**
+         * @brief Lock the latch if it is still at version `v`
+         * @return false if a writer changed the page since `v` was read
+         */
+        bool tryUpgrade(uint64_t v) {
+            return version.compare_exchange_strong(v, v + 1, std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Lock the latch unless a writer holds it
+         * @return false if a writer holds the latch
+         */
+        bool tryLock() {
+            uint64_t v = version.load(std::memory_order_acquire);
+            return !(v & 1) && tryUpgrade(v);
+        }
+
+        void lock() {
+            while (!tryUpgrade(readLock()));
+        }
+
+        void unlock() { version.fetch_add(1, std::memory_order_release); }
+    };
+} // namespace db
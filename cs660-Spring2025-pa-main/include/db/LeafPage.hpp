@@ -1,6 +1,8 @@
 #pragma once
 
-#include <db/Tuple.hpp>
+#include <db/Key.hpp>
+#include <db/SlottedPage.hpp>
+#include <optional>
 
 namespace db {
 
@@ -10,34 +12,158 @@ namespace db {
 
         /// The number of tuples in the page
         uint16_t size;
+
+        /// The offset of the first tuple byte of a leaf with variable-length tuples, see SlottedPage
+        uint16_t start;
+    };
+
+    /**
+     * @brief The range of keys of a compressed leaf, stored after its header
+     * @details The range is the one the parent assigns to the leaf: from the separator on its left up to the separator
+     * on its right. All-zero bytes stand for the whole range of `int`, so that a new page is a valid leaf.
+     */
+    struct LeafFence {
+        /// The smallest key the leaf may hold
+        int64_t low;
+
+        /// One more than the largest key the leaf may hold
+        int64_t high;
     };
 
-    struct LeafPage {
+    template<typename Key>
+    struct BasicLeafPage {
+        using key_type = typename KeyTraits<Key>::key_type;
+
         const TupleDesc &td;
 
-        /// The index of the key in a tuple (the key field should be of type int)
-        const size_t key_index;
+        /// The fields of a tuple that form the key
+        const KeyDesc kd;
+
+        /// Whether tuples with equal keys are kept side by side instead of replaced
+        const bool duplicates;
 
         uint16_t capacity;
 
         LeafPageHeader *header;
         uint8_t *data;
 
+        /// The slot directory of a leaf with variable-length tuples, kept in key order
+        std::optional<SlottedPage> slotted;
+
+        /// Whether the keys are stored relative to the fence, see BTreeOptions::compress
+        const bool compressed;
+
+        /// The number of bytes of the page
+        const size_t page_size;
+
+        /// The key range of a compressed leaf
+        LeafFence *fence = nullptr;
+
+        /// The number of bytes of a key and of a whole entry of a compressed leaf
+        size_t key_bytes = 0;
+        size_t record = 0;
+
         /**
          * @brief Initialize a leaf page
          *
          * @details The provided page has a header of type LeafPageHeader, followed by a sequence of tuples.
          * The capacity of the page is calculated based on the remaining size of the page and the size of the tuples.
+         * Tuples with VARCHAR fields use a slotted layout instead (see SlottedPage), where the directory entries are
+         * sorted and the capacity only bounds the number of tuples.
          *
          * @param page the page contents
          * @param td the tuple descriptor
          * @param key_index the index of the key in the tuple
          */
-        LeafPage(Page &page, const TupleDesc &td, size_t key_index);
+        BasicLeafPage(Page &page, const TupleDesc &td, size_t key_index);
+
+        /**
+         * @brief Initialize a leaf page whose key is made of one or more fields
+         * @param page the page contents
+         * @param td the tuple descriptor
+         * @param kd the key fields
+         * @param duplicates whether tuples with equal keys are kept
+         * @param compressed whether the page is a compressed leaf: each entry stores its key as the difference from
+         * the low end of the fence, in as few bytes as the width of the fence needs, followed by the other fields
+         * @param page_size the number of bytes of the page
+         */
+        BasicLeafPage(Page &page, const TupleDesc &td, const KeyDesc &kd, bool duplicates = false,
+                      bool compressed = false, size_t page_size = DEFAULT_PAGE_SIZE);
+
+        /**
+         * @brief Get the number of tuples in the page
+         * @details The size in the header is clamped to the capacity: the constructor does not reset a size that is
+         * out of range, since optimistic readers may only read the page and a failed validation restarts them.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the serialized tuple at the specified slot
+         * @throws std::logic_error if the leaf is compressed, whose entries are not serialized tuples (see row)
+         */
+        const uint8_t *tuple(size_t slot) const;
+
+        /**
+         * @brief Get the serialized tuple at the specified slot, decoding it into a buffer if the leaf is compressed
+         * @details The tuples of a slotted leaf are copied into the buffer once their slot is checked to lie within
+         * the page, so that reading a leaf optimistically while it changes never decodes bytes outside the page: a
+         * slot that does not gives an empty tuple, which the failed validation of the read discards.
+         * @return the tuple in the page, or in the buffer
+         */
+        const uint8_t *row(size_t slot, Page &buffer) const;
+
+        /**
+         * @brief Compare the key at the specified slot with a key
+         * @return a negative number, zero or a positive number if the key at the slot is smaller, equal or greater
+         */
+        int compare(size_t slot, const key_type &key) const;
+
+        /**
+         * @brief Get the key range of a compressed leaf, with the all-zero fence resolved
+         */
+        LeafFence bounds() const;
+
+        /**
+         * @brief Change the key range of a compressed leaf, re-encoding its entries
+         * @details The tuples must fit the new range, and the leaf must have room for them at the new width.
+         */
+        void setFence(int64_t low, int64_t high);
+
+        /**
+         * @brief Get the number of entries of a compressed leaf with a given key range
+         */
+        size_t capacityFor(int64_t low, int64_t high) const;
+
+        /**
+         * @brief Get the key of the tuple at the specified slot
+         */
+        key_type key(size_t slot) const;
+
+        /**
+         * @brief Whether the next insert may fill the page, so that it has to be split
+         */
+        bool nearlyFull() const;
+
+        /**
+         * @brief Whether the page is full and has to be split before the next insert
+         */
+        bool full() const;
+
+        /**
+         * @brief Find the first slot whose key is not less than the provided key
+         */
+        size_t lowerBound(const key_type &key) const;
+
+        /**
+         * @brief Find the first slot whose key is greater than the provided key
+         */
+        size_t upperBound(const key_type &key) const;
 
         /**
          * @brief Insert a tuple into the page
          * @details The tuple is inserted in sorted order based on the key. If the key already exists, the previous tuple is replaced.
+         * With duplicates, the tuple is inserted after the tuples with an equal key instead. A page with
+         * variable-length tuples is full once the longest possible tuple may no longer fit.
          * @return true if the leaf is full and needs to be split.
          */
         bool insertTuple(const Tuple &t);
@@ -45,10 +171,21 @@ namespace db {
         /**
          * @brief Split the leaf page
          * @details The page is split into two pages. The old page contains the first half of the tuples, and the new page contains the second half.
+         * With variable-length tuples, the halves hold about the same number of bytes instead.
+         * With duplicates, the split point moves to the closest boundary between two keys, so that a run of equal keys
+         * stays on one page unless it fills most of the page.
          * @param new_page a new empty page
          * @return the split key (the first key of the new page)
          */
-        int split(LeafPage &new_page);
+        key_type split(BasicLeafPage &new_page);
+
+        /**
+         * @brief Remove the tuple at the specified slot
+         * @details The following tuples are shifted left to keep the page sorted.
+         * @param slot the slot of the tuple to remove
+         * @throws std::runtime_error if the slot is not occupied
+         */
+        void remove(size_t slot);
 
         /**
          * @brief Get a tuple from the database file.
@@ -58,8 +195,30 @@ namespace db {
          */
         Tuple getTuple(size_t slot) const;
 
+        /**
+         * @brief Get a view of the tuple at the specified slot, pointing into the page
+         * @throws std::runtime_error if the slot is not occupied
+         * @throws std::logic_error if the leaf is compressed
+         */
+        TupleView getView(size_t slot) const;
 
         void clear();
+
+    private:
+        /// Compute the key width, the entry size and the capacity of a compressed leaf from its fence
+        void layout();
+
+        size_t keyBytes(const LeafFence &range) const;
+
+        uint8_t *entry(size_t slot) const;
+
+        int decodeKey(size_t slot) const;
+
+        void encode(size_t slot, const uint8_t *row);
+
+        void decode(size_t slot, uint8_t *row) const;
     };
 
+    using LeafPage = BasicLeafPage<int>;
+
 } // namespace db
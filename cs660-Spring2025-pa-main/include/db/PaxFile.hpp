@@ -0,0 +1,53 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+#include <functional>
+
+namespace db {
+    /**
+     * @brief A file of PAX pages, for scans that read a few fields of many tuples
+     * @details Tuples are inserted, deleted and iterated like in a HeapFile, but every page stores its tuples column by
+     * column (see PaxPage). Reading a whole tuple gathers it from all the minipages of its page, so point reads are
+     * slower than in a HeapFile, while scanColumn reads one minipage per page.
+     * @note Only fixed-length tuples are supported.
+     */
+    class PaxFile : public DbFile {
+    public:
+        /**
+         * @throws std::logic_error if the tuples have VARCHAR fields.
+         */
+        PaxFile(const std::string &name, const TupleDesc &td);
+
+        /**
+         * @brief Insert a tuple into the last page, or into a new page if the last page is full.
+         * @param t The tuple to be inserted.
+         */
+        void insertTuple(const Tuple &t) override;
+
+        /**
+         * @brief Delete a tuple by marking its slot unused.
+         * @param it The iterator that identifies the tuple to be deleted.
+         */
+        void deleteTuple(const Iterator &it) override;
+
+        /**
+         * @brief Visit one field of every tuple.
+         * @details Only the occupancy bitmap and the minipage of the field are read from every page.
+         * @param field The index of the field.
+         * @param callback Called with the serialized value of the field of every tuple, in file order, such as an
+         * `int` for an INT field. The value may not be aligned.
+         * @throws std::out_of_range if the field does not exist.
+         */
+        void scanColumn(size_t field, const std::function<void(const uint8_t *value)> &callback) const;
+
+        using DbFile::getTuple;
+
+        Tuple getTuple(const Iterator &it) const override;
+
+        void next(Iterator &it) const override;
+
+        Iterator begin() const override;
+
+        Iterator end() const override;
+    };
+} // namespace db
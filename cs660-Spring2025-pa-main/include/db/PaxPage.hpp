@@ -0,0 +1,84 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+
+namespace db {
+    /**
+     * @brief A page that stores tuples column by column (PAX)
+     * @details The page holds as many tuples as a HeapPage and uses the same occupancy bitmap, but the values of each
+     * field are stored together in a minipage: field `i` of slot `s` is at `column(i) + s * width(i)`. A scan of one
+     * field reads the bitmap and that minipage only, instead of every byte of every tuple.
+     * @note Only fixed-length tuples are supported.
+     */
+    class PaxPage {
+        const TupleDesc &td;
+        size_t capacity;
+        uint8_t *header;
+        uint8_t *data;
+
+    public:
+        /**
+         * @brief Wrap a page with a PAX page.
+         * @param page The page to be wrapped.
+         * @param td The tuple descriptor of the page.
+         * @throws std::logic_error if the tuples have VARCHAR fields.
+         */
+        PaxPage(Page &page, const TupleDesc &td);
+
+        /**
+         * @brief Get the first occupied slot of the page, or end() if the page is empty.
+         */
+        size_t begin() const;
+
+        /**
+         * @brief Get the end of the page, the number of slots.
+         */
+        size_t end() const;
+
+        /**
+         * @brief Insert a tuple into the first free slot.
+         * @param t The tuple to be inserted.
+         * @param slot If not null, receives the slot the tuple was written to.
+         * @return True if the tuple is inserted, false if the page is full.
+         */
+        bool insertTuple(const Tuple &t, size_t *slot = nullptr);
+
+        /**
+         * @brief Delete a tuple by marking its slot unused.
+         * @throws std::runtime_error if the slot is out of range or not occupied.
+         */
+        void deleteTuple(size_t slot);
+
+        /**
+         * @brief Check if a slot is free.
+         */
+        bool empty(size_t slot) const;
+
+        /**
+         * @brief Get the tuple at the specified slot, gathered from the minipages.
+         * @throws std::runtime_error if the slot is not occupied.
+         */
+        Tuple getTuple(size_t slot) const;
+
+        /**
+         * @brief Advance the slot to the next occupied slot, or end().
+         */
+        void next(size_t &slot) const;
+
+        /**
+         * @brief Get the minipage of a field, with the value of slot `s` at `s * width(field)`.
+         */
+        const uint8_t *column(size_t field) const;
+
+        /**
+         * @brief Get the number of bytes of a value of a field.
+         */
+        size_t width(size_t field) const;
+
+        /**
+         * @brief Get the occupancy bitmap, most significant bit first: slot `s` is occupied if bit `7 - s % 8` of byte
+         * `s / 8` is set.
+         */
+        const uint8_t *bitmap() const;
+    };
+} // namespace db
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+
+namespace db {
+    enum class op_t {
+        EQ, NE, LT, LE, GT, GE
+    };
+
+    /**
+     * @brief Compare two values with an operator, `a op b`
+     */
+    template<typename T>
+    bool compare(op_t op, const T &a, const T &b) {
+        switch (op) {
+            case op_t::EQ:
+                return a == b;
+            case op_t::NE:
+                return a != b;
+            case op_t::LT:
+                return a < b;
+            case op_t::LE:
+                return a <= b;
+            case op_t::GT:
+                return a > b;
+            case op_t::GE:
+                return a >= b;
+        }
+        return false;
+    }
+
+    /**
+     * @brief A comparison of a field with a constant, such as `price < 10.0`
+     */
+    struct Predicate {
+        /// The index of the field in the tuple
+        size_t field;
+
+        op_t op;
+
+        /// The constant, of the same type as the field
+        field_t value;
+
+        /**
+         * @brief Check that the predicate can be applied to tuples of a TupleDesc
+         * @throws std::logic_error if the field does not exist or its type differs from the type of the value
+         */
+        void check(const TupleDesc &td) const;
+
+        /**
+         * @brief Whether a tuple satisfies the predicate
+         */
+        bool matches(const Tuple &t) const;
+
+        /**
+         * @brief Whether a serialized tuple satisfies the predicate, without copying the field
+         */
+        bool matches(const TupleView &t) const;
+
+        /**
+         * @brief Whether some value in the range [min, max] may satisfy the predicate
+         * @details Used to skip data whose numeric field is known to lie in the range.
+         */
+        bool mayMatch(double min, double max) const;
+    };
+} // namespace db
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <db/BTreeFile.hpp>
+
+namespace db {
+    class HeapFile;
+
+    /**
+     * @brief The location of a tuple in a HeapFile
+     */
+    struct RecordId {
+        size_t page;
+        size_t slot;
+
+        auto operator<=>(const RecordId &) const = default;
+    };
+
+    /**
+     * @brief A B+tree over some fields of a HeapFile whose entries point to the heap tuples
+     * @details Every entry is a tuple made of the key fields followed by the record id (page and slot) of a heap tuple,
+     * and the whole entry is the key of the tree: tuples with equal keys are distinct entries, ordered by record id.
+     * Once attached with HeapFile::addIndex, the index is maintained by HeapFile::insertTuple and
+     * HeapFile::deleteTuple.
+     * @note The index is a DbFile of its own and has to be added to the Database like any other file.
+     */
+    class SecondaryIndex : public BasicBTreeFile<NormalizedKey> {
+        HeapFile &heap;
+        std::vector<size_t> key_indices;
+
+        Tuple entry(const Tuple &t, const RecordId &rid) const;
+
+        RecordId recordId(const Tuple &entry) const;
+
+        KeyDesc prefix(const Tuple &key) const;
+
+        std::vector<Tuple> fetch(std::vector<RecordId> &rids) const;
+
+    public:
+        /**
+         * @brief Initialize a secondary index
+         * @param name the name of the index file
+         * @param heap the indexed file
+         * @param key_indices the indices of the key fields in the heap tuples, most significant first
+         * @throws std::logic_error if there are no key fields, too many key fields, or an index is out of range
+         */
+        SecondaryIndex(const std::string &name, HeapFile &heap, const std::vector<size_t> &key_indices);
+
+        HeapFile &getHeapFile() const;
+
+        const std::vector<size_t> &getKeyIndices() const;
+
+        /**
+         * @brief Index all tuples of the heap file
+         * @details The heap is scanned once, the entries are sorted and bulk loaded into the empty tree.
+         * @throws std::logic_error if the index is not empty
+         */
+        void build();
+
+        /**
+         * @brief Add the entry of a heap tuple
+         * @param t the heap tuple
+         * @param rid the location of the tuple in the heap file
+         */
+        void insertEntry(const Tuple &t, const RecordId &rid);
+
+        /**
+         * @brief Remove the entry of a heap tuple
+         * @param t the heap tuple
+         * @param rid the location of the tuple in the heap file
+         * @return true if the entry was found
+         */
+        bool deleteEntry(const Tuple &t, const RecordId &rid);
+
+        /**
+         * @brief Find the locations of the heap tuples with the given key
+         * @param key the key fields, in the order of the key indices
+         * @return the record ids in ascending order
+         * @throws std::logic_error if the key does not match the key fields
+         */
+        std::vector<RecordId> lookupIds(const Tuple &key) const;
+
+        /**
+         * @brief Find the heap tuples with the given key
+         * @details Every heap page that holds a match is fetched once, and no other page is read.
+         * @param key the key fields, in the order of the key indices
+         * @return the tuples in record id order
+         */
+        std::vector<Tuple> lookup(const Tuple &key) const;
+
+        /**
+         * @brief Find the heap tuples whose key is in the range [low, high]
+         * @details The record ids are sorted before the heap is accessed, so every heap page is fetched once.
+         * @param low the smallest key, a prefix of the key fields
+         * @param high the largest key, a prefix of the key fields
+         * @return the tuples in record id order
+         */
+        std::vector<Tuple> range(const Tuple &low, const Tuple &high) const;
+    };
+} // namespace db
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <db/Predicate.hpp>
+#include <bit>
+
+namespace db {
+    /**
+     * @brief The set of slots of a page that are still candidates for a scan
+     * @details Starts from the occupancy bitmap of a page and is narrowed by evaluating predicates directly on the
+     * page bytes, a block of slots at a time, before any tuple is looked at. On x86-64 CPUs with AVX2, INT and DOUBLE
+     * predicates are evaluated with gather and compare instructions, otherwise with a scalar loop.
+     */
+    class Selection {
+        std::vector<uint64_t> words;
+        size_t slots;
+
+    public:
+        /**
+         * @brief Select the occupied slots of a page
+         * @param bitmap the occupancy bitmap, most significant bit first as in HeapPage and PaxPage
+         * @param size the number of slots
+         */
+        Selection(const uint8_t *bitmap, size_t size);
+
+        /**
+         * @brief Whether a predicate can be evaluated by filter
+         * @return true for INT and DOUBLE constants
+         */
+        static bool vectorizable(const Predicate &p);
+
+        /**
+         * @brief Remove the slots whose value does not satisfy a predicate
+         * @param p the predicate, whose field is ignored
+         * @param values the value of the field for slot 0; the value for slot `s` is at `values + s * stride`
+         * @param stride the number of bytes between the values of consecutive slots
+         * @throws std::logic_error if the predicate is not vectorizable
+         */
+        void filter(const Predicate &p, const uint8_t *values, size_t stride);
+
+        /**
+         * @brief Remove the slots whose dictionary code is, or is not, a given code
+         * @param code the code to compare with
+         * @param equal whether to keep the slots with the code or the others
+         * @param values the code of slot 0; the code of slot `s` is at `values + s * stride`
+         * @param stride the number of bytes between the codes of consecutive slots
+         * @param width the number of bytes of a code: 1, 2 or 4
+         */
+        void filterCode(uint32_t code, bool equal, const uint8_t *values, size_t stride, size_t width);
+
+        bool test(size_t slot) const;
+
+        /**
+         * @brief Get the number of selected slots
+         */
+        size_t count() const;
+
+        bool none() const;
+
+        /**
+         * @brief Call a function with every selected slot, in ascending order
+         */
+        template<typename Function>
+        void forEach(Function &&function) const {
+            for (size_t i = 0; i < words.size(); i++) {
+                for (uint64_t bits = words[i]; bits != 0; bits &= bits - 1) {
+                    function(i * 64 + std::countr_zero(bits));
+                }
+            }
+        }
+    };
+} // namespace db
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <db/types.hpp>
+
+namespace db {
+
+    /**
+     * @brief An entry of the slot directory of a slotted page
+     */
+    struct Slot {
+        /// The offset of the tuple in the page, 0 for an empty slot
+        uint16_t offset;
+
+        /// The number of bytes of the tuple
+        uint16_t length;
+    };
+
+    /**
+     * @brief The space management of a page whose tuples differ in length
+     * @details The page starts with a header, followed by a directory of Slot entries that grows towards the end of
+     * the page, while tuples are written from the end of the page towards the directory. Deleted tuples leave holes,
+     * which are reclaimed by compacting the page once the space between the directory and the tuples runs out.
+     *
+     * The owner of the page keeps the number of directory entries and the start of the tuples in its header. A start
+     * of 0 stands for the end of the page, so that a zeroed page is empty.
+     */
+    class SlottedPage {
+        uint8_t *page;
+        size_t page_size;
+        size_t header_size;
+        uint16_t &count;
+        uint16_t &start;
+
+        size_t tuplesBegin() const;
+
+    public:
+        Slot *slots;
+
+        /**
+         * @param page the page contents
+         * @param header_size the number of bytes before the directory
+         * @param count the number of directory entries, stored in the header
+         * @param start the offset of the first tuple byte, stored in the header
+         * @param page_size the number of bytes of the page, up to MAX_PAGE_SIZE: the end of a 64K page does not fit an
+         * offset, but a start of 0 stands for it
+         */
+        SlottedPage(Page &page, size_t header_size, uint16_t &count, uint16_t &start,
+                    size_t page_size = DEFAULT_PAGE_SIZE);
+
+        /**
+         * @brief Get the bytes of the tuple of a directory entry
+         */
+        uint8_t *tuple(size_t slot) const;
+
+        /**
+         * @brief Get the number of bytes available for tuples, including holes
+         * @param new_slots the number of directory entries that will be added
+         */
+        size_t freeSpace(size_t new_slots = 0) const;
+
+        /**
+         * @brief Reserve space for a tuple, compacting the page if needed
+         * @details The directory is left as it is: the caller points an entry to the space.
+         * @param length the number of bytes of the tuple
+         * @param new_slot whether the caller adds a directory entry for the tuple
+         * @return the space, or nullptr if the page does not have enough free space
+         */
+        uint8_t *allocate(size_t length, bool new_slot);
+
+        /**
+         * @brief Move the tuples to the end of the page, removing the holes between them
+         */
+        void compact();
+    };
+
+} // namespace db
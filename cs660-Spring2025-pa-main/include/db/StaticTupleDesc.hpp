@@ -0,0 +1,224 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+namespace db {
+
+    /**
+     * @brief A CHAR field of a StaticTupleDesc
+     * @details Only the width of the runtime CHAR type is supported, so that static and runtime schemas share files.
+     */
+    template<size_t N>
+    struct Char {
+        static_assert(N == CHAR_SIZE, "CHAR fields are CHAR_SIZE bytes wide");
+    };
+
+    /**
+     * @brief How a field type of a StaticTupleDesc maps to the runtime schema and to bytes
+     * @details `get` reads a field without allocating: CHAR fields are returned as a view of their bytes.
+     */
+    template<typename T>
+    struct FieldTraits;
+
+    template<>
+    struct FieldTraits<int> {
+        using value_type = int;
+        static constexpr type_t type = type_t::INT;
+        static constexpr size_t size = INT_SIZE;
+
+        static int get(const uint8_t *data) {
+            int value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        static void put(uint8_t *data, int value) { std::memcpy(data, &value, sizeof(value)); }
+    };
+
+    template<>
+    struct FieldTraits<double> {
+        using value_type = double;
+        static constexpr type_t type = type_t::DOUBLE;
+        static constexpr size_t size = DOUBLE_SIZE;
+
+        static double get(const uint8_t *data) {
+            double value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        static void put(uint8_t *data, double value) { std::memcpy(data, &value, sizeof(value)); }
+    };
+
+    template<size_t N>
+    struct FieldTraits<Char<N>> {
+        using value_type = std::string;
+        static constexpr type_t type = type_t::CHAR;
+        static constexpr size_t size = N;
+
+        static std::string_view get(const uint8_t *data) {
+            const char *chars = reinterpret_cast<const char *>(data);
+            return {chars, strnlen(chars, N)};
+        }
+
+        static void put(uint8_t *data, std::string_view value) {
+            // Zero padded like strncpy, and unterminated at full width.
+            size_t n = std::min(value.size(), N);
+            std::memcpy(data, value.data(), n);
+            std::memset(data + n, 0, N - n);
+        }
+    };
+
+    /**
+     * @brief A schema known at compile time, such as `StaticTupleDesc<int, double, Char<64>>`
+     * @details Offsets and length are constants and every field access is resolved at compile time, so serialization
+     * compiles to a sequence of fixed-offset copies without switching on the field types. The layout is the one of the
+     * runtime TupleDesc with the same types, so a file can be written with one and read with the other.
+     */
+    template<typename... Fields>
+    class StaticTupleDesc {
+        static constexpr std::array<size_t, sizeof...(Fields)> computeOffsets() {
+            std::array<size_t, sizeof...(Fields)> result{};
+            size_t sizes[] = {FieldTraits<Fields>::size..., 0};
+            size_t offset = 0;
+            for (size_t i = 0; i < sizeof...(Fields); i++) {
+                result[i] = offset;
+                offset += sizes[i];
+            }
+            return result;
+        }
+
+        template<size_t... I>
+        static void serializeFields(uint8_t *data, const Tuple &t, std::index_sequence<I...>) {
+            (FieldTraits<Fields>::put(data + offsets[I], std::get<typename FieldTraits<Fields>::value_type>(
+                                                                  t.get_field(I))),
+             ...);
+        }
+
+    public:
+        using value_type = std::tuple<typename FieldTraits<Fields>::value_type...>;
+
+        template<size_t I>
+        using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+        static constexpr std::array<size_t, sizeof...(Fields)> offsets = computeOffsets();
+
+        static constexpr std::array<type_t, sizeof...(Fields)> types = {FieldTraits<Fields>::type...};
+
+        /**
+         * @brief Get the number of fields
+         */
+        static constexpr size_t size() { return sizeof...(Fields); }
+
+        /**
+         * @brief Get the number of bytes of a serialized tuple
+         */
+        static constexpr size_t length() { return (FieldTraits<Fields>::size + ... + 0); }
+
+        /**
+         * @brief Read the I-th field of a serialized tuple
+         * @return the value, or a view of the characters of a CHAR field
+         */
+        template<size_t I>
+        static auto get(const uint8_t *data) {
+            return FieldTraits<field_type<I>>::get(data + offsets[I]);
+        }
+
+        /**
+         * @brief Write the I-th field of a serialized tuple
+         */
+        template<size_t I, typename T>
+        static void put(uint8_t *data, const T &value) {
+            FieldTraits<field_type<I>>::put(data + offsets[I], value);
+        }
+
+        /**
+         * @brief Serialize a tuple of values
+         */
+        static void serialize(uint8_t *data, const value_type &values) {
+            std::apply([&](const auto &...v) { serialize(data, v...); }, values);
+        }
+
+        /**
+         * @brief Serialize one value per field
+         */
+        static void serialize(uint8_t *data, const typename FieldTraits<Fields>::value_type &...values) {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (FieldTraits<Fields>::put(data + offsets[I], values), ...);
+            }(std::index_sequence_for<Fields...>{});
+        }
+
+        /**
+         * @brief Serialize a runtime Tuple
+         * @throws std::logic_error if the tuple does not have the types of the schema
+         */
+        static void serialize(uint8_t *data, const Tuple &t) {
+            if (!compatible(t)) {
+                throw std::logic_error("Tuple not compatible with the schema");
+            }
+            serializeFields(data, t, std::index_sequence_for<Fields...>{});
+        }
+
+        /**
+         * @brief Deserialize a tuple of values
+         */
+        static value_type deserialize(const uint8_t *data) {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return value_type(typename FieldTraits<Fields>::value_type(get<I>(data))...);
+            }(std::index_sequence_for<Fields...>{});
+        }
+
+        /**
+         * @brief Deserialize into a runtime Tuple
+         */
+        static Tuple toTuple(const uint8_t *data) {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return Tuple({field_t(typename FieldTraits<Fields>::value_type(get<I>(data)))...});
+            }(std::index_sequence_for<Fields...>{});
+        }
+
+        /**
+         * @brief Check whether a runtime Tuple has the types of the schema
+         */
+        static bool compatible(const Tuple &t) {
+            if (t.size() != size()) {
+                return false;
+            }
+            for (size_t i = 0; i < size(); i++) {
+                if (t.field_type(i) != types[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Check whether a runtime TupleDesc has the same layout, so that both can read the same files
+         */
+        static bool matches(const TupleDesc &td) {
+            if (td.size() != size() || td.length() != length()) {
+                return false;
+            }
+            for (size_t i = 0; i < size(); i++) {
+                if (td.type_of(i) != types[i] || td.offset_of(i) != offsets[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Build the runtime TupleDesc of the schema
+         * @param names the names of the fields
+         * @throws std::logic_error if the number of names is wrong or names are not unique
+         */
+        static TupleDesc desc(const std::vector<std::string> &names) {
+            return {std::vector<type_t>(types.begin(), types.end()), names};
+        }
+    };
+
+} // namespace db
@@ -1,23 +1,51 @@
 #pragma once
 
 #include <db/types.hpp>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace db {
+    class Dictionary;
     class TupleDesc;
 
     class Tuple {
+        friend class TupleDesc;
+
         std::vector<field_t> fields;
 
     public:
         Tuple(const std::vector<field_t> &fields);
 
+        /**
+         * @brief Take the fields of a vector without copying them
+         */
+        Tuple(std::vector<field_t> &&fields) noexcept;
+
+        /**
+         * @brief Construct the fields in place, e.g. `Tuple(std::in_place, 1, "name", 2.5)`
+         */
+        template<typename... Fields>
+        explicit Tuple(std::in_place_t, Fields &&...values) {
+            fields.reserve(sizeof...(Fields));
+            (fields.emplace_back(std::forward<Fields>(values)), ...);
+        }
+
         type_t field_type(size_t i) const;
 
         size_t size() const;
 
         const field_t &get_field(size_t i) const;
+
+        /**
+         * @brief Replace a field
+         * @details A string field that is given a string is overwritten in place, so a Tuple reused for every row of
+         * a load does not allocate once its strings are large enough.
+         * @throws std::out_of_range if the field does not exist
+         */
+        void set_field(size_t i, const field_t &value);
     };
 
     class TupleDesc {
@@ -26,6 +54,21 @@ namespace db {
         std::vector<size_t> offsets;
         std::unordered_map<std::string, size_t> name_to_index;
 
+        /// The serialized length, computed once since pages ask for it on every access
+        size_t bytes = 0;
+
+        /// The number of VARCHAR fields
+        size_t varchars = 0;
+
+        /// The dictionary of every DICT field, null for the other fields; empty if there are no DICT fields
+        std::vector<std::shared_ptr<Dictionary>> dictionaries;
+
+        /// Compute the offsets and the length from the types
+        void layout();
+
+        /// Deserialize field `i` of the serialized Tuple `data` into `field`, reusing its string
+        void read(const uint8_t *data, size_t i, field_t &field) const;
+
     public:
         TupleDesc() = default;
 
@@ -39,6 +82,25 @@ namespace db {
          */
         TupleDesc(const std::vector<type_t> &types, const std::vector<std::string> &names);
 
+        /**
+         * @brief Dictionary-encode a CHAR field
+         * @details The field becomes a DICT field: tuples still hold a string for it, but it is serialized as its
+         * code in the dictionary, in `dictionary->width()` bytes, and new values are added to the dictionary as they
+         * are serialized. Copies of the TupleDesc share the dictionary.
+         * @param index the index of the field
+         * @param dictionary the dictionary of the values of the field, usually kept next to the file
+         * @return the TupleDesc with the field encoded
+         * @throws std::out_of_range if the field does not exist
+         * @throws std::logic_error if the field is not a CHAR field or the dictionary is null
+         */
+        TupleDesc withDictionary(size_t index, std::shared_ptr<Dictionary> dictionary) const;
+
+        /**
+         * @brief Get the dictionary of a DICT field
+         * @return the dictionary, or null if the field is not a DICT field
+         */
+        const Dictionary *dictionary_of(size_t index) const;
+
         /**
          * @brief Check if the provided Tuple is compatible with this TupleDesc
          * @details A Tuple is compatible with a TupleDesc if the Tuple has the same number of fields and each field is of the
@@ -56,6 +118,13 @@ namespace db {
          */
         size_t offset_of(const size_t &index) const;
 
+        /**
+         * @brief Get the type of the field
+         * @param index the index of the field
+         * @return the type of the field
+         */
+        type_t type_of(const size_t &index) const;
+
         /**
          * @brief Get the index of the field
          * @details The index of the field is the position of the field in the Tuple
@@ -64,6 +133,12 @@ namespace db {
          */
         size_t index_of(const std::string &name) const;
 
+        /**
+         * @brief Get the names of the fields
+         * @return the names, in the order of the fields
+         */
+        std::vector<std::string> names() const;
+
         /**
          * @brief Get the number of fields in the TupleDesc
          * @return the number of fields in the TupleDesc
@@ -72,14 +147,41 @@ namespace db {
 
         /**
          * @brief Get the length of the TupleDesc
-         * @return the number of bytes needed to serialize a Tuple with this TupleDesc
+         * @return the number of bytes needed to serialize a Tuple with this TupleDesc, or the length of the fixed
+         * part of a Tuple if it has VARCHAR fields
          */
         size_t length() const;
 
+        /**
+         * @brief Whether the TupleDesc has VARCHAR fields, so that serialized Tuples differ in length
+         * @details A serialized Tuple starts with a fixed part where every field has a constant offset; a VARCHAR
+         * field stores there the offset of its value. The values follow the fixed part, each as a 16-bit length
+         * followed by its bytes.
+         */
+        bool variable_length() const;
+
+        /**
+         * @brief Get the length of the longest serialized Tuple
+         */
+        size_t max_length() const;
+
+        /**
+         * @brief Get the number of bytes needed to serialize a Tuple
+         * @param t a compatible Tuple
+         */
+        size_t length(const Tuple &t) const;
+
+        /**
+         * @brief Get the number of bytes of a serialized Tuple
+         * @param data the serialized Tuple
+         */
+        size_t length(const uint8_t *data) const;
+
         /**
          * @brief Serialize a Tuple
-         * @param data the buffer to serialize the Tuple into
+         * @param data the buffer to serialize the Tuple into, of at least `length(t)` bytes
          * @param t the Tuple to serialize
+         * @throws std::logic_error if a VARCHAR value is longer than VARCHAR_SIZE
          */
         void serialize(uint8_t *data, const Tuple &t) const;
 
@@ -90,6 +192,46 @@ namespace db {
          */
         Tuple deserialize(const uint8_t *data) const;
 
+        /**
+         * @brief Deserialize a Tuple into an existing Tuple, reusing its storage
+         * @details The Tuple is resized to the number of fields. Its vector and the strings it already holds are
+         * reused, so deserializing every row of a scan into the same Tuple does not allocate once it has been used.
+         * @param data the buffer to deserialize the Tuple from
+         * @param t receives the fields
+         */
+        void deserialize(const uint8_t *data, Tuple &t) const;
+
+        /**
+         * @brief Deserialize some of the fields of a Tuple
+         * @details Only the listed fields are read, using their offsets, so the other fields cost nothing.
+         * @param data the buffer to deserialize the Tuple from
+         * @param columns the indices of the fields to read, in the order they appear in the result
+         * @return a Tuple with one field per column
+         * @throws std::out_of_range if a column does not exist
+         */
+        Tuple deserialize(const uint8_t *data, const std::vector<size_t> &columns) const;
+
+        /**
+         * @brief Deserialize some of the fields of a Tuple into a caller-provided buffer
+         * @details `fields` is resized to the number of columns. A CHAR field that already holds a string is
+         * overwritten in place, so reusing the same buffer for every row does not allocate once its strings are large
+         * enough.
+         * @param data the buffer to deserialize the Tuple from
+         * @param columns the indices of the fields to read
+         * @param fields receives one field per column
+         * @throws std::out_of_range if a column does not exist
+         */
+        void deserialize(const uint8_t *data, const std::vector<size_t> &columns, std::vector<field_t> &fields) const;
+
+        /**
+         * @brief Describe the Tuples produced by a projection
+         * @param columns the indices of the fields to keep, in their new order
+         * @return the TupleDesc of the projected fields, with their names
+         * @throws std::out_of_range if a column does not exist
+         * @throws std::logic_error if a column is listed twice
+         */
+        TupleDesc project(const std::vector<size_t> &columns) const;
+
         /**
          * @brief Merge two TupleDescs
          * @details The merged TupleDesc has all the fields of the two TupleDescs
@@ -99,4 +241,85 @@ namespace db {
          */
         static db::TupleDesc merge(const TupleDesc &td1, const TupleDesc &td2);
     };
+
+    /**
+     * @brief A non-owning view of a serialized tuple
+     * @details The view reads fields straight from the serialized bytes, usually inside a buffer pool frame, so
+     * accessing a field never allocates. The view is only valid as long as the bytes are: a view into a page must not
+     * be used after the page may have been evicted or modified.
+     *
+     * Tuples that are not stored serialized, such as those of compressed B-tree leaves, are decoded into bytes the
+     * view shares with its copies instead.
+     */
+    class TupleView {
+        const TupleDesc *td;
+        const uint8_t *data;
+        std::shared_ptr<const std::vector<uint8_t>> owned;
+
+    public:
+        TupleView(const TupleDesc &td, const uint8_t *data);
+
+        /**
+         * @brief View a decoded tuple, keeping its bytes alive as long as the view or a copy of it
+         */
+        TupleView(const TupleDesc &td, std::vector<uint8_t> bytes);
+
+        size_t size() const;
+
+        type_t field_type(size_t i) const;
+
+        /**
+         * @brief Get an INT field
+         * @throws std::logic_error if the field is not an INT
+         */
+        int getInt(size_t i) const;
+
+        /**
+         * @brief Get a DOUBLE field
+         * @throws std::logic_error if the field is not a DOUBLE
+         */
+        double getDouble(size_t i) const;
+
+        /**
+         * @brief Get a CHAR field, without its zero padding, or a VARCHAR or DICT field
+         * @details The value of a DICT field is viewed in its dictionary, so it stays valid after the page is gone.
+         * @throws std::logic_error if the field is not a CHAR, VARCHAR or DICT
+         */
+        std::string_view getString(size_t i) const;
+
+        /**
+         * @brief Get the code of a DICT field, which is cheaper to compare or group by than its value
+         * @throws std::logic_error if the field is not a DICT
+         */
+        uint32_t getCode(size_t i) const;
+
+        /**
+         * @brief Copy a field out of the view
+         */
+        field_t get_field(size_t i) const;
+
+        /**
+         * @brief Copy all the fields into a Tuple
+         */
+        Tuple toTuple() const;
+
+        /**
+         * @brief Copy all the fields into an existing Tuple, reusing its storage
+         * @see TupleDesc::deserialize
+         */
+        void toTuple(Tuple &t) const;
+
+        /**
+         * @brief Copy some of the fields into a Tuple
+         * @see TupleDesc::deserialize
+         */
+        Tuple toTuple(const std::vector<size_t> &columns) const;
+
+        /**
+         * @brief Get the serialized bytes
+         */
+        const uint8_t *bytes() const;
+
+        const TupleDesc &getTupleDesc() const;
+    };
 } // namespace db
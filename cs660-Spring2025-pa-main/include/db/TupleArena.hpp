@@ -0,0 +1,64 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+#include <cstddef>
+#include <memory_resource>
+
+namespace db {
+    /**
+     * @brief A monotonic arena that keeps copies of tuples alive for a scan or a batch
+     * @details A TupleView into a page is only valid while the page stays in the buffer pool. To keep rows beyond
+     * that, a scan can copy their serialized bytes into the arena instead of materializing a Tuple: the copy is a
+     * single bump allocation, its CHAR and VARCHAR fields are read as `std::string_view` without allocating, and
+     * everything is freed at once by release(). The arena is a `std::pmr::memory_resource`, so containers holding the
+     * copies, such as `std::pmr::vector<TupleView>`, can be carved from it as well.
+     * @note The TupleDesc of a copied view must outlive the copy.
+     */
+    class TupleArena {
+        /// The first block, which release() keeps
+        std::vector<std::byte> buffer;
+        std::pmr::monotonic_buffer_resource arena;
+        size_t used = 0;
+
+    public:
+        /**
+         * @param initial_size the size of the first block, later blocks grow geometrically
+         */
+        explicit TupleArena(size_t initial_size = 16 * DEFAULT_PAGE_SIZE);
+
+        TupleArena(const TupleArena &) = delete;
+
+        TupleArena &operator=(const TupleArena &) = delete;
+
+        /**
+         * @brief Copy a serialized tuple into the arena
+         * @return a view of the copy, valid until release()
+         */
+        TupleView copy(const TupleView &t);
+
+        /**
+         * @brief Serialize a Tuple into the arena
+         * @return a view of the serialized tuple, valid until release()
+         * @throws std::logic_error if a VARCHAR value is longer than VARCHAR_SIZE
+         */
+        TupleView copy(const TupleDesc &td, const Tuple &t);
+
+        /**
+         * @brief Copy a string into the arena
+         */
+        std::string_view copy(std::string_view s);
+
+        /**
+         * @brief Free everything copied into the arena at once, invalidating all the copies
+         * @details The first block is kept, so an arena reused for every batch stops allocating after the first.
+         */
+        void release();
+
+        /**
+         * @brief Get the number of bytes copied since the last release
+         */
+        size_t size() const;
+
+        std::pmr::memory_resource *resource();
+    };
+} // namespace db
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <db/types.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace db {
+    /// A position in the log: the number of bytes appended before it since the log was opened
+    using lsn_t = uint64_t;
+
+    /**
+     * @brief A redo log of page changes, see BufferPool::openLog
+     * @details A record holds the bytes of a page that changed since the page was last logged: the name of the file,
+     * the page number, and ranges of bytes with their new contents. Replaying a record writes the bytes where they
+     * belong, so replaying it twice is harmless and pages need no log sequence number of their own. A record ends
+     * up in the log before the page it describes is written to its file, and a commit waits for the records of every
+     * change before it.
+     *
+     * Appended records wait in a buffer. The first thread that needs them on disk writes the whole buffer and syncs
+     * the log once for every thread waiting meanwhile, and the records appended while it syncs are written by the
+     * next one (group commit).
+     * @note All methods are thread-safe.
+     */
+    class WriteAheadLog {
+        int fd;
+
+        mutable std::mutex mutex;
+        std::condition_variable synced;
+
+        /// The records that are not written yet
+        std::vector<uint8_t> buffer;
+
+        /// The position of the start of the log file
+        lsn_t base = 0;
+
+        /// The end of the last record appended
+        lsn_t appended = 0;
+
+        /// The end of the last record written and synced
+        lsn_t durable = 0;
+
+        /// Whether a thread is writing and syncing the log
+        bool syncing = false;
+
+        size_t syncs = 0;
+
+    public:
+        /**
+         * @brief Open a log, replaying and then discarding the records it holds
+         * @details The records are replayed into the files they name, which must not be open, see DbFile::redo. The
+         * replay stops at the first incomplete or damaged record, which was being written when the process stopped.
+         * @param path The file of the log, created if needed.
+         * @throws std::runtime_error if the log cannot be opened, read or truncated.
+         */
+        explicit WriteAheadLog(const std::string &path);
+
+        /**
+         * @brief Write and sync the records that are not written yet, then close the log.
+         */
+        ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog &) = delete;
+
+        WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+        /**
+         * @brief Append a record of changed bytes of a page
+         * @param pid The page.
+         * @param page The contents of the page.
+         * @param ranges The offset and the length of each changed range of bytes.
+         * @return The end of the record, to pass to flush.
+         */
+        lsn_t append(const PageId &pid, const uint8_t *page, const std::vector<std::pair<size_t, size_t>> &ranges);
+
+        /**
+         * @brief Get the end of the last record appended
+         */
+        lsn_t end() const;
+
+        /**
+         * @brief Wait until the log is on disk up to a position
+         * @details If no other thread is writing the log, write every record appended so far and sync the log;
+         * otherwise wait for that thread, whose sync may cover the position.
+         * @param lsn The position.
+         * @throws std::runtime_error if the log cannot be written or synced.
+         */
+        void flush(lsn_t lsn);
+
+        /**
+         * @brief Discard the records of the log, once the files hold their changes
+         * @details Positions keep growing, so positions from before the truncation are already on disk.
+         * @note No records may be appended meanwhile.
+         * @throws std::runtime_error if the log cannot be written, synced or truncated.
+         */
+        void truncate();
+
+        /**
+         * @brief Get the number of times the log was synced
+         */
+        size_t getSyncs() const;
+    };
+} // namespace db
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <db/Predicate.hpp>
+
+namespace db {
+
+    /**
+     * @brief Per-page summaries of a file: the row count and the range of every INT and DOUBLE field
+     * @details A summary is either unknown or covers every tuple on its page. Inserts widen the ranges and deletes only
+     * lower the row count, so the ranges may be wider than the data but never narrower. A page whose summary rules
+     * out a predicate does not need to be read.
+     */
+    class ZoneMap {
+        /// The indices of the INT and DOUBLE fields
+        std::vector<size_t> columns;
+
+        std::vector<bool> known;
+        std::vector<size_t> rows;
+
+        /// For every page, the minimum and maximum of every column
+        std::vector<double> bounds;
+
+        void grow(size_t page);
+
+    public:
+        explicit ZoneMap(const TupleDesc &td);
+
+        /**
+         * @brief Whether the summary of a page is known
+         */
+        bool isKnown(size_t page) const;
+
+        /**
+         * @brief Get the number of tuples of a page with a known summary
+         */
+        size_t getRows(size_t page) const;
+
+        /**
+         * @brief Start the summary of a page that has no tuples
+         */
+        void reset(size_t page);
+
+        /**
+         * @brief Add a tuple to the summary of a page
+         * @details Has no effect on an unknown summary.
+         */
+        void insert(size_t page, const Tuple &t);
+
+        /**
+         * @brief Add a serialized tuple to the summary of a page
+         * @details Has no effect on an unknown summary.
+         */
+        void insert(size_t page, const TupleView &t);
+
+        /**
+         * @brief Remove a tuple from the summary of a page
+         * @details Has no effect on an unknown summary. The ranges are reset once the page is empty.
+         */
+        void remove(size_t page);
+
+        /**
+         * @brief Whether the page may hold a tuple that satisfies all the predicates
+         * @return true if the summary is unknown
+         */
+        bool mayMatch(size_t page, const std::vector<Predicate> &predicates) const;
+    };
+
+} // namespace db
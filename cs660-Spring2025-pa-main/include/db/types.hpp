@@ -11,8 +11,18 @@ namespace db {
     constexpr size_t DOUBLE_SIZE = sizeof(double);
     constexpr size_t CHAR_SIZE = 64;
 
+    /// The longest VARCHAR value, in bytes
+    constexpr size_t VARCHAR_SIZE = 256;
+
+    /// The bytes a VARCHAR field takes in the fixed part of a tuple: the offset of its value
+    constexpr size_t VARCHAR_SLOT_SIZE = sizeof(uint16_t);
+
+    /**
+     * @brief The type of a field
+     * @details DICT is a CHAR field whose value is stored as its code in a Dictionary, see TupleDesc::withDictionary.
+     */
     enum class type_t {
-        INT, CHAR, DOUBLE
+        INT, CHAR, DOUBLE, VARCHAR, DICT
     };
 
     using field_t = std::variant<int, double, std::string>;
@@ -27,7 +37,22 @@ namespace db {
 
     constexpr size_t DEFAULT_PAGE_SIZE = 4096;
 
+    /// The largest page size a file may choose, see DbFile
+    constexpr size_t MAX_PAGE_SIZE = 16 * DEFAULT_PAGE_SIZE;
+
+    /**
+     * @brief The contents of a page
+     * @details A file with pages larger than DEFAULT_PAGE_SIZE stores each page in consecutive Page objects, see
+     * BufferPool: a `Page &` of such a file refers to the first of them, and `data()` reaches the whole page.
+     */
     using Page = std::array<uint8_t, DEFAULT_PAGE_SIZE>;
+
+    /**
+     * @brief Whether a file may use a page size: a power of two from DEFAULT_PAGE_SIZE to MAX_PAGE_SIZE
+     */
+    constexpr bool validPageSize(size_t page_size) {
+        return page_size >= DEFAULT_PAGE_SIZE && page_size <= MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+    }
 } // namespace db
 
 template<>
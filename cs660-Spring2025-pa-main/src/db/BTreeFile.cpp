@@ -2,145 +2,1067 @@
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <climits>
+#include <thread>
 #include <db/BTreeFile.hpp>
+#include <db/Batch.hpp>
+#include <db/Cursor.hpp>
 #include <db/Database.hpp>
 #include <db/IndexPage.hpp>
 #include <db/LeafPage.hpp>
 
 using namespace db;
 
-BTreeFile::BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index)
-    : DbFile(name, td), key_index(key_index) {}
+namespace {
+    /// The times lockParent waits for a split to be posted before it descends from the root again
+    constexpr size_t MAX_PARENT_MISSES = 64;
+
+    /// The times lockParent descends from the root before it gives up on a tree that has lost a page
+    constexpr size_t MAX_PARENT_DESCENTS = 1024;
+
+    /**
+     * Check the key and the options of a tree before its file is opened, and get the format of the tree in its
+     * superblock: the options and the kind of key change the layout of the pages.
+     */
+    template<typename Key>
+    uint32_t format(const TupleDesc &td, const std::vector<size_t> &key_indices, const BTreeOptions &options) {
+        KeyDesc kd(td, key_indices);
+        if constexpr (KeyTraits<Key>::static_size != 0) {
+            if (kd.size() != 1 || kd.type(0) != KeyTraits<Key>::type) {
+                throw std::logic_error("Key field type does not match the key type");
+            }
+        }
+        if (options.blink && options.duplicates) {
+            throw std::logic_error("B-link trees do not support duplicate keys");
+        }
+        if (options.compress && (!std::is_same_v<Key, int> || td.variable_length() || options.duplicates)) {
+            throw std::logic_error("Compressed leaves need INT keys, fixed-length tuples and no duplicates");
+        }
+        return 'B' | options.blink << 8 | options.duplicates << 9 | options.compress << 10 |
+               (KeyTraits<Key>::static_size == 0) << 11;
+    }
+} // namespace
+
+template<typename Key>
+BasicBTreeFile<Key>::BasicBTreeFile(const std::string &name, const TupleDesc &td, size_t key_index,
+                                    const BTreeOptions &options)
+    : BasicBTreeFile(name, td, std::vector<size_t>{key_index}, options) {}
+
+template<typename Key>
+BasicBTreeFile<Key>::BasicBTreeFile(const std::string &name, const TupleDesc &td,
+                                    const std::vector<size_t> &key_indices, const BTreeOptions &options)
+    : DbFile(name, td, options.page_size,
+             {.format = format<Key>(td, key_indices, options), .key_indices = key_indices, .root = root_id}),
+      kd(td, key_indices), key_size(KeyTraits<Key>::static_size), options(options) {
+    if constexpr (KeyTraits<Key>::static_size == 0) {
+        key_size = kd.normalizedSize();
+    }
+}
+
+template<typename Key>
+BasicLeafPage<Key> BasicBTreeFile<Key>::leafPage(Page &page) const {
+    return {page, td, kd, options.duplicates, options.compress, page_size};
+}
+
+template<typename Key>
+BasicIndexPage<Key> BasicBTreeFile<Key>::indexPage(Page &page) const {
+    return BasicIndexPage<Key>(page, key_size, options.blink, page_size);
+}
+
+template<typename Key>
+const KeyDesc &BasicBTreeFile<Key>::getKeyDesc() const { return kd; }
+
+template<typename Key>
+void BasicBTreeFile<Key>::enableBloomFilter(size_t expected_keys, size_t bits_per_key) {
+    std::vector<uint64_t> hashes;
+    for (auto it = begin(); it != end(); ++it) {
+        hashes.push_back(KeyTraits<Key>::hash(KeyTraits<Key>::extract(*it, kd)));
+    }
+    bloom = std::make_unique<BloomFilter>(std::max(expected_keys, hashes.size()), bits_per_key);
+    bloom_bits_per_key = bits_per_key;
+    for (uint64_t hash: hashes) {
+        bloom->insert(hash);
+    }
+    bloom_probes = 0;
+    bloom_negatives = 0;
+    bloom_false_positives = 0;
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::disableBloomFilter() {
+    bloom.reset();
+}
+
+template<typename Key>
+BloomFilterStats BasicBTreeFile<Key>::getBloomFilterStats() const {
+    BloomFilterStats stats;
+    stats.probes = bloom_probes;
+    stats.negatives = bloom_negatives;
+    stats.false_positives = bloom_false_positives;
+    if (stats.negatives + stats.false_positives > 0) {
+        stats.false_positive_rate =
+                static_cast<double>(stats.false_positives) / (stats.negatives + stats.false_positives);
+    }
+    if (bloom) {
+        stats.estimated_false_positive_rate = bloom->estimatedFalsePositiveRate();
+    }
+    return stats;
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::insertTuple(const Tuple &t) {
+    key_type key = KeyTraits<Key>::extract(t, kd);
+    if (bloom) {
+        // Set the bits before the tuple becomes visible, so that a reader that finds the tuple also passes the filter.
+        bloom->insert(KeyTraits<Key>::hash(key));
+    }
+    if (options.blink) {
+        insertBLink(t, key);
+        return;
+    }
+    while (!tryInsert(t, key));
+}
+
+template<typename Key>
+bool BasicBTreeFile<Key>::tryInsert(const Tuple &t, const key_type &key) {
+    using LeafPage = BasicLeafPage<Key>;
+    using IndexPage = BasicIndexPage<Key>;
 
-void BTreeFile::insertTuple(const Tuple &t) {
-    std::vector<size_t> path;
     BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, root_id};
+    PinnedPage parent(bufferPool, {name, root_id});
+    uint64_t parent_version = parent.latch().readLock();
+    IndexPage root = indexPage(*parent);
 
-    Page &root_page = bufferPool.getPage(pid);
-    IndexPage root(root_page);
+    if (root.size() == 0 && root.children[0] == root_id) {
+        // The tree is empty: create the first leaf and restart.
+        if (!parent.latch().tryUpgrade(parent_version)) {
+            return false;
+        }
+        root.children[0] = numPages++;
+        parent.markDirty();
+        parent.latch().unlock();
+        return false;
+    }
 
-    if (root.header->size == 0 && root.children[0] != 1) {
-        bufferPool.markDirty({name, root_id});
-        pid.page = numPages++;
-        root.children[0] = pid.page;
-    } else {
-        while (true) {
-            Page &page = bufferPool.getPage(pid);
-            IndexPage node(page);
-            auto keyValue = std::get<int>(t.get_field(key_index));
-            auto pos = std::lower_bound(node.keys, node.keys + node.header->size, keyValue);
-            auto slot = pos - node.keys;
-            pid.page = node.children[slot];
-            if (!node.header->index_children) {
-                break;
+    if (root.size() + 1 >= root.capacity) {
+        if (!parent.latch().tryUpgrade(parent_version)) {
+            return false;
+        }
+        splitRoot(parent);
+        parent.latch().unlock();
+        return false;
+    }
+
+    size_t child = root.children[root.route(key)];
+    bool index_children = root.header->index_children;
+    if (!parent.latch().validate(parent_version)) {
+        return false;
+    }
+
+    while (index_children) {
+        PinnedPage node(bufferPool, {name, child});
+        uint64_t node_version = node.latch().readLock();
+        if (!parent.latch().validate(parent_version)) {
+            return false;
+        }
+        IndexPage inner = indexPage(*node);
+        if (inner.size() + 1 >= inner.capacity) {
+            // Split the node now, while its parent is known to have room for the split key.
+            if (!parent.latch().tryUpgrade(parent_version)) {
+                return false;
+            }
+            if (!node.latch().tryUpgrade(node_version)) {
+                parent.latch().unlock();
+                return false;
             }
-            path.push_back(pid.page);
+            PinnedPage sibling(bufferPool, {name, numPages++});
+            IndexPage new_inner = indexPage(*sibling);
+            key_type split_key = inner.split(new_inner);
+            indexPage(*parent).insert(split_key, sibling.getId().page, node.getId().page);
+            sibling.markDirty();
+            node.markDirty();
+            parent.markDirty();
+            node.latch().unlock();
+            parent.latch().unlock();
+            return false;
         }
+        child = inner.children[inner.route(key)];
+        index_children = inner.header->index_children;
+        if (!node.latch().validate(node_version)) {
+            return false;
+        }
+        parent = std::move(node);
+        parent_version = node_version;
     }
 
-    // At this point, pid refers to a leaf page.
-    Page &page = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    LeafPage leaf(page, td, key_index);
+    // At this point, child refers to a leaf page.
+    PinnedPage leaf_page(bufferPool, {name, child});
+    uint64_t leaf_version = leaf_page.latch().readLock();
+    if (!parent.latch().validate(parent_version)) {
+        return false;
+    }
+    LeafPage leaf = leafPage(*leaf_page);
+    // The parent is only locked if the insert may fill the leaf.
+    bool may_split = leaf.nearlyFull();
+    if (may_split && !parent.latch().tryUpgrade(parent_version)) {
+        return false;
+    }
+    if (!leaf_page.latch().tryUpgrade(leaf_version)) {
+        if (may_split) {
+            parent.latch().unlock();
+        }
+        return false;
+    }
+    leaf_page.markDirty();
+    if (leaf.insertTuple(t)) {
+        // Split the leaf.
+        PinnedPage sibling(bufferPool, {name, numPages++});
+        LeafPage new_leaf = leafPage(*sibling);
+        key_type new_key = leaf.split(new_leaf);
+        leaf.header->next_leaf = sibling.getId().page;
+        indexPage(*parent).insert(new_key, sibling.getId().page, child);
+        sibling.markDirty();
+        parent.markDirty();
+    }
+    leaf_page.latch().unlock();
+    if (may_split) {
+        parent.latch().unlock();
+    }
+    return true;
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::splitRoot(PinnedPage &parent) {
+    using IndexPage = BasicIndexPage<Key>;
+
+    // The root stays at root_id, its contents move to two new children.
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    IndexPage root = indexPage(*parent);
+    PinnedPage child1(bufferPool, {name, numPages++});
+    PinnedPage child2(bufferPool, {name, numPages++});
+    // A frame spans page_size bytes, several Page objects for the larger size classes.
+    std::copy_n((*parent).data(), page_size, (*child1).data());
+    IndexPage child1_page = indexPage(*child1);
+    IndexPage child2_page = indexPage(*child2);
+    key_type split_key = child1_page.split(child2_page);
+    if (options.blink) {
+        child1_page.rightLink() = child2.getId().page;
+    }
+    root.header->size = 0;
+    root.header->index_children = true;
+    root.children[0] = child1.getId().page;
+    root.insert(split_key, child2.getId().page, child1.getId().page);
+    child1.markDirty();
+    child2.markDirty();
+    parent.markDirty();
+}
+
+template<typename Key>
+size_t BasicBTreeFile<Key>::descendBLink(const key_type &key, std::vector<size_t> &path) {
+    using IndexPage = BasicIndexPage<Key>;
+
+    // Descend without latching, remembering the pages where the search went down a level.
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    size_t id = root_id;
+    bool index_page = true;
+    while (index_page) {
+        PinnedPage page(bufferPool, {name, id});
+        uint64_t version = page.latch().readLock();
+        IndexPage node = indexPage(*page);
+        if (id == root_id && node.size() == 0 && node.children[0] == root_id) {
+            // The tree is empty: create the first leaf.
+            if (page.latch().tryUpgrade(version)) {
+                node.children[0] = numPages++;
+                page.markDirty();
+                page.latch().unlock();
+            }
+            continue;
+        }
+        bool right = node.beyond(key);
+        size_t next = right ? node.rightLink() : node.children[node.route(key)];
+        bool index_children = node.header->index_children;
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (!right) {
+            path.push_back(id);
+            index_page = index_children;
+        }
+        id = next;
+    }
+    return id;
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::insertBLink(const Tuple &t, const key_type &key) {
+    using LeafPage = BasicLeafPage<Key>;
+    using IndexPage = BasicIndexPage<Key>;
+
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+
+    std::vector<size_t> path;
+    size_t id = descendBLink(key, path);
+
+    // Lock the leaf, moving right while the key belongs to a sibling created by a concurrent split.
+    PinnedPage leaf_page(bufferPool, {name, id});
+    leaf_page.latch().lock();
+    while (true) {
+        LeafPage leaf = leafPage(*leaf_page);
+        size_t next_leaf = leaf.header->next_leaf;
+        if (next_leaf == 0) {
+            break;
+        }
+        PinnedPage next_page(bufferPool, {name, next_leaf});
+        next_page.latch().lock();
+        LeafPage next = leafPage(*next_page);
+        bool stay = next.size() == 0 || next.compare(0, key) > 0;
+        if constexpr (std::is_same_v<Key, int>) {
+            // A compressed leaf only takes keys inside its fence, even if the sibling lost the keys it was split for.
+            if (options.compress) {
+                stay = key < leaf.bounds().high;
+            }
+        }
+        if (stay) {
+            next_page.latch().unlock();
+            break;
+        }
+        leaf_page.latch().unlock();
+        leaf_page = std::move(next_page);
+    }
+
+    LeafPage leaf = leafPage(*leaf_page);
+    leaf_page.markDirty();
     if (!leaf.insertTuple(t)) {
+        leaf_page.latch().unlock();
         return;
     }
 
-    // Split the leaf.
-    pid.page = numPages++;
-    Page &new_leaf_page = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    LeafPage new_leaf(new_leaf_page, td, key_index);
-    int new_key = leaf.split(new_leaf);
-    leaf.header->next_leaf = pid.page;
-    size_t new_child = pid.page;
+    // Split the leaf. The new leaf is reachable through next_leaf before the parent knows about it.
+    PinnedPage sibling(bufferPool, {name, numPages++});
+    LeafPage new_leaf = leafPage(*sibling);
+    key_type split_key = leaf.split(new_leaf);
+    leaf.header->next_leaf = sibling.getId().page;
+    sibling.markDirty();
+    size_t left = leaf_page.getId().page;
+    size_t right = sibling.getId().page;
+    leaf_page.latch().unlock();
 
-    // Propagate the split upward.
-    while (!path.empty()) {
-        size_t parent_id = path.back();
-        path.pop_back();
-        pid.page = parent_id;
-        Page &parent_page = bufferPool.getPage(pid);
-        bufferPool.markDirty(pid);
-        IndexPage parent(parent_page);
-        if (!parent.insert(new_key, new_child)) {
+    // Post the split to the parent, one level at a time.
+    for (size_t level = 0;; level++) {
+        PinnedPage parent = lockParent(path, left, split_key, level);
+        IndexPage node = indexPage(*parent);
+        parent.markDirty();
+        if (!node.insert(split_key, right, left)) {
+            parent.latch().unlock();
             return;
         }
+        if (parent.getId().page == root_id) {
+            splitRoot(parent);
+            parent.latch().unlock();
+            return;
+        }
+        PinnedPage new_page(bufferPool, {name, numPages++});
+        IndexPage new_node = indexPage(*new_page);
+        split_key = node.split(new_node);
+        node.rightLink() = new_page.getId().page;
+        new_page.markDirty();
+        left = parent.getId().page;
+        right = new_page.getId().page;
+        parent.latch().unlock();
+    }
+}
 
-        pid.page = numPages++;
-        Page &new_internal_page = bufferPool.getPage(pid);
-        bufferPool.markDirty(pid);
-        IndexPage new_internal(new_internal_page);
-        new_key = parent.split(new_internal);
-        new_child = pid.page;
+template<typename Key>
+PinnedPage BasicBTreeFile<Key>::lockParent(std::vector<size_t> &path, size_t child, const key_type &key,
+                                            size_t level) {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    size_t id = root_id;
+    if (!path.empty()) {
+        id = path.back();
+        path.pop_back();
+    }
+    size_t misses = 0;
+    size_t descents = 0;
+    while (true) {
+        PinnedPage page(bufferPool, {name, id});
+        page.latch().lock();
+        BasicIndexPage<Key> node = indexPage(*page);
+        if (node.hasChild(child)) {
+            return page;
+        }
+        size_t next;
+        if (node.beyond(key)) {
+            // The parent was split and the child moved to a right sibling.
+            next = node.rightLink();
+        } else if (id == root_id && node.header->index_children) {
+            // The root was split since the descent: the parent is now further down.
+            next = node.children[node.route(key)];
+        } else {
+            // The child is the new sibling of a page whose own split another thread has not posted yet: wait for it.
+            page.latch().unlock();
+            if (++misses < MAX_PARENT_MISSES) {
+                std::this_thread::yield();
+                continue;
+            }
+            // The path may be out of date: descend from the root again, to the level above the child (Lehman-Yao).
+            // Levels count from the leaves, so root splits meanwhile do not move them.
+            if (++descents > MAX_PARENT_DESCENTS) {
+                throw std::logic_error("Parent page not found");
+            }
+            misses = 0;
+            path.clear();
+            descendBLink(key, path);
+            if (path.size() <= level) {
+                throw std::logic_error("Parent page not found");
+            }
+            path.resize(path.size() - level);
+            id = path.back();
+            path.pop_back();
+            continue;
+        }
+        page.latch().unlock();
+        id = next;
     }
+}
 
-    // Propagate the final split to the root.
-    bufferPool.markDirty({name, root_id});
-    if (!root.insert(new_key, new_child)) {
-        return;
+template<typename Key>
+std::optional<Tuple> BasicBTreeFile<Key>::findBLink(const key_type &key) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    size_t id = root_id;
+    bool index_page = true;
+    while (index_page) {
+        PinnedPage page(bufferPool, {name, id});
+        uint64_t version = page.latch().readLock();
+        BasicIndexPage<Key> node = indexPage(*page);
+        bool right = node.beyond(key);
+        size_t next = right ? node.rightLink() : node.children[node.route(key)];
+        bool index_children = node.header->index_children;
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (next == root_id) {
+            // The tree is empty.
+            return std::nullopt;
+        }
+        if (!right) {
+            index_page = index_children;
+        }
+        id = next;
     }
-    pid.page = numPages++;
-    Page &new_child1 = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    size_t child1 = pid.page;
-    new_child1 = root_page;
-    IndexPage child1_page(new_child1);
-
-    pid.page = numPages++;
-    Page &new_child2 = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    size_t child2 = pid.page;
-    IndexPage child2_page(new_child2);
-
-    int key = child1_page.split(child2_page);
-    root.header->size = 1;
-    root.header->index_children = true;
-    root.keys[0] = key;
-    root.children[0] = child1;
-    root.children[1] = child2;
+
+    while (true) {
+        PinnedPage page(bufferPool, {name, id});
+        uint64_t version = page.latch().readLock();
+        BasicLeafPage<Key> leaf = leafPage(*page);
+        size_t pos = leaf.lowerBound(key);
+        std::optional<Tuple> result;
+        size_t next_leaf = 0;
+        if (pos < leaf.size()) {
+            if (leaf.compare(pos, key) == 0) {
+                // Not getTuple: it checks the slot against the size again, which a concurrent split may have changed.
+                Page buffer;
+                result = td.deserialize(leaf.row(pos, buffer));
+            }
+        } else {
+            next_leaf = leaf.header->next_leaf;
+        }
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (next_leaf == 0) {
+            return result;
+        }
+        // Every key in the leaf is smaller: the key may have moved to the right sibling.
+        PinnedPage next_page(bufferPool, {name, next_leaf});
+        uint64_t next_version = next_page.latch().readLock();
+        BasicLeafPage<Key> next = leafPage(*next_page);
+        bool move_right = next.size() > 0 && next.compare(0, key) <= 0;
+        if (!next_page.latch().validate(next_version)) {
+            continue;
+        }
+        if (!move_right) {
+            return std::nullopt;
+        }
+        id = next_leaf;
+    }
+}
+
+template<typename Key>
+bool BasicBTreeFile<Key>::findLeaf(const key_type *key, PinnedPage &leaf, uint64_t &version) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PinnedPage parent(bufferPool, {name, root_id});
+    uint64_t parent_version = parent.latch().readLock();
+    size_t child;
+    bool index_children = true;
+    while (index_children) {
+        BasicIndexPage<Key> node = indexPage(*parent);
+        if (!key) {
+            child = node.children[0];
+        } else {
+            child = node.children[options.duplicates ? node.lowerRoute(*key) : node.route(*key)];
+        }
+        index_children = node.header->index_children;
+        if (!parent.latch().validate(parent_version)) {
+            return false;
+        }
+        if (child == root_id) {
+            // The tree is empty.
+            leaf = std::move(parent);
+            version = parent_version;
+            return true;
+        }
+        PinnedPage node_page(bufferPool, {name, child});
+        uint64_t node_version = node_page.latch().readLock();
+        if (!parent.latch().validate(parent_version)) {
+            return false;
+        }
+        parent = std::move(node_page);
+        parent_version = node_version;
+    }
+    leaf = std::move(parent);
+    version = parent_version;
+    return true;
 }
 
-void BTreeFile::deleteTuple(const Iterator &it) {
-    // Function intentionally left unimplemented.
+template<typename Key>
+bool BasicBTreeFile<Key>::tryFind(const key_type &key, std::optional<Tuple> &result) const {
+    PinnedPage leaf_page;
+    uint64_t version;
+    if (!findLeaf(&key, leaf_page, version)) {
+        return false;
+    }
+    result.reset();
+    if (leaf_page.getId().page != root_id) {
+        BasicLeafPage<Key> leaf = leafPage(*leaf_page);
+        size_t pos = leaf.lowerBound(key);
+        if (pos < leaf.size() && leaf.compare(pos, key) == 0) {
+            Page buffer;
+            result = td.deserialize(leaf.row(pos, buffer));
+        }
+    }
+    return leaf_page.latch().validate(version);
 }
 
-Tuple BTreeFile::getTuple(const Iterator &it) const {
+template<typename Key>
+std::optional<Tuple> BasicBTreeFile<Key>::find(const key_type &key) const {
+    if (bloom) {
+        bloom_probes++;
+        if (!bloom->mayContain(KeyTraits<Key>::hash(key))) {
+            bloom_negatives++;
+            return std::nullopt;
+        }
+    }
+    std::optional<Tuple> result;
+    if (options.blink) {
+        result = findBLink(key);
+    } else if (options.duplicates) {
+        // The leaf that lowerRoute() leads to may end before the run of equal keys starts.
+        Iterator it = lowerBound(key);
+        if (it != end()) {
+            Tuple t = getTuple(it);
+            if (KeyTraits<Key>::extract(t, kd) == key) {
+                result = std::move(t);
+            }
+        }
+    } else {
+        while (!tryFind(key, result));
+    }
+    if (bloom && !result) {
+        bloom_false_positives++;
+    }
+    return result;
+}
+
+template<typename Key>
+std::vector<Tuple> BasicBTreeFile<Key>::findAll(const key_type &key) const {
+    std::vector<Tuple> tuples;
+    if (!options.duplicates) {
+        if (std::optional<Tuple> t = find(key)) {
+            tuples.push_back(std::move(*t));
+        }
+        return tuples;
+    }
+    for (auto it = lowerBound(key); it != end(); ++it) {
+        Tuple t = *it;
+        if (!(KeyTraits<Key>::extract(t, kd) == key)) {
+            break;
+        }
+        tuples.push_back(std::move(t));
+    }
+    return tuples;
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::deleteTuple(const Iterator &it) {
     BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, it.page};
-    Page &page = bufferPool.getPage(pid);
-    LeafPage leaf(page, td, key_index);
-    return leaf.getTuple(it.slot);
+    PinnedPage page(bufferPool, {name, it.page});
+    page.latch().lock();
+    BasicLeafPage<Key> leaf = leafPage(*page);
+    if (it.page == root_id || it.slot >= leaf.size()) {
+        page.latch().unlock();
+        throw std::runtime_error("Slot not occupied");
+    }
+    leaf.remove(it.slot);
+    page.markDirty();
+    page.latch().unlock();
 }
 
-void BTreeFile::next(Iterator &it) const {
+template<typename Key>
+bool BasicBTreeFile<Key>::erase(const key_type &key) {
     BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, it.page};
-    Page &page = bufferPool.getPage(pid);
-    LeafPage leaf(page, td, key_index);
-    if (it.slot + 1 < leaf.header->size) {
-        ++it.slot;
-    } else {
-        it.page = leaf.header->next_leaf;
-        it.slot = 0;
+    PinnedPage leaf_page;
+    uint64_t version;
+    while (!findLeaf(&key, leaf_page, version) || !leaf_page.latch().tryUpgrade(version));
+    if (leaf_page.getId().page == root_id) {
+        // The tree is empty.
+        leaf_page.latch().unlock();
+        return false;
+    }
+    while (true) {
+        BasicLeafPage<Key> leaf = leafPage(*leaf_page);
+        size_t pos = leaf.lowerBound(key);
+        if (pos < leaf.size()) {
+            bool found = leaf.compare(pos, key) == 0;
+            if (found) {
+                leaf.remove(pos);
+                leaf_page.markDirty();
+            }
+            leaf_page.latch().unlock();
+            return found;
+        }
+        // In a B-link tree the key may have moved to a sibling that the parent does not know about yet.
+        size_t next_leaf = leaf.header->next_leaf;
+        if (next_leaf == 0) {
+            leaf_page.latch().unlock();
+            return false;
+        }
+        PinnedPage next_page(bufferPool, {name, next_leaf});
+        next_page.latch().lock();
+        BasicLeafPage<Key> next = leafPage(*next_page);
+        bool move_right = next.size() > 0 && next.compare(0, key) <= 0;
+        leaf_page.latch().unlock();
+        if (!move_right) {
+            next_page.latch().unlock();
+            return false;
+        }
+        leaf_page = std::move(next_page);
     }
 }
 
-Iterator BTreeFile::begin() const {
+template<typename Key>
+void BasicBTreeFile<Key>::bulkLoad(const std::vector<Tuple> &tuples) {
+    using LeafPage = BasicLeafPage<Key>;
+    using IndexPage = BasicIndexPage<Key>;
+
     BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, root_id};
+    PinnedPage root(bufferPool, {name, root_id});
+    root.latch().lock();
+    IndexPage root_page = indexPage(*root);
+    if (root_page.children[0] != root_id) {
+        root.latch().unlock();
+        throw std::logic_error("Bulk load requires an empty tree");
+    }
+    for (size_t j = 0; j < tuples.size(); j++) {
+        if (!td.compatible(tuples[j])) {
+            root.latch().unlock();
+            throw std::logic_error("Tuple not compatible with TupleDesc");
+        }
+        if (j == 0) {
+            continue;
+        }
+        key_type previous = KeyTraits<Key>::extract(tuples[j - 1], kd);
+        key_type current = KeyTraits<Key>::extract(tuples[j], kd);
+        if (current < previous || (!options.duplicates && !(previous < current))) {
+            root.latch().unlock();
+            throw std::logic_error("Tuples are not sorted by key");
+        }
+    }
+    if (tuples.empty()) {
+        root.latch().unlock();
+        return;
+    }
+
+    // Write the leaves, each filled until the next insert could fill it. Every level is a list of (smallest key, page
+    // number) pairs.
+    std::vector<std::pair<key_type, size_t>> level;
+    PinnedPage previous;
+    for (size_t j = 0; j < tuples.size();) {
+        PinnedPage page(bufferPool, {name, numPages++});
+        LeafPage leaf = leafPage(*page);
+        leaf.clear();
+        leaf.header->next_leaf = 0;
+        size_t end = tuples.size();
+        if constexpr (std::is_same_v<Key, int>) {
+            if (options.compress) {
+                // The fence of a leaf reaches up to the first key of the next leaf, and the fewer tuples the leaf
+                // takes the narrower its keys get: grow it while the fence leaves room for one more insert.
+                auto fence = [&](size_t k) {
+                    return k < tuples.size() ? static_cast<int64_t>(KeyTraits<Key>::extract(tuples[k], kd))
+                                             : static_cast<int64_t>(INT_MAX) + 1;
+                };
+                int64_t low = level.empty() ? INT_MIN : fence(j);
+                size_t count = 1;
+                while (j + count < tuples.size() && count + 2 <= leaf.capacityFor(low, fence(j + count + 1))) {
+                    count++;
+                }
+                end = j + count;
+                leaf.setFence(low, fence(end));
+            }
+        }
+        level.emplace_back(KeyTraits<Key>::extract(tuples[j], kd), page.getId().page);
+        // The tuples are sorted, so every insert appends to the leaf.
+        do {
+            leaf.insertTuple(tuples[j++]);
+        } while (j < end && !leaf.nearlyFull());
+        page.markDirty();
+        if (level.size() > 1) {
+            leafPage(*previous).header->next_leaf = page.getId().page;
+        }
+        previous = std::move(page);
+    }
+    previous.release();
+
+    // Build the index levels until the remaining pages fit in the root. Like a root split, a bulk load keeps the
+    // root one key below its capacity, so that it has room for the next split.
+    size_t fanout = root_page.capacity - 1;
+    bool index_children = false;
+    while (level.size() > fanout) {
+        std::vector<std::pair<key_type, size_t>> parents;
+        size_t num_nodes = (level.size() + fanout - 1) / fanout;
+        size_t first_node = numPages.fetch_add(num_nodes);
+        for (size_t i = 0; i < num_nodes; i++) {
+            PinnedPage page(bufferPool, {name, first_node + i});
+            IndexPage node = indexPage(*page);
+            size_t begin = i * fanout;
+            size_t end = std::min(begin + fanout, level.size());
+            node.header->size = 0;
+            node.header->index_children = index_children;
+            node.children[0] = level[begin].second;
+            for (size_t j = begin + 1; j < end; j++) {
+                node.insert(level[j].first, level[j].second);
+            }
+            if (options.blink && end < level.size()) {
+                node.link(first_node + i + 1, level[end].first);
+            }
+            page.markDirty();
+            parents.emplace_back(level[begin].first, first_node + i);
+        }
+        level = std::move(parents);
+        index_children = true;
+    }
+
+    root_page.header->size = 0;
+    root_page.header->index_children = index_children;
+    root_page.children[0] = level[0].second;
+    for (size_t j = 1; j < level.size(); j++) {
+        root_page.insert(level[j].first, level[j].second);
+    }
+    root.markDirty();
+    root.latch().unlock();
+
+    if (bloom) {
+        size_t expected_keys = std::max(tuples.size(), bloom->bits() / bloom_bits_per_key);
+        bloom = std::make_unique<BloomFilter>(expected_keys, bloom_bits_per_key);
+        for (const Tuple &t: tuples) {
+            bloom->insert(KeyTraits<Key>::hash(KeyTraits<Key>::extract(t, kd)));
+        }
+    }
+}
+
+template<typename Key>
+Iterator BasicBTreeFile<Key>::lowerBound(const key_type &key) const {
+    PinnedPage leaf_page;
+    uint64_t version;
+    size_t page, slot;
     while (true) {
-        Page &page = bufferPool.getPage(pid);
-        IndexPage node(page);
-        pid.page = node.children[0];
-        if (!node.header->index_children) {
+        if (!findLeaf(&key, leaf_page, version)) {
+            continue;
+        }
+        page = leaf_page.getId().page;
+        slot = 0;
+        if (page != root_id) {
+            slot = leafPage(*leaf_page).lowerBound(key);
+        }
+        if (leaf_page.latch().validate(version)) {
             break;
         }
     }
-    return {*this, pid.page, 0};
+    leaf_page.release();
+    Iterator it{*this, page, slot};
+    skipExhausted(it);
+    return it;
+}
+
+template<typename Key>
+Tuple BasicBTreeFile<Key>::getTuple(const Iterator &it) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PinnedPage page(bufferPool, {name, it.page});
+    while (true) {
+        uint64_t version = page.latch().readLock();
+        BasicLeafPage<Key> leaf = leafPage(*page);
+        std::optional<Tuple> t;
+        if (it.slot < leaf.size()) {
+            Page buffer;
+            t = td.deserialize(leaf.row(it.slot, buffer));
+        }
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (!t) {
+            throw std::runtime_error("Slot not occupied");
+        }
+        return std::move(*t);
+    }
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::getTuple(const Iterator &it, Tuple &t) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PinnedPage page(bufferPool, {name, it.page});
+    while (true) {
+        uint64_t version = page.latch().readLock();
+        BasicLeafPage<Key> leaf = leafPage(*page);
+        bool occupied = it.slot < leaf.size();
+        if (occupied) {
+            Page buffer;
+            td.deserialize(leaf.row(it.slot, buffer), t);
+        }
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (!occupied) {
+            throw std::runtime_error("Slot not occupied");
+        }
+        return;
+    }
+}
+
+template<typename Key>
+TupleView BasicBTreeFile<Key>::getView(const Iterator &it) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PinnedPage page(bufferPool, {name, it.page});
+    while (true) {
+        uint64_t version = page.latch().readLock();
+        BasicLeafPage<Key> leaf = leafPage(*page);
+        bool occupied = it.slot < leaf.size();
+        // A compressed leaf has no tuple to point to: the view gets its own copy of the decoded tuple instead.
+        Page buffer;
+        const uint8_t *row = occupied && options.compress ? leaf.row(it.slot, buffer) : nullptr;
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (!occupied) {
+            throw std::runtime_error("Slot not occupied");
+        }
+        return row ? TupleView(td, std::vector<uint8_t>(row, row + td.length())) : leaf.getView(it.slot);
+    }
 }
 
-Iterator BTreeFile::end() const {
+template<typename Key>
+void BasicBTreeFile<Key>::skipExhausted(Iterator &it) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    while (it.page != root_id) {
+        PinnedPage page(bufferPool, {name, it.page});
+        uint64_t version = page.latch().readLock();
+        BasicLeafPage<Key> leaf = leafPage(*page);
+        size_t size = leaf.size();
+        size_t next_leaf = leaf.header->next_leaf;
+        if (!page.latch().validate(version)) {
+            continue;
+        }
+        if (it.slot < size) {
+            return;
+        }
+        it.page = next_leaf;
+        it.slot = 0;
+    }
+    it.slot = 0;
+}
+
+template<typename Key>
+void BasicBTreeFile<Key>::next(Iterator &it) const {
+    ++it.slot;
+    skipExhausted(it);
+}
+
+template<typename Key>
+bool BasicBTreeFile<Key>::nextBatch(Iterator &it, Batch &batch) const {
+    batch.clear();
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    while (it.page != root_id && !batch.full()) {
+        PinnedPage page(bufferPool, {name, it.page});
+        uint64_t version = page.latch().readLock();
+        BasicLeafPage<Key> leaf = leafPage(*page);
+        size_t size = leaf.size();
+        size_t next_leaf = leaf.header->next_leaf;
+        size_t appended = batch.size();
+        size_t slot = it.slot;
+        Page buffer;
+        for (; slot < size && !batch.full(); slot++) {
+            batch.append(leaf.row(slot, buffer));
+        }
+        // The rows were copied optimistically: drop them and copy the leaf again if it changed meanwhile.
+        if (!page.latch().validate(version)) {
+            batch.truncate(appended);
+            continue;
+        }
+        it.slot = slot;
+        if (slot == size) {
+            it.page = next_leaf;
+            it.slot = 0;
+        }
+    }
+    skipExhausted(it);
+    return !batch.empty();
+}
+
+template<typename Key>
+Iterator BasicBTreeFile<Key>::begin() const {
+    PinnedPage leaf;
+    uint64_t version;
+    while (!findLeaf(nullptr, leaf, version));
+    Iterator it{*this, leaf.getId().page, 0};
+    leaf.release();
+    skipExhausted(it);
+    return it;
+}
+
+template<typename Key>
+Iterator BasicBTreeFile<Key>::end() const {
     return {*this, 0, 0};
 }
+
+template<typename Key>
+class BasicBTreeFile<Key>::LeafCursor : public Cursor {
+    const BasicBTreeFile &file;
+    size_t page;
+    size_t slot = 0;
+    PinnedPage pinned;
+
+    // Like skipExhausted, but following next_leaf only repins when the leaf is exhausted.
+    void seek() {
+        while (page != root_id) {
+            uint64_t version = pinned.latch().readLock();
+            BasicLeafPage<Key> leaf = file.leafPage(*pinned);
+            size_t size = leaf.size();
+            size_t next_leaf = leaf.header->next_leaf;
+            if (!pinned.latch().validate(version)) {
+                continue;
+            }
+            if (slot < size) {
+                return;
+            }
+            page = next_leaf;
+            slot = 0;
+            if (page == root_id) {
+                pinned.release();
+            } else {
+                pinned = PinnedPage(getDatabase().getBufferPool(), {file.name, page});
+            }
+        }
+        slot = 0;
+    }
+
+public:
+    explicit LeafCursor(const BasicBTreeFile &file) : file(file) {
+        uint64_t version;
+        while (!file.findLeaf(nullptr, pinned, version));
+        page = pinned.getId().page;
+        if (page == root_id) {
+            pinned.release();
+        }
+        seek();
+    }
+
+    bool valid() const override { return page != root_id; }
+
+    TupleView view() const override {
+        while (true) {
+            uint64_t version = pinned.latch().readLock();
+            BasicLeafPage<Key> leaf = file.leafPage(*pinned);
+            bool occupied = slot < leaf.size();
+            // Like getView: the view owns the decoded tuple, so it outlives the next call.
+            Page buffer;
+            const uint8_t *row = occupied && file.options.compress ? leaf.row(slot, buffer) : nullptr;
+            if (!pinned.latch().validate(version)) {
+                continue;
+            }
+            if (!occupied) {
+                throw std::runtime_error("Slot not occupied");
+            }
+            return row ? TupleView(file.td, std::vector<uint8_t>(row, row + file.td.length())) : leaf.getView(slot);
+        }
+    }
+
+    Tuple get() const override {
+        while (true) {
+            uint64_t version = pinned.latch().readLock();
+            BasicLeafPage<Key> leaf = file.leafPage(*pinned);
+            std::optional<Tuple> t;
+            if (slot < leaf.size()) {
+                Page row;
+                t = file.td.deserialize(leaf.row(slot, row));
+            }
+            if (!pinned.latch().validate(version)) {
+                continue;
+            }
+            if (!t) {
+                throw std::runtime_error("Slot not occupied");
+            }
+            return std::move(*t);
+        }
+    }
+
+    void get(Tuple &t) const override {
+        while (true) {
+            uint64_t version = pinned.latch().readLock();
+            BasicLeafPage<Key> leaf = file.leafPage(*pinned);
+            bool occupied = slot < leaf.size();
+            if (occupied) {
+                Page row;
+                file.td.deserialize(leaf.row(slot, row), t);
+            }
+            if (!pinned.latch().validate(version)) {
+                continue;
+            }
+            if (!occupied) {
+                throw std::runtime_error("Slot not occupied");
+            }
+            return;
+        }
+    }
+
+    void next() override {
+        if (page != root_id) {
+            slot++;
+            seek();
+        }
+    }
+
+    Iterator position() const override { return {file, page, slot}; }
+};
+
+template<typename Key>
+std::unique_ptr<Cursor> BasicBTreeFile<Key>::cursor() const {
+    return std::make_unique<LeafCursor>(*this);
+}
+
+template class db::BasicBTreeFile<int>;
+template class db::BasicBTreeFile<double>;
+template class db::BasicBTreeFile<NormalizedKey>;
+
+std::unique_ptr<DbFile> db::openBTreeFile(const std::string &name, const TupleDesc &td, size_t page_size,
+                                          const FileLayout &layout) {
+    // The inverse of format().
+    BTreeOptions options{.blink = (layout.format >> 8 & 1) != 0,
+                         .duplicates = (layout.format >> 9 & 1) != 0,
+                         .compress = (layout.format >> 10 & 1) != 0,
+                         .page_size = page_size};
+    if (layout.format >> 11 & 1) {
+        return std::make_unique<BasicBTreeFile<NormalizedKey>>(name, td, layout.key_indices, options);
+    }
+    if (td.type_of(layout.key_indices.at(0)) == type_t::DOUBLE) {
+        return std::make_unique<BasicBTreeFile<double>>(name, td, layout.key_indices, options);
+    }
+    return std::make_unique<BasicBTreeFile<int>>(name, td, layout.key_indices, options);
+}
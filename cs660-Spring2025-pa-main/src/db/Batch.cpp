@@ -0,0 +1,106 @@
+#include <db/Batch.hpp>
+#include <db/Dictionary.hpp>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+    std::vector<size_t> allFields(size_t n) {
+        std::vector<size_t> indices(n);
+        std::iota(indices.begin(), indices.end(), 0);
+        return indices;
+    }
+} // namespace
+
+Batch::Batch(const TupleDesc &td, const std::vector<size_t> &fields) : td(&td), fields(fields) {
+    for (size_t field: fields) {
+        Column column{field, td.offset_of(field), td.type_of(field), {}, {}, {}, {}, {}};
+        switch (column.type) {
+            case type_t::INT:
+                column.ints.resize(BATCH_SIZE);
+                break;
+            case type_t::DOUBLE:
+                column.doubles.resize(BATCH_SIZE);
+                break;
+            case type_t::CHAR:
+            case type_t::VARCHAR:
+                column.strings.resize(BATCH_SIZE);
+                column.chars.resize(BATCH_SIZE * (column.type == type_t::CHAR ? CHAR_SIZE : VARCHAR_SIZE));
+                break;
+            case type_t::DICT:
+                column.strings.resize(BATCH_SIZE);
+                column.codes.resize(BATCH_SIZE);
+                break;
+        }
+        columns.push_back(std::move(column));
+    }
+}
+
+Batch::Batch(const TupleDesc &td) : Batch(td, allFields(td.size())) {}
+
+const TupleDesc &Batch::getTupleDesc() const { return *td; }
+
+const std::vector<size_t> &Batch::getFields() const { return fields; }
+
+size_t Batch::size() const { return count; }
+
+bool Batch::empty() const { return count == 0; }
+
+bool Batch::full() const { return count == BATCH_SIZE; }
+
+void Batch::clear() { count = 0; }
+
+void Batch::truncate(size_t size) { count = std::min(count, size); }
+
+void Batch::append(const uint8_t *tuple) {
+    if (full()) {
+        throw std::logic_error("Batch is full");
+    }
+    for (Column &column: columns) {
+        const uint8_t *value = tuple + column.offset;
+        switch (column.type) {
+            case type_t::INT:
+                std::memcpy(&column.ints[count], value, sizeof(int));
+                break;
+            case type_t::DOUBLE:
+                std::memcpy(&column.doubles[count], value, sizeof(double));
+                break;
+            case type_t::CHAR:
+            case type_t::VARCHAR: {
+                std::string_view s = TupleView(*td, tuple).getString(column.field);
+                char *chars = column.chars.data() + count * (column.chars.size() / BATCH_SIZE);
+                std::memcpy(chars, s.data(), s.size());
+                column.strings[count] = {chars, s.size()};
+                break;
+            }
+            case type_t::DICT: {
+                const Dictionary &dictionary = *td->dictionary_of(column.field);
+                uint32_t code = dictionary.load(value);
+                column.codes[count] = code;
+                column.strings[count] = dictionary.decode(code);
+                break;
+            }
+        }
+    }
+    count++;
+}
+
+const Batch::Column &Batch::column(size_t i, type_t type) const {
+    const Column &column = columns.at(i);
+    bool string = column.type == type_t::VARCHAR || column.type == type_t::DICT;
+    bool matches = column.type == type || (type == type_t::CHAR && string);
+    if (!matches) {
+        throw std::logic_error("Column type mismatch");
+    }
+    return column;
+}
+
+const int *Batch::ints(size_t i) const { return column(i, type_t::INT).ints.data(); }
+
+const double *Batch::doubles(size_t i) const { return column(i, type_t::DOUBLE).doubles.data(); }
+
+const std::string_view *Batch::strings(size_t i) const { return column(i, type_t::CHAR).strings.data(); }
+
+const uint32_t *Batch::codes(size_t i) const { return column(i, type_t::DICT).codes.data(); }
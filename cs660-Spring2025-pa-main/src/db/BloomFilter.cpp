@@ -0,0 +1,42 @@
+#include <db/BloomFilter.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using namespace db;
+
+BloomFilter::BloomFilter(size_t expected_keys, size_t bits_per_key)
+    : words((std::max<size_t>(expected_keys * bits_per_key, 64) + 63) / 64), num_bits(words.size() * 64),
+      num_hashes(std::clamp<size_t>(std::lround(bits_per_key * std::log(2.0)), 1, 30)) {}
+
+void BloomFilter::insert(uint64_t hash) {
+    // Double hashing: the i-th bit is h1 + i * h2, with h2 odd so that it cycles through all the bits.
+    uint64_t h2 = std::rotl(hash, 32) | 1;
+    for (size_t i = 0; i < num_hashes; i++, hash += h2) {
+        size_t bit = hash % num_bits;
+        words[bit / 64].fetch_or(uint64_t{1} << (bit % 64), std::memory_order_relaxed);
+    }
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const {
+    uint64_t h2 = std::rotl(hash, 32) | 1;
+    for (size_t i = 0; i < num_hashes; i++, hash += h2) {
+        size_t bit = hash % num_bits;
+        if (!(words[bit / 64].load(std::memory_order_relaxed) & (uint64_t{1} << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t BloomFilter::bits() const { return num_bits; }
+
+size_t BloomFilter::hashes() const { return num_hashes; }
+
+double BloomFilter::estimatedFalsePositiveRate() const {
+    size_t set = 0;
+    for (const auto &word: words) {
+        set += std::popcount(word.load(std::memory_order_relaxed));
+    }
+    return std::pow(static_cast<double>(set) / num_bits, num_hashes);
+}
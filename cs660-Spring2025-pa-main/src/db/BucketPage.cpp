@@ -0,0 +1,55 @@
+#include <db/BucketPage.hpp>
+#include <cstring>
+#include <stdexcept>
+
+using namespace db;
+
+BucketPage::BucketPage(Page &page, const TupleDesc &td, const KeyDesc &kd) : td(td), kd(kd) {
+    header = reinterpret_cast<BucketPageHeader *>(page.data());
+    data = page.data() + sizeof(BucketPageHeader);
+    capacity = (DEFAULT_PAGE_SIZE - sizeof(BucketPageHeader)) / td.length();
+}
+
+size_t BucketPage::find(const NormalizedKey &key) const {
+    size_t slot = 0;
+    while (slot < header->size && kd.compare(data + slot * td.length(), key) != 0) {
+        slot++;
+    }
+    return slot;
+}
+
+bool BucketPage::insertTuple(const Tuple &t) {
+    size_t slot = find(kd.normalize(t));
+    if (slot == header->size) {
+        if (header->size == capacity) {
+            return false;
+        }
+        header->size++;
+    }
+    td.serialize(data + slot * td.length(), t);
+    return true;
+}
+
+void BucketPage::remove(size_t slot) {
+    if (slot >= header->size) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    header->size--;
+    if (slot != header->size) {
+        std::memcpy(data + slot * td.length(), data + header->size * td.length(), td.length());
+    }
+}
+
+Tuple BucketPage::getTuple(size_t slot) const {
+    if (slot >= header->size) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    return td.deserialize(data + slot * td.length());
+}
+
+TupleView BucketPage::getView(size_t slot) const {
+    if (slot >= header->size) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    return {td, data + slot * td.length()};
+}
@@ -1,106 +1,529 @@
 #include <db/BufferPool.hpp>
 #include <db/Database.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
 #include <numeric>
+#include <stdexcept>
 
 using namespace db;
 
-BufferPool::BufferPool() : available(DEFAULT_NUM_PAGES) {
+namespace {
+    constexpr uint64_t WARMUP_MAGIC = 0x314d524157424443; // "CDBWARM1"
+} // namespace
+
+BufferPool::BufferPool() {
     // TODO pa0
-    std::iota(available.rbegin(), available.rend(), 0);
+    for (size_t c = 0; c < NUM_PAGE_SIZES; c++) {
+        // A frame of size class c spans 2^c pages. The frames are not initialized, so untouched frames cost no memory.
+        pages[c] = std::make_unique_for_overwrite<Page[]>(DEFAULT_NUM_PAGES << c);
+        available[c].resize(DEFAULT_NUM_PAGES);
+        std::iota(available[c].rbegin(), available[c].rend(), c * DEFAULT_NUM_PAGES);
+    }
 }
 
 BufferPool::~BufferPool() {
     // TODO pa0
+    if (log) {
+        for (size_t pos: dirty) {
+            logPage(pos);
+        }
+        try {
+            log->flush(log->end());
+        } catch (const std::runtime_error &) {
+            // Without their log records the pages may not be written: they are lost, like those of a crash.
+            return;
+        }
+    }
     for (const size_t &pos: dirty) {
-        const Page &page = pages[pos];
+        const Page &page = frame(pos);
         const PageId &pid = pos_to_pid[pos];
         getDatabase().get(pid.file).writePage(page, pid.page);
     }
 }
 
-Page &BufferPool::getPage(const PageId &pid) {
-    // TODO pa0
-    // If already in buffer pool, make it the most recent page and return it
-    if (contains(pid)) {
-        size_t pos = pid_to_pos.at(pid);
-        lru_list.splice(lru_list.begin(), lru_list, pos_to_lru[pos]);
-        pos_to_lru[pos] = lru_list.begin();
-        return pages[pos];
+Page &BufferPool::frame(size_t pos) const {
+    size_t c = pos / DEFAULT_NUM_PAGES;
+    return pages[c][(pos % DEFAULT_NUM_PAGES) << c];
+}
+
+Page &BufferPool::loggedFrame(size_t pos) const {
+    size_t c = pos / DEFAULT_NUM_PAGES;
+    return logged[c][(pos % DEFAULT_NUM_PAGES) << c];
+}
+
+size_t BufferPool::frameSize(size_t pos) { return DEFAULT_PAGE_SIZE << (pos / DEFAULT_NUM_PAGES); }
+
+size_t BufferPool::position(const Page &page) const {
+    for (size_t c = 0;; c++) {
+        size_t offset = &page - pages[c].get();
+        if (offset < DEFAULT_NUM_PAGES << c) {
+            return c * DEFAULT_NUM_PAGES + (offset >> c);
+        }
     }
+}
 
-    // If there are no available pages, evict the least recently used page. If the page is dirty, flush it to disk
+size_t BufferPool::load(const PageId &pid) {
+    // If there are no available pages, evict the least recently used page that is not pinned. Pages that were
+    // referenced through pinPage since they were last considered get a second chance. If the page is dirty, flush it
+    // to disk.
+    const DbFile &file = getDatabase().get(pid.file);
+    size_t c = std::countr_zero(file.getPageSize() / DEFAULT_PAGE_SIZE);
+    std::vector<size_t> &available = this->available[c];
+    std::list<size_t> &lru_list = this->lru_list[c];
     if (available.empty()) {
-        size_t pos = lru_list.back();
-        const PageId &old_pid = pos_to_pid.at(pos);
-        if (isDirty(old_pid)) {
-            flushPage(old_pid);
+        auto it = lru_list.end();
+        for (size_t visited = 0; visited <= 2 * DEFAULT_NUM_PAGES; visited++) {
+            if (it == lru_list.begin()) {
+                it = lru_list.end();
+            }
+            auto candidate = std::prev(it);
+            size_t pos = *candidate;
+            if (pins[pos] > 0) {
+                it = candidate;
+                continue;
+            }
+            if (referenced[pos].exchange(false)) {
+                lru_list.splice(lru_list.begin(), lru_list, candidate);
+                continue;
+            }
+            if (!flush(pos)) {
+                it = candidate;
+                continue;
+            }
+            discard(pos);
+            break;
+        }
+        if (available.empty()) {
+            throw std::runtime_error("All pages are pinned");
         }
-        discardPage(old_pid);
     }
 
     // Read the page from disk to one of the available slots, make it the most recent page
     size_t pos = available.back();
     available.pop_back();
 
-    Page &page = pages[pos];
-    getDatabase().get(pid.file).readPage(page, pid.page);
+    Page &page = frame(pos);
+    file.readPage(page, pid.page);
+    if (log) {
+        std::copy_n(page.data(), file.getPageSize(), loggedFrame(pos).data());
+    }
     pid_to_pos[pid] = pos;
     pos_to_pid[pos] = pid;
 
     lru_list.push_front(pos);
     pos_to_lru[pos] = lru_list.begin();
 
-    return page;
+    return pos;
+}
+
+bool BufferPool::flush(size_t pos) {
+    if (!dirty.contains(pos))
+        return true;
+    // A writer marks the page dirty before it is done changing it: leave the page dirty until the writer is done.
+    OptLatch &latch = latches[pos];
+    if (!latch.tryLock())
+        return false;
+    dirty.erase(pos);
+    const Page &page = frame(pos);
+    const PageId &pid = pos_to_pid[pos];
+    try {
+        if (log) {
+            // Write-ahead: the changes to the page are on disk in the log before the page is.
+            logPage(pos);
+            log->flush(page_lsn[pos]);
+            unsynced.insert(pid.file);
+        }
+        getDatabase().get(pid.file).writePage(page, pid.page);
+    } catch (...) {
+        latch.unlock();
+        throw;
+    }
+    latch.unlock();
+    return true;
+}
+
+void BufferPool::logPage(size_t pos) {
+    size_t size = frameSize(pos);
+    const uint8_t *page = frame(pos).data();
+    uint8_t *before = loggedFrame(pos).data();
+    if (std::memcmp(page, before, size) == 0) {
+        return;
+    }
+    // Ranges less than a range header apart are merged, since a range costs its header.
+    constexpr size_t GAP = 2 * sizeof(uint32_t);
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t i = 0; i < size;) {
+        if (page[i] == before[i]) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        size_t last = i;
+        for (i++; i < size && i - last <= GAP; i++) {
+            if (page[i] != before[i]) {
+                last = i;
+            }
+        }
+        ranges.emplace_back(start, last + 1 - start);
+    }
+    // Log the bytes copied, not the page: a thread holding the page latch may still be changing the page, and the
+    // copy must match the log for its next change to be found.
+    for (const auto &[offset, length]: ranges) {
+        std::memcpy(before + offset, page + offset, length);
+    }
+    page_lsn[pos] = log->append(pos_to_pid[pos], before, ranges);
+}
+
+void BufferPool::discard(size_t pos) {
+    pid_to_pos.erase(pos_to_pid[pos]);
+    pos_to_pid[pos] = {};
+
+    size_t c = pos / DEFAULT_NUM_PAGES;
+    lru_list[c].erase(pos_to_lru[pos]);
+    pos_to_lru.erase(pos);
+    dirty.erase(pos);
+    referenced[pos] = false;
+    page_lsn[pos] = 0;
+    available[c].push_back(pos);
+}
+
+Page &BufferPool::getPage(const PageId &pid) {
+    // TODO pa0
+    std::unique_lock lock(mutex);
+    // If already in buffer pool, make it the most recent page and return it
+    if (auto it = pid_to_pos.find(pid); it != pid_to_pos.end()) {
+        size_t pos = it->second;
+        std::list<size_t> &lru = lru_list[pos / DEFAULT_NUM_PAGES];
+        lru.splice(lru.begin(), lru, pos_to_lru[pos]);
+        return frame(pos);
+    }
+    return frame(load(pid));
+}
+
+Page &BufferPool::pinPage(const PageId &pid) {
+    {
+        std::shared_lock lock(mutex);
+        if (auto it = pid_to_pos.find(pid); it != pid_to_pos.end()) {
+            size_t pos = it->second;
+            pins[pos]++;
+            if (!referenced[pos].load(std::memory_order_relaxed)) {
+                referenced[pos] = true;
+            }
+            return frame(pos);
+        }
+    }
+    std::unique_lock lock(mutex);
+    size_t pos;
+    if (auto it = pid_to_pos.find(pid); it != pid_to_pos.end()) {
+        pos = it->second;
+        std::list<size_t> &lru = lru_list[pos / DEFAULT_NUM_PAGES];
+        lru.splice(lru.begin(), lru, pos_to_lru[pos]);
+    } else {
+        pos = load(pid);
+    }
+    pins[pos]++;
+    return frame(pos);
+}
+
+void BufferPool::unpinPage(const Page &page) {
+    pins[position(page)]--;
+}
+
+OptLatch &BufferPool::getLatch(const Page &page) {
+    return latches[position(page)];
 }
 
 void BufferPool::markDirty(const PageId &pid) {
     // TODO pa0
+    std::unique_lock lock(mutex);
     size_t pos = pid_to_pos.at(pid);
     dirty.insert(pos);
 }
 
 bool BufferPool::isDirty(const PageId &pid) const {
     // TODO pa0
+    std::shared_lock lock(mutex);
     size_t pos = pid_to_pos.at(pid);
     return dirty.contains(pos);
 }
 
 bool BufferPool::contains(const PageId &pid) const {
     // TODO pa0
+    std::shared_lock lock(mutex);
     return pid_to_pos.contains(pid);
 }
 
 void BufferPool::discardPage(const PageId &pid) {
     // TODO pa0
-    size_t pos = pid_to_pos.at(pid);
-    pid_to_pos.erase(pid);
-    pos_to_pid[pos] = {};
-
-    lru_list.erase(pos_to_lru[pos]);
-    pos_to_lru.erase(pos);
-    dirty.erase(pos);
-    available.push_back(pos);
+    std::unique_lock lock(mutex);
+    discard(pid_to_pos.at(pid));
 }
 
 void BufferPool::flushPage(const PageId &pid) {
     // TODO pa0
-    size_t pos = pid_to_pos.at(pid);
-    if (dirty.erase(pos) == 0)
-        return;
-    const Page &page = pages[pos];
-    getDatabase().get(pid.file).writePage(page, pid.page);
+    std::unique_lock lock(mutex);
+    flush(pid_to_pos.at(pid));
 }
 
 void BufferPool::flushFile(const std::string &file) {
     // TODO pa0
+    std::unique_lock lock(mutex);
     std::vector<size_t> to_flush;
     for (const size_t &pos: dirty) {
         const PageId &pid = pos_to_pid[pos];
         if (pid.file == file) {
-            to_flush.emplace_back(pid.page);
+            to_flush.emplace_back(pos);
         }
     }
-    for (const auto &page: to_flush) {
-        flushPage({file, page});
+    for (const auto &pos: to_flush) {
+        flush(pos);
+    }
+}
+
+void BufferPool::discardFile(const std::string &file) {
+    std::unique_lock lock(mutex);
+    // A page read by a prefetch would otherwise be published after the pages of the file are gone.
+    prefetched.wait(lock, [&] { return !prefetching.contains(file); });
+    std::vector<size_t> to_discard;
+    for (const auto &[pid, pos]: pid_to_pos) {
+        if (pid.file == file) {
+            to_discard.emplace_back(pos);
+        }
+    }
+    for (const auto &pos: to_discard) {
+        discard(pos);
+    }
+}
+
+void BufferPool::savePages(const std::string &path) const {
+    // The page ids are written as the length of the file name in two bytes, the name and the page number.
+    std::vector<char> bytes(sizeof(WARMUP_MAGIC));
+    std::memcpy(bytes.data(), &WARMUP_MAGIC, sizeof(WARMUP_MAGIC));
+    {
+        std::shared_lock lock(mutex);
+        for (const std::list<size_t> &lru: lru_list) {
+            for (size_t pos: lru) {
+                const PageId &pid = pos_to_pid[pos];
+                auto length = static_cast<uint16_t>(pid.file.size());
+                uint64_t page = pid.page;
+                bytes.insert(bytes.end(), reinterpret_cast<const char *>(&length),
+                             reinterpret_cast<const char *>(&length + 1));
+                bytes.insert(bytes.end(), pid.file.begin(), pid.file.end());
+                bytes.insert(bytes.end(), reinterpret_cast<const char *>(&page),
+                             reinterpret_cast<const char *>(&page + 1));
+            }
+        }
+    }
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file.flush()) {
+            throw std::runtime_error("Cannot write the page ids");
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+std::future<size_t> BufferPool::warmUp(const std::string &path) {
+    // Look the files up and check the page ids here, so that the task only works with file names and pages that
+    // existed when it started.
+    std::ifstream in(path, std::ios::binary);
+    uint64_t magic = 0;
+    if (!in.read(reinterpret_cast<char *>(&magic), sizeof(magic)) || magic != WARMUP_MAGIC) {
+        return std::async(std::launch::deferred, [] { return size_t{0}; });
+    }
+
+    // Keep the hottest pages that fit in the frames that are available now.
+    std::array<size_t, NUM_PAGE_SIZES> room;
+    {
+        std::shared_lock lock(mutex);
+        for (size_t c = 0; c < NUM_PAGE_SIZES; c++) {
+            room[c] = available[c].size();
+        }
+    }
+    std::unordered_map<std::string, std::pair<size_t, std::vector<size_t>>> wanted;
+    uint16_t length;
+    while (in.read(reinterpret_cast<char *>(&length), sizeof(length))) {
+        std::string name(length, '\0');
+        uint64_t page;
+        if (!in.read(name.data(), length) || !in.read(reinterpret_cast<char *>(&page), sizeof(page))) {
+            break;
+        }
+        const DbFile *file;
+        try {
+            file = &getDatabase().get(name);
+        } catch (const std::out_of_range &) {
+            continue;
+        }
+        size_t c = std::countr_zero(file->getPageSize() / DEFAULT_PAGE_SIZE);
+        if (page < file->getNumPages() && room[c] > 0) {
+            room[c]--;
+            auto &[size_class, ids] = wanted[name];
+            size_class = c;
+            ids.push_back(page);
+        }
+    }
+
+    return std::async(std::launch::async, [this, wanted = std::move(wanted)]() mutable {
+        // Read the pages of each file in order, a run of consecutive pages at a time.
+        size_t loaded = 0;
+        for (auto &[name, file]: wanted) {
+            auto &[c, ids] = file;
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            for (size_t i = 0, j; i < ids.size(); i = j) {
+                for (j = i + 1; j < ids.size() && ids[j] == ids[j - 1] + 1; j++) {
+                }
+                loaded += prefetch(name, c, {ids.begin() + i, ids.begin() + j});
+            }
+        }
+        return loaded;
+    });
+}
+
+size_t BufferPool::prefetch(const std::string &name, size_t c, const std::vector<size_t> &run) {
+    // Take frames for the pages that are not resident, without publishing them: nothing else uses them meanwhile.
+    std::vector<std::pair<size_t, size_t>> reserved;
+    {
+        std::unique_lock lock(mutex);
+        for (size_t page: run) {
+            // A page may have been loaded since the pages were chosen, or other pages may have taken the free frames.
+            if (available[c].empty()) {
+                break;
+            }
+            if (!pid_to_pos.contains({name, page})) {
+                reserved.emplace_back(page, available[c].back());
+                available[c].pop_back();
+            }
+        }
+        if (reserved.empty()) {
+            return 0;
+        }
+        prefetching.insert(name);
+    }
+
+    // Read without the lock, each run of consecutive pages with one system call. The file may have been removed
+    // since: discardFile waits for this prefetch, and the file is not looked up anymore once it is removed.
+    const DbFile *file = nullptr;
+    try {
+        file = &getDatabase().get(name);
+    } catch (const std::out_of_range &) {
+    }
+    bool read = file && std::countr_zero(file->getPageSize() / DEFAULT_PAGE_SIZE) == static_cast<int>(c);
+    for (size_t i = 0, j; read && i < reserved.size(); i = j) {
+        std::vector<Page *> frames{&frame(reserved[i].second)};
+        for (j = i + 1; j < reserved.size() && reserved[j].first == reserved[j - 1].first + 1; j++) {
+            frames.push_back(&frame(reserved[j].second));
+        }
+        file->readPages(frames, reserved[i].first);
+    }
+
+    // Publish the pages that were not loaded meanwhile, and give the other frames back.
+    std::unique_lock lock(mutex);
+    size_t loaded = 0;
+    for (const auto &[page, pos]: reserved) {
+        PageId pid{name, page};
+        if (!read || pid_to_pos.contains(pid)) {
+            available[c].push_back(pos);
+            continue;
+        }
+        if (log) {
+            std::copy_n(frame(pos).data(), frameSize(pos), loggedFrame(pos).data());
+        }
+        pid_to_pos[pid] = pos;
+        pos_to_pid[pos] = pid;
+        lru_list[c].push_front(pos);
+        pos_to_lru[pos] = lru_list[c].begin();
+        loaded++;
+    }
+    prefetching.erase(prefetching.find(name));
+    prefetched.notify_all();
+    return loaded;
+}
+
+void BufferPool::openLog(const std::string &path) {
+    std::unique_lock lock(mutex);
+    if (log) {
+        throw std::logic_error("The log is already open");
+    }
+    if (!pid_to_pos.empty()) {
+        throw std::logic_error("The buffer pool holds pages");
+    }
+    log = std::make_unique<WriteAheadLog>(path);
+    for (size_t c = 0; c < NUM_PAGE_SIZES; c++) {
+        logged[c] = std::make_unique_for_overwrite<Page[]>(DEFAULT_NUM_PAGES << c);
+    }
+}
+
+void BufferPool::commit() {
+    lsn_t lsn;
+    {
+        std::unique_lock lock(mutex);
+        if (!log) {
+            throw std::logic_error("No log is open");
+        }
+        for (size_t pos: dirty) {
+            // A page that a writer is changing is logged by a later commit, once the change is whole.
+            if (latches[pos].tryLock()) {
+                logPage(pos);
+                latches[pos].unlock();
+            }
+        }
+        lsn = log->end();
+    }
+    log->flush(lsn);
+}
+
+void BufferPool::checkpoint() {
+    std::unique_lock lock(mutex);
+    if (!log) {
+        throw std::logic_error("No log is open");
+    }
+    bool flushed = true;
+    for (size_t pos: std::vector<size_t>(dirty.begin(), dirty.end())) {
+        flushed &= flush(pos);
+    }
+    for (const std::string &file: unsynced) {
+        try {
+            getDatabase().get(file).sync();
+        } catch (const std::out_of_range &) {
+            // The file was removed from the Database, so its changes no longer matter.
+        }
+    }
+    unsynced.clear();
+    // The records of a page that a writer is changing are still needed.
+    if (flushed) {
+        log->truncate();
+    }
+}
+
+const WriteAheadLog *BufferPool::getLog() const { return log.get(); }
+
+PinnedPage::PinnedPage(BufferPool &bufferPool, const PageId &pid)
+    : bufferPool(&bufferPool), page(&bufferPool.pinPage(pid)), pid(pid) {}
+
+PinnedPage::~PinnedPage() { release(); }
+
+PinnedPage::PinnedPage(PinnedPage &&other) noexcept
+    : bufferPool(other.bufferPool), page(std::exchange(other.page, nullptr)), pid(std::move(other.pid)) {}
+
+PinnedPage &PinnedPage::operator=(PinnedPage &&other) noexcept {
+    if (this != &other) {
+        release();
+        bufferPool = other.bufferPool;
+        page = std::exchange(other.page, nullptr);
+        pid = std::move(other.pid);
+    }
+    return *this;
+}
+
+void PinnedPage::release() {
+    if (page != nullptr) {
+        bufferPool->unpinPage(*page);
+        page = nullptr;
     }
 }
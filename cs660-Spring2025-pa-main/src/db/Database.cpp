@@ -1,7 +1,94 @@
+#include <db/BTreeFile.hpp>
 #include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <db/HeapFile.hpp>
+#include <db/PaxFile.hpp>
+#include <db/SecondaryIndex.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 
 using namespace db;
 
+namespace {
+    constexpr uint64_t CATALOG_MAGIC = 0x324c544142434443; // "CDBCATL2"
+
+    /**
+     * The catalog starts with its magic number and the number of files. Each file is recorded as the length of its
+     * name in two bytes, the name, the format, the page size, the key fields and the fields of the schema, the way
+     * the superblock of the file records them. Then comes the length of the name of the heap file of an index in two
+     * bytes, 0 for other files, and for an index the heap name, its key fields in the heap and whether it is attached.
+     */
+    class CatalogWriter {
+        std::vector<uint8_t> bytes;
+
+    public:
+        template<typename T>
+        void put(T value) {
+            const auto *p = reinterpret_cast<const uint8_t *>(&value);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+        }
+
+        void put(const std::string &s) { bytes.insert(bytes.end(), s.begin(), s.end()); }
+
+        const std::vector<uint8_t> &data() const { return bytes; }
+    };
+
+    class CatalogReader {
+        std::vector<uint8_t> bytes;
+        size_t pos = 0;
+
+        const uint8_t *take(size_t n) {
+            if (bytes.size() - pos < n) {
+                throw std::runtime_error("Truncated catalog");
+            }
+            pos += n;
+            return bytes.data() + pos - n;
+        }
+
+    public:
+        explicit CatalogReader(std::vector<uint8_t> bytes) : bytes(std::move(bytes)) {}
+
+        template<typename T>
+        T get() {
+            T value;
+            std::memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string get(size_t n) {
+            const auto *p = reinterpret_cast<const char *>(take(n));
+            return {p, n};
+        }
+    };
+
+    std::unique_ptr<DbFile> openFile(const std::string &name, const TupleDesc &td, size_t page_size,
+                                     const FileLayout &layout) {
+        switch (layout.format & 0xff) {
+            case 'H':
+                return std::make_unique<HeapFile>(name, td);
+            case 'P':
+                return std::make_unique<PaxFile>(name, td);
+            case 'X':
+                return std::make_unique<HashFile>(name, td, layout.key_indices);
+            case 'B':
+                return openBTreeFile(name, td, page_size, layout);
+            default:
+                throw std::runtime_error("Unknown file format");
+        }
+    }
+
+    std::unique_ptr<DbFile> openIndex(const std::string &name, DbFile &file, const std::vector<size_t> &key_indices) {
+        auto *heap = dynamic_cast<HeapFile *>(&file);
+        if (!heap) {
+            throw std::runtime_error("Index over a file that is not a heap");
+        }
+        return std::make_unique<SecondaryIndex>(name, *heap, key_indices);
+    }
+} // namespace
+
 BufferPool &Database::getBufferPool() { return bufferPool; }
 
 Database &db::getDatabase() {
@@ -12,23 +99,168 @@ Database &db::getDatabase() {
 void Database::add(std::unique_ptr<DbFile> file) {
     // TODO pa0
     const std::string &name = file->getName();
+    std::unique_lock lock(mutex);
     if (files.contains(name)) {
         throw std::logic_error("File already exists");
     }
-    files[name] = std::move(file);
+    auto entry = std::make_unique<Entry>();
+    entry->file = std::move(file);
+    std::call_once(entry->opened, [] {});
+    files[entry->file->getName()] = std::move(entry);
 }
 
 std::unique_ptr<DbFile> Database::remove(const std::string &name) {
     // TODO pa0
-    auto nh = files.extract(name);
-    if (nh.empty()) {
-        throw std::logic_error("File does not exist");
+    {
+        std::shared_lock lock(mutex);
+        if (!files.contains(name)) {
+            throw std::logic_error("File does not exist");
+        }
     }
-    Database::getBufferPool().flushFile(nh.key());
-    return std::move(nh.mapped());
+    // Open a file of a catalog that was never used, to hand it over.
+    get(name);
+    // Flush while the file is still in the catalog: writing a page looks the file up by name.
+    Database::getBufferPool().flushFile(name);
+    std::unique_ptr<Entry> entry;
+    {
+        std::unique_lock lock(mutex);
+        entry = std::move(files.extract(name).mapped());
+    }
+    // Discard the pages once the file cannot be looked up anymore, so that the warm-up thread reads none of them.
+    Database::getBufferPool().discardFile(name);
+    return std::move(entry->file);
 }
 
 DbFile &Database::get(const std::string &name) const {
     // TODO pa0
-    return *files.at(name);
+    Entry *entry;
+    {
+        std::shared_lock lock(mutex);
+        entry = files.at(name).get();
+    }
+    // Threads asking for a file that is not open yet wait for the first one to open it. The heap of an index is
+    // opened first, outside the lock: opening a file reads no page, so it never waits for the lock of another file.
+    std::call_once(entry->opened, [&] {
+        entry->file = entry->heap.empty() ? openFile(name, entry->td, entry->page_size, entry->layout)
+                                          : openIndex(name, get(entry->heap), entry->heap_key_indices);
+    });
+    return *entry->file;
+}
+
+void Database::saveCatalog(const std::string &path) const {
+    CatalogWriter out;
+    out.put(CATALOG_MAGIC);
+    std::shared_lock lock(mutex);
+    out.put(static_cast<uint64_t>(files.size()));
+    for (const auto &[name, entry]: files) {
+        // An open file knows its schema and layout; an unused one still has them from the catalog it came from.
+        const DbFile *file = entry->file.get();
+        const TupleDesc &td = file ? file->getTupleDesc() : entry->td;
+        const FileLayout &layout = file ? file->getLayout() : entry->layout;
+        std::vector<std::string> names = td.names();
+        out.put(static_cast<uint16_t>(name.size()));
+        out.put(name);
+        out.put(layout.format);
+        out.put(static_cast<uint64_t>(file ? file->getPageSize() : entry->page_size));
+        out.put(static_cast<uint32_t>(layout.key_indices.size()));
+        for (size_t key: layout.key_indices) {
+            out.put(static_cast<uint32_t>(key));
+        }
+        out.put(static_cast<uint32_t>(names.size()));
+        for (size_t i = 0; i < names.size(); i++) {
+            if (td.type_of(i) == type_t::DICT) {
+                throw std::logic_error("DICT fields cannot be recorded in the catalog");
+            }
+            out.put(static_cast<uint8_t>(td.type_of(i)));
+            out.put(static_cast<uint8_t>(names[i].size()));
+            out.put(names[i]);
+        }
+        std::string heap = entry->heap;
+        std::vector<size_t> heap_key_indices = entry->heap_key_indices;
+        bool attached = entry->attached;
+        if (const auto *index = dynamic_cast<const SecondaryIndex *>(file)) {
+            const HeapFile &heap_file = index->getHeapFile();
+            heap = heap_file.getName();
+            heap_key_indices = index->getKeyIndices();
+            attached = std::ranges::find(heap_file.getIndexes(), index) != heap_file.getIndexes().end();
+        }
+        out.put(static_cast<uint16_t>(heap.size()));
+        if (!heap.empty()) {
+            out.put(heap);
+            out.put(static_cast<uint32_t>(heap_key_indices.size()));
+            for (size_t key: heap_key_indices) {
+                out.put(static_cast<uint32_t>(key));
+            }
+            out.put(static_cast<uint8_t>(attached));
+        }
+    }
+    lock.unlock();
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        const std::vector<uint8_t> &bytes = out.data();
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file.flush()) {
+            throw std::runtime_error("Cannot write the catalog");
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+void Database::loadCatalog(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot read the catalog");
+    }
+    CatalogReader in({std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()});
+    if (in.get<uint64_t>() != CATALOG_MAGIC) {
+        throw std::runtime_error("Not a catalog");
+    }
+    std::vector<std::pair<std::string, std::unique_ptr<Entry>>> entries;
+    for (uint64_t n = in.get<uint64_t>(); entries.size() < n;) {
+        std::string name = in.get(in.get<uint16_t>());
+        auto &entry = entries.emplace_back(std::move(name), std::make_unique<Entry>()).second;
+        entry->layout.format = in.get<uint32_t>();
+        entry->page_size = in.get<uint64_t>();
+        entry->layout.key_indices.resize(in.get<uint32_t>());
+        for (size_t &key: entry->layout.key_indices) {
+            key = in.get<uint32_t>();
+        }
+        std::vector<type_t> types(in.get<uint32_t>());
+        std::vector<std::string> names;
+        for (type_t &type: types) {
+            type = static_cast<type_t>(in.get<uint8_t>());
+            names.push_back(in.get(in.get<uint8_t>()));
+        }
+        entry->td = TupleDesc(types, names);
+        entry->heap = in.get(in.get<uint16_t>());
+        if (!entry->heap.empty()) {
+            entry->heap_key_indices.resize(in.get<uint32_t>());
+            for (size_t &key: entry->heap_key_indices) {
+                key = in.get<uint32_t>();
+            }
+            entry->attached = in.get<uint8_t>() != 0;
+        }
+    }
+    // Add the files only once the whole catalog has been read.
+    std::vector<std::string> attached;
+    {
+        std::unique_lock lock(mutex);
+        for (auto &[name, entry]: entries) {
+            if (files.contains(name)) {
+                throw std::logic_error("File already exists");
+            }
+        }
+        for (auto &[name, entry]: entries) {
+            if (entry->attached) {
+                attached.push_back(name);
+            }
+            files[name] = std::move(entry);
+        }
+    }
+    // Attach the indexes once they are open: attaching reads their pages, which looks them up by name.
+    for (const std::string &name: attached) {
+        auto &index = dynamic_cast<SecondaryIndex &>(get(name));
+        index.getHeapFile().addIndex(index);
+    }
 }
@@ -1,51 +1,307 @@
+#include <db/Batch.hpp>
+#include <db/Cursor.hpp>
 #include <db/DbFile.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 using namespace db;
 
+namespace {
+    /**
+     * The start of the superblock of a file. It is followed by the key fields, a uint32_t each, and by the fields of
+     * the schema: the type in one byte, the length of the name in one byte, and the name.
+     */
+    struct Superblock {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint64_t page_size;
+        uint64_t num_pages;
+        uint64_t root;
+        /// The first page of the list of free pages, 0 while no file frees pages
+        uint64_t free_list;
+        uint32_t num_keys;
+        uint32_t num_fields;
+    };
+
+    constexpr uint64_t FILE_MAGIC = 0x31454c4946424443; // "CDBFILE1"
+
+    constexpr uint32_t SUPERBLOCK_VERSION = 1;
+
+    /// Guards the open files and the file descriptors of every DbFile
+    std::mutex descriptors;
+
+    /// The files with an open file descriptor, the most recently used first
+    std::list<const DbFile *> open_files;
+
+    /**
+     * Encode a superblock into a zeroed block.
+     * @return false if the schema does not fit in the block
+     */
+    bool encode(Page &block, const Superblock &sb, const FileLayout &layout, const TupleDesc &td) {
+        std::vector<std::string> names = td.names();
+        size_t size = sizeof(Superblock) + layout.key_indices.size() * sizeof(uint32_t);
+        for (const std::string &name: names) {
+            if (name.size() > UINT8_MAX) {
+                return false;
+            }
+            size += 2 + name.size();
+        }
+        if (size > DEFAULT_PAGE_SIZE) {
+            return false;
+        }
+        std::memcpy(block.data(), &sb, sizeof(sb));
+        uint8_t *p = block.data() + sizeof(sb);
+        for (size_t key: layout.key_indices) {
+            auto index = static_cast<uint32_t>(key);
+            std::memcpy(p, &index, sizeof(index));
+            p += sizeof(index);
+        }
+        for (size_t i = 0; i < names.size(); i++) {
+            *p++ = static_cast<uint8_t>(td.type_of(i));
+            *p++ = static_cast<uint8_t>(names[i].size());
+            std::memcpy(p, names[i].data(), names[i].size());
+            p += names[i].size();
+        }
+        return true;
+    }
+
+    class IteratorCursor : public Cursor {
+        Iterator it;
+        Iterator last;
+
+    public:
+        explicit IteratorCursor(const DbFile &file) : it(file.begin()), last(file.end()) {}
+
+        bool valid() const override { return it != last; }
+
+        TupleView view() const override { return it.view(); }
+
+        Tuple get() const override { return *it; }
+
+        void get(Tuple &t) const override { it.file.getTuple(it, t); }
+
+        void next() override { ++it; }
+
+        Iterator position() const override { return it; }
+    };
+} // namespace
+
 const TupleDesc &DbFile::getTupleDesc() const { return td; }
 
-DbFile::DbFile(const std::string &name, const TupleDesc &td) : name(name), td(td) {
+DbFile::DbFile(const std::string &name, const TupleDesc &td, size_t page_size, const FileLayout &layout)
+    : layout(layout), name(name), td(td), page_size(page_size) {
     // TODO pa1: open file and initialize numPages
     // Hint: use open, fstat
+    if (!validPageSize(page_size)) {
+        throw std::logic_error("Unsupported page size");
+    }
+    Superblock sb{FILE_MAGIC, SUPERBLOCK_VERSION, layout.format, page_size, 0, layout.root, 0,
+                  static_cast<uint32_t>(layout.key_indices.size()), static_cast<uint32_t>(td.size())};
+    Page block{};
+    if (!encode(block, sb, layout, td)) {
+        throw std::logic_error("Schema does not fit in the superblock");
+    }
     fd = open(name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
     if (fd == -1) {
         throw std::runtime_error("open");
     }
     struct stat st{};
     if (fstat(fd, &st) == -1) {
+        close(fd);
         throw std::runtime_error("fstat");
     }
-    numPages = st.st_size / DEFAULT_PAGE_SIZE;
-    if (numPages == 0) {
-        numPages = 1;
+    if (st.st_size == 0) {
+        // A new file: write the superblock before the first page.
+        pwrite(fd, block.data(), DEFAULT_PAGE_SIZE, 0);
+    } else {
+        Page stored{};
+        pread(fd, stored.data(), DEFAULT_PAGE_SIZE, 0);
+        Superblock found;
+        std::memcpy(&found, stored.data(), sizeof(found));
+        const char *error = nullptr;
+        if (found.magic != FILE_MAGIC) {
+            error = "Not a database file";
+        } else if (found.version != SUPERBLOCK_VERSION) {
+            error = "Unsupported file version";
+        } else if (found.page_size != page_size) {
+            error = "Page size mismatch";
+        } else {
+            // Apart from the page count and the free list, the superblock is fully determined by the schema and the
+            // layout the file is opened with.
+            sb.num_pages = found.num_pages;
+            sb.free_list = found.free_list;
+            std::memcpy(block.data(), &sb, sizeof(sb));
+            if (block != stored) {
+                error = "Schema or layout mismatch";
+            }
+        }
+        if (error) {
+            close(fd);
+            throw std::runtime_error(error);
+        }
     }
+    // A new file has no page on disk yet, but its first page is there to be written.
+    stored_pages = sb.num_pages;
+    numPages = std::max<size_t>(stored_pages, 1);
+    std::lock_guard lock(descriptors);
+    track();
 }
 
 DbFile::~DbFile() {
     // TODO pa1: close file
     // Hind: use close
-    close(fd);
+    if (numPages != stored_pages) {
+        acquire();
+        writeSuperblock(numPages);
+        release();
+    }
+    std::lock_guard lock(descriptors);
+    if (fd != -1) {
+        close(fd);
+        open_files.erase(lru);
+    }
+}
+
+void DbFile::track() const {
+    if (open_files.size() >= MAX_OPEN_FILES) {
+        // Close the least recently used file that is not being read or written. If all of them are, go over the
+        // limit rather than wait.
+        for (auto it = open_files.end(); it != open_files.begin();) {
+            const DbFile *file = *--it;
+            if (file->users == 0) {
+                close(file->fd);
+                file->fd = -1;
+                open_files.erase(it);
+                break;
+            }
+        }
+    }
+    open_files.push_front(this);
+    lru = open_files.begin();
+}
+
+int DbFile::acquire() const {
+    std::lock_guard lock(descriptors);
+    if (fd == -1) {
+        fd = open(name.c_str(), O_RDWR);
+        if (fd == -1) {
+            throw std::runtime_error("open");
+        }
+        track();
+    } else {
+        open_files.splice(open_files.begin(), open_files, lru);
+    }
+    users++;
+    return fd;
+}
+
+void DbFile::release() const {
+    std::lock_guard lock(descriptors);
+    users--;
+}
+
+void DbFile::writeSuperblock(size_t pages) const {
+    Superblock sb{FILE_MAGIC, SUPERBLOCK_VERSION, layout.format, page_size, pages, layout.root, 0,
+                  static_cast<uint32_t>(layout.key_indices.size()), static_cast<uint32_t>(td.size())};
+    Page block{};
+    encode(block, sb, layout, td);
+    pwrite(fd, block.data(), DEFAULT_PAGE_SIZE, 0);
+    stored_pages = pages;
 }
 
 const std::string &DbFile::getName() const { return name; }
 
+size_t DbFile::getStoredPages() const { return stored_pages; }
+
 void DbFile::readPage(Page &page, const size_t id) const {
-    reads.push_back(id);
+    {
+        std::lock_guard lock(io_log);
+        reads.push_back(id);
+    }
     // TODO pa1: read page
     // Hint: use pread
-    std::fill(page.begin(), page.end(), 0);
-    pread(fd, page.data(), DEFAULT_PAGE_SIZE, id * DEFAULT_PAGE_SIZE);
+    std::fill_n(page.data(), page_size, 0);
+    pread(acquire(), page.data(), page_size, DEFAULT_PAGE_SIZE + id * page_size);
+    release();
+}
+
+void DbFile::readPages(const std::vector<Page *> &pages, size_t id) const {
+    {
+        // prefetch reads without the pool lock, so this can run next to readPage and writePage.
+        std::lock_guard lock(io_log);
+        for (size_t i = 0; i < pages.size(); i++) {
+            reads.push_back(id + i);
+        }
+    }
+    std::vector<iovec> buffers;
+    for (size_t i = 0; i < pages.size(); i++) {
+        std::fill_n(pages[i]->data(), page_size, 0);
+        buffers.push_back({pages[i]->data(), page_size});
+    }
+    preadv(acquire(), buffers.data(), static_cast<int>(buffers.size()), DEFAULT_PAGE_SIZE + id * page_size);
+    release();
 }
 
 void DbFile::writePage(const Page &page, const size_t id) const {
-    writes.push_back(id);
+    {
+        std::lock_guard lock(io_log);
+        writes.push_back(id);
+    }
     // TODO pa1: write page
     // Hint: use pwrite
-    pwrite(fd, page.data(), DEFAULT_PAGE_SIZE, id * DEFAULT_PAGE_SIZE);
+    acquire();
+    if (id >= stored_pages) {
+        // Record the page before writing it, so that the superblock covers every page on disk.
+        writeSuperblock(std::max<size_t>(numPages, id + 1));
+    }
+    pwrite(fd, page.data(), page_size, DEFAULT_PAGE_SIZE + id * page_size);
+    release();
+}
+
+void DbFile::sync() const {
+    int result = fdatasync(acquire());
+    release();
+    if (result == -1) {
+        throw std::runtime_error("fdatasync");
+    }
+}
+
+bool DbFile::redo(const std::string &name, const std::vector<PageUpdate> &updates) {
+    int fd = open(name.c_str(), O_RDWR);
+    if (fd == -1) {
+        return false;
+    }
+    Superblock sb;
+    if (pread(fd, &sb, sizeof(sb), 0) != sizeof(sb) || sb.magic != FILE_MAGIC || sb.version != SUPERBLOCK_VERSION) {
+        close(fd);
+        return false;
+    }
+    bool written = true;
+    uint64_t pages = sb.num_pages;
+    for (const PageUpdate &update: updates) {
+        off_t offset = static_cast<off_t>(DEFAULT_PAGE_SIZE + update.page * sb.page_size + update.offset);
+        written &= pwrite(fd, update.bytes.data(), update.bytes.size(), offset) ==
+                   static_cast<ssize_t>(update.bytes.size());
+        pages = std::max<uint64_t>(pages, update.page + 1);
+    }
+    if (pages != sb.num_pages) {
+        sb.num_pages = pages;
+        written &= pwrite(fd, &sb, sizeof(sb), 0) == sizeof(sb);
+    }
+    written &= fdatasync(fd) == 0;
+    close(fd);
+    if (!written) {
+        throw std::runtime_error("Cannot redo the log");
+    }
+    return true;
 }
 
 const std::vector<size_t> &DbFile::getReads() const { return reads; }
@@ -58,10 +314,29 @@ void DbFile::deleteTuple(const Iterator &it) { throw std::runtime_error("Not imp
 
 Tuple DbFile::getTuple(const Iterator &it) const { throw std::runtime_error("Not implemented"); }
 
+void DbFile::getTuple(const Iterator &it, Tuple &t) const { t = getTuple(it); }
+
+TupleView DbFile::getView(const Iterator &it) const { throw std::runtime_error("Not implemented"); }
+
 void DbFile::next(Iterator &it) const { throw std::runtime_error("Not implemented"); }
 
+bool DbFile::nextBatch(Iterator &it, Batch &batch) const {
+    batch.clear();
+    Iterator last = end();
+    for (; it != last && !batch.full(); next(it)) {
+        batch.append(getView(it).bytes());
+    }
+    return !batch.empty();
+}
+
 Iterator DbFile::begin() const { throw std::runtime_error("Not implemented"); }
 
 Iterator DbFile::end() const { throw std::runtime_error("Not implemented"); }
 
+std::unique_ptr<Cursor> DbFile::cursor() const { return std::make_unique<IteratorCursor>(*this); }
+
 size_t DbFile::getNumPages() const { return numPages; }
+
+size_t DbFile::getPageSize() const { return page_size; }
+
+const FileLayout &DbFile::getLayout() const { return layout; }
@@ -0,0 +1,111 @@
+#include <db/Dictionary.hpp>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+// The file is a sequence of values, each a 1-byte length followed by its characters, in code order.
+
+Dictionary::Dictionary(const std::string &path, size_t width) : code_width(width), path(path) {
+    if (width != 1 && width != 2 && width != 4) {
+        throw std::logic_error("Dictionary codes are 1, 2 or 4 bytes");
+    }
+    if (path.empty()) {
+        return;
+    }
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    std::vector<char> contents(st.st_size);
+    if (pread(fd, contents.data(), contents.size(), 0) != static_cast<ssize_t>(contents.size())) {
+        throw std::runtime_error("pread");
+    }
+    // A value cut short by a crash was never used by a page, so it is dropped.
+    size_t pos = 0;
+    while (pos < contents.size() && pos + 1 + static_cast<uint8_t>(contents[pos]) <= contents.size()) {
+        size_t length = static_cast<uint8_t>(contents[pos]);
+        const std::string &value = values.emplace_back(contents.data() + pos + 1, length);
+        codes.emplace(value, values.size() - 1);
+        pos += 1 + length;
+    }
+    if (pos != contents.size() && ftruncate(fd, static_cast<off_t>(pos)) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+}
+
+Dictionary::~Dictionary() {
+    if (fd != -1) {
+        close(fd);
+    }
+}
+
+size_t Dictionary::width() const { return code_width; }
+
+size_t Dictionary::size() const {
+    std::shared_lock lock(mutex);
+    return values.size();
+}
+
+uint32_t Dictionary::encode(std::string_view value) {
+    value = value.substr(0, strnlen(value.data(), std::min(value.size(), CHAR_SIZE)));
+    if (std::optional<uint32_t> code = find(value)) {
+        return *code;
+    }
+    std::unique_lock lock(mutex);
+    if (auto it = codes.find(value); it != codes.end()) {
+        return it->second;
+    }
+    uint64_t capacity = uint64_t{1} << (8 * code_width);
+    if (values.size() == capacity || values.size() == UINT32_MAX) {
+        throw std::logic_error("Dictionary is full");
+    }
+    if (fd != -1) {
+        char record[1 + CHAR_SIZE];
+        record[0] = static_cast<char>(value.size());
+        std::memcpy(record + 1, value.data(), value.size());
+        if (write(fd, record, 1 + value.size()) != static_cast<ssize_t>(1 + value.size())) {
+            throw std::runtime_error("write");
+        }
+        // The value must be durable before a page with its code can be logged or written.
+        if (fdatasync(fd) == -1) {
+            throw std::runtime_error("fdatasync");
+        }
+    }
+    auto code = static_cast<uint32_t>(values.size());
+    codes.emplace(values.emplace_back(value), code);
+    return code;
+}
+
+std::optional<uint32_t> Dictionary::find(std::string_view value) const {
+    value = value.substr(0, strnlen(value.data(), std::min(value.size(), CHAR_SIZE)));
+    std::shared_lock lock(mutex);
+    if (auto it = codes.find(value); it != codes.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::string_view Dictionary::decode(uint32_t code) const {
+    std::shared_lock lock(mutex);
+    if (code >= values.size()) {
+        throw std::out_of_range("Unknown dictionary code");
+    }
+    return values[code];
+}
+
+void Dictionary::store(uint8_t *data, uint32_t code) const { std::memcpy(data, &code, code_width); }
+
+uint32_t Dictionary::load(const uint8_t *data) const {
+    uint32_t code = 0;
+    std::memcpy(&code, data, code_width);
+    return code;
+}
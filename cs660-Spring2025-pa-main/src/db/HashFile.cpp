@@ -0,0 +1,310 @@
+#include <db/BucketPage.hpp>
+#include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+    struct HashFileHeader {
+        /// The number of hash bits used by the directory, 0 for a new file
+        uint32_t global_depth;
+
+        /// The number of directory pages, followed by their page numbers
+        uint32_t num_directory_pages;
+    };
+
+    constexpr size_t ENTRIES_PER_PAGE = DEFAULT_PAGE_SIZE / sizeof(uint32_t);
+
+    uint32_t *directoryPages(Page &page) {
+        return reinterpret_cast<uint32_t *>(page.data() + sizeof(HashFileHeader));
+    }
+
+    uint64_t hash(const NormalizedKey &key) { return KeyTraits<NormalizedKey>::hash(key); }
+
+    TupleDesc keyDesc(const TupleDesc &td, const std::vector<size_t> &key_indices) {
+        std::vector<type_t> types;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < key_indices.size(); i++) {
+            if (key_indices[i] >= td.size()) {
+                throw std::logic_error("Key index out of range");
+            }
+            types.push_back(td.type_of(key_indices[i]));
+            names.push_back("key" + std::to_string(i));
+        }
+        return {types, names};
+    }
+
+    /// Check the tuples of a hash file before the file is opened, and get its layout for the superblock
+    FileLayout bucketLayout(const TupleDesc &td, const std::vector<size_t> &key_indices) {
+        if (td.variable_length()) {
+            throw std::logic_error("Buckets only hold fixed-length tuples");
+        }
+        if ((DEFAULT_PAGE_SIZE - sizeof(BucketPageHeader)) / td.length() == 0) {
+            throw std::logic_error("Tuples do not fit in a bucket");
+        }
+        return {.format = 'X', .key_indices = key_indices, .root = 0};
+    }
+
+    std::vector<size_t> allFields(size_t n) {
+        std::vector<size_t> indices(n);
+        std::iota(indices.begin(), indices.end(), 0);
+        return indices;
+    }
+} // namespace
+
+HashFile::HashFile(const std::string &name, const TupleDesc &td, size_t key_index)
+    : HashFile(name, td, std::vector<size_t>{key_index}) {}
+
+HashFile::HashFile(const std::string &name, const TupleDesc &td, const std::vector<size_t> &key_indices)
+    : DbFile(name, td, DEFAULT_PAGE_SIZE, bucketLayout(td, key_indices)), kd(td, key_indices),
+      key_td(keyDesc(td, key_indices)), key_kd(key_td, allFields(key_indices.size())) {}
+
+const KeyDesc &HashFile::getKeyDesc() const { return kd; }
+
+size_t HashFile::getGlobalDepth() const {
+    load();
+    return global_depth;
+}
+
+void HashFile::load() const {
+    // The file is read lazily, since pages can only be read once the file is added to the Database.
+    if (loaded) {
+        return;
+    }
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PinnedPage header_page(bufferPool, {name, 0});
+    auto *header = reinterpret_cast<HashFileHeader *>((*header_page).data());
+    loaded = true;
+    if (header->num_directory_pages == 0) {
+        // A new file, the directory is created by the first insert.
+        return;
+    }
+    global_depth = header->global_depth;
+    directory_pages.assign(directoryPages(*header_page), directoryPages(*header_page) + header->num_directory_pages);
+    header_page.release();
+    directory.resize(size_t{1} << global_depth);
+    bucket_pages.assign(numPages, false);
+    for (size_t i = 0; i < directory_pages.size(); i++) {
+        PinnedPage page(bufferPool, {name, directory_pages[i]});
+        size_t begin = i * ENTRIES_PER_PAGE;
+        size_t n = std::min(ENTRIES_PER_PAGE, directory.size() - begin);
+        std::memcpy(directory.data() + begin, (*page).data(), n * sizeof(uint32_t));
+        for (size_t j = begin; j < begin + n; j++) {
+            bucket_pages[directory[j]] = true;
+        }
+    }
+}
+
+void HashFile::create() {
+    // One directory page with a single entry pointing to an empty bucket.
+    global_depth = 0;
+    directory_pages = {static_cast<uint32_t>(numPages++)};
+    bucket_pages.assign(numPages, false);
+    directory = {static_cast<uint32_t>(allocateBucket(0))};
+    writeHeader();
+    writeDirectory(0, 1);
+}
+
+void HashFile::writeHeader() const {
+    PinnedPage page(getDatabase().getBufferPool(), {name, 0});
+    auto *header = reinterpret_cast<HashFileHeader *>((*page).data());
+    header->global_depth = global_depth;
+    header->num_directory_pages = directory_pages.size();
+    std::memcpy(directoryPages(*page), directory_pages.data(), directory_pages.size() * sizeof(uint32_t));
+    page.markDirty();
+}
+
+void HashFile::writeDirectory(size_t begin, size_t end) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    while (begin < end) {
+        size_t i = begin / ENTRIES_PER_PAGE;
+        size_t n = std::min(end, (i + 1) * ENTRIES_PER_PAGE) - begin;
+        PinnedPage page(bufferPool, {name, directory_pages[i]});
+        auto *entries = reinterpret_cast<uint32_t *>((*page).data());
+        std::memcpy(entries + begin % ENTRIES_PER_PAGE, directory.data() + begin, n * sizeof(uint32_t));
+        page.markDirty();
+        begin += n;
+    }
+}
+
+void HashFile::doubleDirectory() {
+    if (global_depth == MAX_GLOBAL_DEPTH) {
+        throw std::runtime_error("Hash directory is full");
+    }
+    // The new half repeats the old one: both entries that only differ in the new bit point to the same bucket.
+    size_t size = directory.size();
+    directory.resize(2 * size);
+    std::copy(directory.begin(), directory.begin() + size, directory.begin() + size);
+    while (directory_pages.size() * ENTRIES_PER_PAGE < directory.size()) {
+        directory_pages.push_back(numPages++);
+        bucket_pages.push_back(false);
+    }
+    global_depth++;
+    writeDirectory(size, 2 * size);
+    writeHeader();
+}
+
+size_t HashFile::allocateBucket(uint8_t local_depth) {
+    size_t id = numPages++;
+    bucket_pages.push_back(true);
+    PinnedPage page(getDatabase().getBufferPool(), {name, id});
+    BucketPage bucket(*page, td, kd);
+    bucket.header->size = 0;
+    bucket.header->local_depth = local_depth;
+    page.markDirty();
+    return id;
+}
+
+void HashFile::splitBucket(size_t index) {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PinnedPage old_page(bufferPool, {name, directory[index]});
+    BucketPage old_bucket(*old_page, td, kd);
+    size_t local_depth = old_bucket.header->local_depth;
+    if (local_depth == global_depth) {
+        doubleDirectory();
+    }
+
+    // Keys whose bit `local_depth` is set move to the new bucket.
+    size_t new_id = allocateBucket(local_depth + 1);
+    PinnedPage new_page(bufferPool, {name, new_id});
+    BucketPage new_bucket(*new_page, td, kd);
+    old_bucket.header->local_depth = local_depth + 1;
+    for (size_t slot = 0; slot < old_bucket.header->size;) {
+        const uint8_t *tuple = old_bucket.data + slot * td.length();
+        if ((hash(kd.normalize(tuple)) >> local_depth) & 1) {
+            std::memcpy(new_bucket.data + new_bucket.header->size * td.length(), tuple, td.length());
+            new_bucket.header->size++;
+            old_bucket.remove(slot);
+        } else {
+            slot++;
+        }
+    }
+    old_page.markDirty();
+    new_page.markDirty();
+
+    // Repoint the directory entries of the old bucket that have the bit set, which are `2^(local_depth + 1)` apart.
+    size_t step = size_t{1} << local_depth;
+    size_t first = index & (step - 1);
+    for (size_t i = first | step; i < directory.size(); i += 2 * step) {
+        directory[i] = new_id;
+        writeDirectory(i, i + 1);
+    }
+}
+
+size_t HashFile::directoryIndex(const NormalizedKey &key) const {
+    return hash(key) & ((size_t{1} << global_depth) - 1);
+}
+
+NormalizedKey HashFile::normalizeKey(const Tuple &key) const {
+    if (!key_td.compatible(key)) {
+        throw std::logic_error("Key not compatible with the key fields");
+    }
+    return key_kd.normalize(key);
+}
+
+void HashFile::insertTuple(const Tuple &t) {
+    if (!td.compatible(t)) {
+        throw std::runtime_error("Tuple not compatible with TupleDesc");
+    }
+    load();
+    if (directory.empty()) {
+        create();
+    }
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    NormalizedKey key = kd.normalize(t);
+    while (true) {
+        size_t index = directoryIndex(key);
+        PinnedPage page(bufferPool, {name, directory[index]});
+        BucketPage bucket(*page, td, kd);
+        if (bucket.insertTuple(t)) {
+            page.markDirty();
+            return;
+        }
+        page.release();
+        splitBucket(index);
+    }
+}
+
+void HashFile::deleteTuple(const Iterator &it) {
+    load();
+    if (it.page >= bucket_pages.size() || !bucket_pages[it.page]) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    PinnedPage page(getDatabase().getBufferPool(), {name, it.page});
+    BucketPage(*page, td, kd).remove(it.slot);
+    page.markDirty();
+}
+
+std::optional<Tuple> HashFile::find(const Tuple &key) const {
+    NormalizedKey normalized = normalizeKey(key);
+    load();
+    if (directory.empty()) {
+        return std::nullopt;
+    }
+    PinnedPage page(getDatabase().getBufferPool(), {name, directory[directoryIndex(normalized)]});
+    BucketPage bucket(*page, td, kd);
+    size_t slot = bucket.find(normalized);
+    if (slot == bucket.header->size) {
+        return std::nullopt;
+    }
+    return bucket.getTuple(slot);
+}
+
+bool HashFile::erase(const Tuple &key) {
+    NormalizedKey normalized = normalizeKey(key);
+    load();
+    if (directory.empty()) {
+        return false;
+    }
+    PinnedPage page(getDatabase().getBufferPool(), {name, directory[directoryIndex(normalized)]});
+    BucketPage bucket(*page, td, kd);
+    size_t slot = bucket.find(normalized);
+    if (slot == bucket.header->size) {
+        return false;
+    }
+    bucket.remove(slot);
+    page.markDirty();
+    return true;
+}
+
+Tuple HashFile::getTuple(const Iterator &it) const {
+    PinnedPage page(getDatabase().getBufferPool(), {name, it.page});
+    return BucketPage(*page, td, kd).getTuple(it.slot);
+}
+
+TupleView HashFile::getView(const Iterator &it) const {
+    PinnedPage page(getDatabase().getBufferPool(), {name, it.page});
+    return BucketPage(*page, td, kd).getView(it.slot);
+}
+
+void HashFile::skipExhausted(Iterator &it) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    for (; it.page < bucket_pages.size(); it.page++, it.slot = 0) {
+        if (!bucket_pages[it.page]) {
+            continue;
+        }
+        PinnedPage page(bufferPool, {name, it.page});
+        if (it.slot < BucketPage(*page, td, kd).header->size) {
+            return;
+        }
+    }
+    it.page = 0;
+    it.slot = 0;
+}
+
+void HashFile::next(Iterator &it) const {
+    ++it.slot;
+    skipExhausted(it);
+}
+
+Iterator HashFile::begin() const {
+    load();
+    Iterator it{*this, 1, 0};
+    skipExhausted(it);
+    return it;
+}
+
+Iterator HashFile::end() const { return {*this, 0, 0}; }
@@ -1,11 +1,92 @@
+#include <db/Batch.hpp>
+#include <db/Cursor.hpp>
 #include <db/Database.hpp>
+#include <db/Dictionary.hpp>
 #include <db/HeapFile.hpp>
 #include <db/HeapPage.hpp>
+#include <db/SecondaryIndex.hpp>
+#include <db/Selection.hpp>
+#include <algorithm>
+#include <optional>
 #include <stdexcept>
 
 using namespace db;
 
-HeapFile::HeapFile(const std::string &name, const TupleDesc &td) : DbFile(name, td) {}
+namespace {
+    class HeapCursor : public Cursor {
+        const HeapFile &file;
+        size_t page = 0;
+        size_t slot = 0;
+        PinnedPage pinned;
+        std::optional<HeapPage> hp;
+
+        // Move to the first occupied slot at or after the position, pinning pages on the way.
+        void seek() {
+            BufferPool &bufferPool = getDatabase().getBufferPool();
+            while (page < file.getNumPages()) {
+                if (!hp) {
+                    pinned = PinnedPage(bufferPool, {file.getName(), page});
+                    hp.emplace(*pinned, file.getTupleDesc());
+                }
+                if (slot < hp->end() && hp->empty(slot)) {
+                    hp->next(slot);
+                }
+                if (slot < hp->end()) {
+                    return;
+                }
+                hp.reset();
+                pinned.release();
+                page++;
+                slot = 0;
+            }
+        }
+
+    public:
+        explicit HeapCursor(const HeapFile &file) : file(file) { seek(); }
+
+        bool valid() const override { return hp.has_value(); }
+
+        TupleView view() const override { return hp->getView(slot); }
+
+        Tuple get() const override { return hp->getTuple(slot); }
+
+        void get(Tuple &t) const override { hp->getView(slot).toTuple(t); }
+
+        void next() override {
+            if (hp) {
+                hp->next(slot);
+                seek();
+            }
+        }
+
+        Iterator position() const override { return {file, page, slot}; }
+    };
+} // namespace
+
+HeapFile::HeapFile(const std::string &name, const TupleDesc &td)
+    : DbFile(name, td, DEFAULT_PAGE_SIZE, {.format = 'H', .key_indices = {}, .root = 0}), zones(td) {
+    // The first page of a file that has no page on disk yet is known to be empty.
+    if (getStoredPages() == 0) {
+        zones.reset(0);
+    }
+}
+
+void HeapFile::addIndex(SecondaryIndex &index) {
+    if (&index.getHeapFile() != this) {
+        throw std::logic_error("Index belongs to another file");
+    }
+    // An index with entries was built before, by this process or an earlier one: it is attached as it is.
+    if (index.begin() == index.end()) {
+        index.build();
+    }
+    indexes.push_back(&index);
+}
+
+void HeapFile::dropIndex(const SecondaryIndex &index) {
+    indexes.erase(std::remove(indexes.begin(), indexes.end(), &index), indexes.end());
+}
+
+const std::vector<SecondaryIndex *> &HeapFile::getIndexes() const { return indexes; }
 
 void HeapFile::insertTuple(const Tuple &t) {
     // TODO pa1
@@ -17,14 +98,23 @@ void HeapFile::insertTuple(const Tuple &t) {
     pid.page = numPages - 1;
     Page &p = bufferPool.getPage(pid);
     HeapPage hp(p, td);
-    if (!hp.insertTuple(t)) {
+    size_t slot;
+    if (!hp.insertTuple(t, &slot)) {
         numPages++;
         pid.page++;
         Page &np = bufferPool.getPage(pid);
         HeapPage nhp(np, td);
-        nhp.insertTuple(t);
+        if (!nhp.insertTuple(t, &slot)) {
+            numPages--;
+            throw std::runtime_error("Tuple does not fit in a page");
+        }
+        zones.reset(pid.page);
     }
     bufferPool.markDirty(pid);
+    zones.insert(pid.page, t);
+    for (SecondaryIndex *index: indexes) {
+        index->insertEntry(t, {pid.page, slot});
+    }
 }
 
 void HeapFile::deleteTuple(const Iterator &it) {
@@ -33,8 +123,113 @@ void HeapFile::deleteTuple(const Iterator &it) {
     PageId pid{name, it.page};
     Page &p = bufferPool.getPage(pid);
     HeapPage hp(p, td);
-    bufferPool.markDirty(pid);
+    // The index entries are found by key, so read the tuple before it is gone.
+    std::optional<Tuple> t;
+    if (!indexes.empty()) {
+        t = hp.getTuple(it.slot);
+    }
     hp.deleteTuple(it.slot);
+    bufferPool.markDirty(pid);
+    zones.remove(it.page);
+    for (SecondaryIndex *index: indexes) {
+        index->deleteEntry(*t, {it.page, it.slot});
+    }
+}
+
+void HeapFile::scan(const std::vector<Predicate> &predicates,
+                    const std::function<void(const Tuple &)> &callback) const {
+    scanViews(predicates, [&](const TupleView &t) { callback(t.toTuple()); });
+}
+
+void HeapFile::scanViews(const std::vector<Predicate> &predicates,
+                         const std::function<void(const TupleView &)> &callback) const {
+    std::vector<Predicate> vectorized;
+    std::vector<Predicate> remaining;
+    // Equality predicates on DICT fields compare codes: the code of the constant is looked up once.
+    struct CodePredicate {
+        size_t field;
+        uint32_t code;
+        bool equal;
+    };
+    std::vector<CodePredicate> coded;
+    for (const Predicate &p: predicates) {
+        p.check(td);
+        const Dictionary *dictionary = td.dictionary_of(p.field);
+        if (dictionary && (p.op == op_t::EQ || p.op == op_t::NE)) {
+            std::optional<uint32_t> code = dictionary->find(std::get<std::string>(p.value));
+            if (code) {
+                coded.push_back({p.field, *code, p.op == op_t::EQ});
+            } else if (p.op == op_t::EQ) {
+                // No tuple holds a value missing from the dictionary.
+                return;
+            }
+            continue;
+        }
+        (Selection::vectorizable(p) ? vectorized : remaining).push_back(p);
+    }
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    for (size_t page = 0; page < numPages; page++) {
+        if (!zones.mayMatch(page, predicates)) {
+            continue;
+        }
+        bool learn = !zones.isKnown(page);
+        if (learn) {
+            zones.reset(page);
+        }
+        // The page stays pinned while the callback runs.
+        PinnedPage pinned(bufferPool, {name, page});
+        const HeapPage hp(*pinned, td);
+        if (learn) {
+            for (size_t slot = hp.begin(); slot != hp.end(); hp.next(slot)) {
+                zones.insert(page, hp.getView(slot));
+            }
+        }
+        if (td.variable_length()) {
+            for (size_t slot = hp.begin(); slot != hp.end(); hp.next(slot)) {
+                TupleView t = hp.getView(slot);
+                auto matches = [&](const Predicate &p) { return p.matches(t); };
+                if (std::all_of(predicates.begin(), predicates.end(), matches)) {
+                    callback(t);
+                }
+            }
+            continue;
+        }
+        // Narrow the occupied slots down with the numeric predicates on the page bytes, then check the others on
+        // the remaining tuples.
+        Selection selection(hp.bitmap(), hp.end());
+        for (const Predicate &p: vectorized) {
+            if (selection.none()) {
+                break;
+            }
+            selection.filter(p, hp.values(p.field), td.length());
+        }
+        for (const CodePredicate &p: coded) {
+            if (selection.none()) {
+                break;
+            }
+            selection.filterCode(p.code, p.equal, hp.values(p.field), td.length(), td.dictionary_of(p.field)->width());
+        }
+        selection.forEach([&](size_t slot) {
+            TupleView t = hp.getView(slot);
+            if (std::all_of(remaining.begin(), remaining.end(), [&](const Predicate &p) { return p.matches(t); })) {
+                callback(t);
+            }
+        });
+    }
+}
+
+void HeapFile::scan(const std::vector<Predicate> &predicates, const std::vector<size_t> &columns,
+                    const std::function<void(const std::vector<field_t> &)> &callback) const {
+    for (size_t column: columns) {
+        if (column >= td.size()) {
+            throw std::out_of_range("Column out of range");
+        }
+    }
+    std::vector<field_t> fields;
+    scanViews(predicates, [&](const TupleView &t) {
+        td.deserialize(t.bytes(), columns, fields);
+        callback(fields);
+    });
 }
 
 Tuple HeapFile::getTuple(const Iterator &it) const {
@@ -46,6 +241,13 @@ Tuple HeapFile::getTuple(const Iterator &it) const {
     return hp.getTuple(it.slot);
 }
 
+void HeapFile::getTuple(const Iterator &it, Tuple &t) const { getView(it).toTuple(t); }
+
+TupleView HeapFile::getView(const Iterator &it) const {
+    Page &p = getDatabase().getBufferPool().getPage({name, it.page});
+    return HeapPage(p, td).getView(it.slot);
+}
+
 void HeapFile::next(Iterator &it) const {
     // TODO pa1
     BufferPool &bufferPool = getDatabase().getBufferPool();
@@ -72,6 +274,28 @@ void HeapFile::next(Iterator &it) const {
     it.slot = 0;
 }
 
+bool HeapFile::nextBatch(Iterator &it, Batch &batch) const {
+    batch.clear();
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    for (; it.page < numPages; it.page++, it.slot = 0) {
+        PinnedPage pinned(bufferPool, {name, it.page});
+        const HeapPage hp(*pinned, td);
+        if (it.slot < hp.end() && hp.empty(it.slot)) {
+            hp.next(it.slot);
+        }
+        for (; it.slot < hp.end(); hp.next(it.slot)) {
+            if (batch.full()) {
+                return true;
+            }
+            batch.append(hp.getView(it.slot).bytes());
+        }
+    }
+    it.slot = 0;
+    return !batch.empty();
+}
+
+std::unique_ptr<Cursor> HeapFile::cursor() const { return std::make_unique<HeapCursor>(*this); }
+
 Iterator HeapFile::begin() const {
     // TODO pa1
     BufferPool &bufferPool = getDatabase().getBufferPool();
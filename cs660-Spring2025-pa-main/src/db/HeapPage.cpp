@@ -1,5 +1,6 @@
 #include <db/Database.hpp>
 #include <db/HeapPage.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 using namespace db;
@@ -7,14 +8,24 @@ using namespace db;
 HeapPage::HeapPage(Page &page, const TupleDesc &td) : td(td) {
     // TODO pa1
     // NOTE: header and data should point to locations inside the page buffer. Do not allocate extra memory.
-    capacity = DEFAULT_PAGE_SIZE * 8 / (td.length() * 8 + 1);
     header = page.data();
+    if (td.variable_length()) {
+        // Every slot takes a directory entry and at least the fixed part of a tuple.
+        capacity = (DEFAULT_PAGE_SIZE - sizeof(SlottedHeapPageHeader)) / (sizeof(Slot) + td.length());
+        data = page.data();
+        SlottedHeapPageHeader *h = slottedHeader();
+        slotted.emplace(page, sizeof(SlottedHeapPageHeader), h->slots, h->start);
+        return;
+    }
+    capacity = DEFAULT_PAGE_SIZE * 8 / (td.length() * 8 + 1);
     data = header + DEFAULT_PAGE_SIZE - td.length() * capacity;
 }
 
+SlottedHeapPageHeader *HeapPage::slottedHeader() const { return reinterpret_cast<SlottedHeapPageHeader *>(header); }
+
 size_t HeapPage::begin() const {
     // TODO pa1
-    for (size_t i = 0; i < capacity; i++) {
+    for (size_t i = 0; i < end(); i++) {
         if (!empty(i)) {
             return i;
         }
@@ -24,11 +35,39 @@ size_t HeapPage::begin() const {
 
 size_t HeapPage::end() const {
     // TODO pa1
+    if (slotted) {
+        return std::min<size_t>(slottedHeader()->slots, capacity);
+    }
     return capacity;
 }
 
-bool HeapPage::insertTuple(const Tuple &t) {
+bool HeapPage::insertTuple(const Tuple &t, size_t *inserted) {
     // TODO pa1
+    if (slotted) {
+        size_t length = td.length(t);
+        // Reuse the first free slot, or add one.
+        size_t slot = 0;
+        while (slot < end() && !empty(slot)) {
+            slot++;
+        }
+        bool new_slot = slot == end();
+        if (new_slot && slot == capacity) {
+            return false;
+        }
+        uint8_t *tuple = slotted->allocate(length, new_slot);
+        if (!tuple) {
+            return false;
+        }
+        td.serialize(tuple, t);
+        slotted->slots[slot] = {static_cast<uint16_t>(tuple - header), static_cast<uint16_t>(length)};
+        if (new_slot) {
+            slottedHeader()->slots++;
+        }
+        if (inserted) {
+            *inserted = slot;
+        }
+        return true;
+    }
     size_t slot = 0;
     while (slot < capacity && (header[slot / 8] & (1 << (7 - slot % 8)))) {
         slot++;
@@ -39,6 +78,9 @@ bool HeapPage::insertTuple(const Tuple &t) {
     header[slot / 8] |= 1 << (7 - slot % 8);
     uint8_t *slotData = data + slot * td.length();
     td.serialize(slotData, t);
+    if (inserted) {
+        *inserted = slot;
+    }
     return true;
 }
 
@@ -50,6 +92,18 @@ void HeapPage::deleteTuple(size_t slot) {
     if (empty(slot)) {
         throw std::runtime_error("Slot not occupied");
     }
+    if (slotted) {
+        // The space of the tuple is reclaimed when the page is compacted.
+        slotted->slots[slot] = {0, 0};
+        SlottedHeapPageHeader *h = slottedHeader();
+        while (h->slots > 0 && slotted->slots[h->slots - 1].offset == 0) {
+            h->slots--;
+        }
+        if (h->slots == 0) {
+            h->start = 0;
+        }
+        return;
+    }
     header[slot / 8] &= ~(1 << (7 - slot % 8));
 }
 
@@ -58,16 +112,46 @@ Tuple HeapPage::getTuple(size_t slot) const {
     if (empty(slot)) {
         throw std::runtime_error("Slot not occupied");
     }
-    uint8_t *slotData = data + slot * td.length();
-    return td.deserialize(slotData);
+    return td.deserialize(tuple(slot));
+}
+
+TupleView HeapPage::getView(size_t slot) const {
+    if (empty(slot)) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    return {td, tuple(slot)};
 }
 
 void HeapPage::next(size_t &slot) const {
     // TODO pa1
-    while (++slot < capacity && empty(slot));
+    // The slots of a slotted page shrink when its last tuples are deleted, possibly below the current slot.
+    size_t last = end();
+    while (++slot < last && empty(slot));
+    slot = std::min(slot, last);
 }
 
 bool HeapPage::empty(size_t slot) const {
     // TODO pa1
+    if (slotted) {
+        return slot >= end() || slotted->slots[slot].offset == 0;
+    }
     return !(header[slot / 8] & (1 << (7 - slot % 8)));
 }
+
+const uint8_t *HeapPage::tuple(size_t slot) const {
+    return slotted ? slotted->tuple(slot) : data + slot * td.length();
+}
+
+const uint8_t *HeapPage::bitmap() const {
+    if (slotted) {
+        throw std::logic_error("Slotted pages have no bitmap");
+    }
+    return header;
+}
+
+const uint8_t *HeapPage::values(size_t field) const {
+    if (slotted) {
+        throw std::logic_error("Slotted pages have no fixed slots");
+    }
+    return data + td.offset_of(field);
+}
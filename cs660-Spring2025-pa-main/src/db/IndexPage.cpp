@@ -1,59 +1,154 @@
+#include <algorithm>
 #include <cstring>
- #include <stdexcept>
- #include "db/IndexPage.hpp"
- #include "db/types.hpp"
-
- using namespace db;
-
- IndexPage::IndexPage(Page &page) {
-     // The page layout: [IndexPageHeader | keys[] | children[]]
-     header = reinterpret_cast<IndexPageHeader*>(page.data());
-     // Compute capacity based on available space.
-     capacity = (DEFAULT_PAGE_SIZE - sizeof(IndexPageHeader) - sizeof(size_t)) /
-                (sizeof(int) + sizeof(size_t));
-     keys = reinterpret_cast<int*>(page.data() + sizeof(IndexPageHeader));
-     children = reinterpret_cast<size_t*>(page.data() + sizeof(IndexPageHeader) + capacity * sizeof(int));
-     // If header data is uninitialized (or corrupt), reinitialize.
-     if (header->size > capacity)
-         header->size = 0;
- }
-
- bool IndexPage::insert(int key, size_t child) {
-     // If page is already full, signal that a split is needed.
-     if (header->size >= capacity)
-         return true;
-     int pos = 0;
-     // Find insertion point so that keys remain in sorted order.
-     while (pos < header->size && keys[pos] < key)
-         pos++;
-     // Shift keys and children right to make room.
-     for (int i = header->size; i > pos; i--) {
-         keys[i] = keys[i-1];
-     }
-     for (int i = header->size + 1; i > pos + 1; i--) {
-         children[i] = children[i-1];
-     }
-     keys[pos] = key;
-     children[pos+1] = child;
-     header->size++;
-     // Signal that the page is full if insertion causes size to equal capacity.
-     return header->size == capacity;
- }
-
- int IndexPage::split(IndexPage &new_page) {
-     int n = header->size;
-     int median_index = n / 2;
-     int median_key = keys[median_index];
-     int new_count = n - (median_index + 1);
-     new_page.header->size = new_count;
-     // Copy keys and children from the right half to the new page.
-     for (int i = 0; i < new_count; i++) {
-         new_page.keys[i] = keys[median_index + 1 + i];
-     }
-     for (int i = 0; i < new_count + 1; i++) {
-         new_page.children[i] = children[median_index + 1 + i];
-     }
-     // Adjust the current page’s size.
-     header->size = median_index;
-     return median_key;
- }
\ No newline at end of file
+#include <stdexcept>
+#include "db/IndexPage.hpp"
+#include "db/types.hpp"
+
+using namespace db;
+
+template<typename Key>
+BasicIndexPage<Key>::BasicIndexPage(Page &page, size_t key_size, bool blink, size_t page_size)
+    : key_size(key_size), blink(blink) {
+    // The page layout: [IndexPageHeader | keys[] | children[]]
+    header = reinterpret_cast<IndexPageHeader *>(page.data());
+    // Compute capacity based on available space.
+    capacity = (page_size - sizeof(IndexPageHeader) - sizeof(size_t)) / (key_size + sizeof(size_t));
+    keys = reinterpret_cast<slot_type *>(page.data() + sizeof(IndexPageHeader));
+    children = reinterpret_cast<size_t *>(page.data() + sizeof(IndexPageHeader) + capacity * key_size);
+    // A B-link page keeps its high key in the last key slot and its right link in the last child slot.
+    if (blink)
+        capacity--;
+    // Optimistic readers construct pages too, so this must not write: size() keeps their reads within the page.
+}
+
+template<typename Key>
+size_t BasicIndexPage<Key>::size() const {
+    return std::min<size_t>(header->size, capacity);
+}
+
+template<typename Key>
+uint8_t *BasicIndexPage<Key>::slot(size_t i) const {
+    return reinterpret_cast<uint8_t *>(keys) + i * key_size;
+}
+
+template<typename Key>
+typename BasicIndexPage<Key>::key_type BasicIndexPage<Key>::key(size_t i) const {
+    return KeyTraits<Key>::load(slot(i), key_size);
+}
+
+template<typename Key>
+size_t &BasicIndexPage<Key>::rightLink() const {
+    return children[capacity + 1];
+}
+
+template<typename Key>
+typename BasicIndexPage<Key>::key_type BasicIndexPage<Key>::highKey() const {
+    return key(capacity);
+}
+
+template<typename Key>
+void BasicIndexPage<Key>::link(size_t right, const key_type &high_key) {
+    rightLink() = right;
+    KeyTraits<Key>::store(slot(capacity), high_key, key_size);
+}
+
+template<typename Key>
+bool BasicIndexPage<Key>::beyond(const key_type &key) const {
+    return rightLink() != 0 && KeyTraits<Key>::compare(slot(capacity), key, key_size) <= 0;
+}
+
+template<typename Key>
+bool BasicIndexPage<Key>::hasChild(size_t child) const {
+    return std::find(children, children + size() + 1, child) != children + size() + 1;
+}
+
+template<typename Key>
+size_t BasicIndexPage<Key>::route(const key_type &key) const {
+    if constexpr (KeyTraits<Key>::static_size != 0) {
+        return branchless_search<true>(keys, size(), key);
+    } else {
+        size_t low = 0, high = size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (KeyTraits<Key>::compare(slot(mid), key, key_size) <= 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+}
+
+template<typename Key>
+size_t BasicIndexPage<Key>::lowerRoute(const key_type &key) const {
+    if constexpr (KeyTraits<Key>::static_size != 0) {
+        return branchless_search<false>(keys, size(), key);
+    } else {
+        size_t low = 0, high = size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (KeyTraits<Key>::compare(slot(mid), key, key_size) < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+}
+
+template<typename Key>
+bool BasicIndexPage<Key>::insert(const key_type &key, size_t child) {
+    // If page is already full, signal that a split is needed.
+    if (header->size >= capacity)
+        return true;
+    // Find insertion point so that keys remain in sorted order.
+    size_t pos = route(key);
+    // Shift keys and children right to make room.
+    std::memmove(slot(pos + 1), slot(pos), (header->size - pos) * key_size);
+    std::memmove(children + pos + 2, children + pos + 1, (header->size - pos) * sizeof(size_t));
+    KeyTraits<Key>::store(slot(pos), key, key_size);
+    children[pos + 1] = child;
+    header->size++;
+    // Signal that the page is full if insertion causes size to equal capacity.
+    return header->size == capacity;
+}
+
+template<typename Key>
+bool BasicIndexPage<Key>::insert(const key_type &key, size_t child, size_t left) {
+    if (header->size >= capacity)
+        return true;
+    size_t pos = std::find(children, children + header->size + 1, left) - children;
+    if (pos > header->size)
+        throw std::logic_error("Child not found");
+    std::memmove(slot(pos + 1), slot(pos), (header->size - pos) * key_size);
+    std::memmove(children + pos + 2, children + pos + 1, (header->size - pos) * sizeof(size_t));
+    KeyTraits<Key>::store(slot(pos), key, key_size);
+    children[pos + 1] = child;
+    header->size++;
+    return header->size == capacity;
+}
+
+template<typename Key>
+typename BasicIndexPage<Key>::key_type BasicIndexPage<Key>::split(BasicIndexPage &new_page) {
+    size_t n = header->size;
+    size_t median_index = n / 2;
+    key_type median_key = key(median_index);
+    size_t new_count = n - (median_index + 1);
+    new_page.header->size = new_count;
+    new_page.header->index_children = header->index_children;
+    // Copy keys and children from the right half to the new page.
+    std::memcpy(new_page.slot(0), slot(median_index + 1), new_count * key_size);
+    std::memcpy(new_page.children, children + median_index + 1, (new_count + 1) * sizeof(size_t));
+    // Adjust the current page’s size.
+    header->size = median_index;
+    if (blink) {
+        new_page.rightLink() = rightLink();
+        std::memcpy(new_page.slot(new_page.capacity), slot(capacity), key_size);
+        KeyTraits<Key>::store(slot(capacity), median_key, key_size);
+    }
+    return median_key;
+}
+
+template struct db::BasicIndexPage<int>;
+template struct db::BasicIndexPage<double>;
+template struct db::BasicIndexPage<NormalizedKey>;
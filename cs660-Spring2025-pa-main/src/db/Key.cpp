@@ -0,0 +1,171 @@
+#include <db/Key.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+    size_t normalized_size(type_t type) {
+        switch (type) {
+            case type_t::INT:
+                return INT_SIZE;
+            case type_t::DOUBLE:
+                return DOUBLE_SIZE;
+            case type_t::CHAR:
+                return CHAR_SIZE;
+            case type_t::VARCHAR:
+            case type_t::DICT:
+                break;
+        }
+        // Codes are assigned in order of appearance, so they do not sort like their values.
+        throw std::logic_error("VARCHAR and DICT fields cannot be key fields");
+    }
+
+    void store_big_endian(uint8_t *out, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            out[i] = static_cast<uint8_t>(value >> (8 * (size - 1 - i)));
+        }
+    }
+
+    void normalize_int(uint8_t *out, int value) {
+        store_big_endian(out, static_cast<uint32_t>(value) ^ 0x80000000u, INT_SIZE);
+    }
+
+    void normalize_double(uint8_t *out, double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        // Negative numbers order in reverse, so flip all their bits; positive numbers only need the sign bit set.
+        bits = (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+        store_big_endian(out, bits, DOUBLE_SIZE);
+    }
+
+    void normalize_char(uint8_t *out, const char *value) {
+        strncpy(reinterpret_cast<char *>(out), value, CHAR_SIZE);
+    }
+
+    /// Normalize a field stored in its serialized tuple representation
+    void normalize_raw(uint8_t *out, const uint8_t *field, type_t type) {
+        switch (type) {
+            case type_t::INT: {
+                int value;
+                std::memcpy(&value, field, sizeof(value));
+                normalize_int(out, value);
+                break;
+            }
+            case type_t::DOUBLE: {
+                double value;
+                std::memcpy(&value, field, sizeof(value));
+                normalize_double(out, value);
+                break;
+            }
+            case type_t::CHAR:
+                // Serialized CHAR fields are already zero-padded and compare bytewise.
+                std::memcpy(out, field, CHAR_SIZE);
+                break;
+            case type_t::VARCHAR:
+            case type_t::DICT:
+                break;
+        }
+    }
+} // namespace
+
+uint64_t db::hash_bytes(const uint8_t *data, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::strong_ordering NormalizedKey::operator<=>(const NormalizedKey &other) const {
+    size_t n = std::min(bytes.size(), other.bytes.size());
+    int cmp = std::memcmp(bytes.data(), other.bytes.data(), n);
+    if (cmp != 0) {
+        return cmp < 0 ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+    return bytes.size() <=> other.bytes.size();
+}
+
+KeyDesc::KeyDesc(const TupleDesc &td, const std::vector<size_t> &indices) {
+    if (indices.empty() || indices.size() > MAX_KEY_FIELDS) {
+        throw std::logic_error("Invalid number of key fields");
+    }
+    for (size_t index: indices) {
+        if (index >= td.size()) {
+            throw std::logic_error("Key index out of range");
+        }
+        type_t type = td.type_of(index);
+        fields[count++] = {index, td.offset_of(index), type};
+        width += normalized_size(type);
+    }
+}
+
+size_t KeyDesc::size() const { return count; }
+
+size_t KeyDesc::index(size_t i) const { return fields[i].index; }
+
+size_t KeyDesc::offset(size_t i) const { return fields[i].offset; }
+
+type_t KeyDesc::type(size_t i) const { return fields[i].type; }
+
+size_t KeyDesc::normalizedSize() const { return width; }
+
+NormalizedKey KeyDesc::normalize(const Tuple &t) const {
+    NormalizedKey key{std::string(width, '\0')};
+    auto *out = reinterpret_cast<uint8_t *>(key.bytes.data());
+    for (size_t i = 0; i < count; i++) {
+        const field_t &field = t.get_field(fields[i].index);
+        switch (fields[i].type) {
+            case type_t::INT:
+                normalize_int(out, std::get<int>(field));
+                break;
+            case type_t::DOUBLE:
+                normalize_double(out, std::get<double>(field));
+                break;
+            case type_t::CHAR:
+                normalize_char(out, std::get<std::string>(field).c_str());
+                break;
+            case type_t::VARCHAR:
+            case type_t::DICT:
+                break;
+        }
+        out += normalized_size(fields[i].type);
+    }
+    return key;
+}
+
+NormalizedKey KeyDesc::normalize(const uint8_t *tuple) const {
+    NormalizedKey key{std::string(width, '\0')};
+    auto *out = reinterpret_cast<uint8_t *>(key.bytes.data());
+    for (size_t i = 0; i < count; i++) {
+        normalize_raw(out, tuple + fields[i].offset, fields[i].type);
+        out += normalized_size(fields[i].type);
+    }
+    return key;
+}
+
+int KeyDesc::compare(const uint8_t *tuple, const NormalizedKey &key) const {
+    const auto *probe = reinterpret_cast<const uint8_t *>(key.bytes.data());
+    size_t remaining = key.bytes.size();
+    uint8_t buffer[CHAR_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        size_t size = normalized_size(fields[i].type);
+        normalize_raw(buffer, tuple + fields[i].offset, fields[i].type);
+        size_t n = std::min(size, remaining);
+        int cmp = std::memcmp(buffer, probe, n);
+        if (cmp != 0) {
+            return cmp;
+        }
+        if (n < size) {
+            // The probe is a proper prefix of the tuple key.
+            return 1;
+        }
+        probe += size;
+        remaining -= size;
+    }
+    return remaining == 0 ? 0 : -1;
+}
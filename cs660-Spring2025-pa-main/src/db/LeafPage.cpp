@@ -4,62 +4,284 @@
  #include "db/Tuple.hpp"
 
  #include <algorithm>
+ #include <bit>
+ #include <climits>
  #include <vector>
 
  using namespace db;
 
- LeafPage::LeafPage(Page &page, const TupleDesc &td, size_t key_index)
-     : td(td), key_index(key_index) {
+template<typename Key>
+BasicLeafPage<Key>::BasicLeafPage(Page &page, const TupleDesc &td, size_t key_index)
+    : BasicLeafPage(page, td, KeyDesc(td, {key_index})) {}
+
+template<typename Key>
+BasicLeafPage<Key>::BasicLeafPage(Page &page, const TupleDesc &td, const KeyDesc &kd, bool duplicates,
+                                  bool compressed, size_t page_size)
+     : td(td), kd(kd), duplicates(duplicates), compressed(compressed), page_size(page_size) {
      // 页面布局: [LeafPageHeader | tuple data...]
      header = reinterpret_cast<LeafPageHeader*>(page.data());
      data = page.data() + sizeof(LeafPageHeader);
      // 计算页面可容纳的元组数量
-     capacity = (DEFAULT_PAGE_SIZE - sizeof(LeafPageHeader)) / td.length();
-     if (header->size > capacity) {
-         header->size = 0;
-         header->next_leaf = 0;
+     if (compressed) {
+         // 压缩页布局: [LeafPageHeader | LeafFence | entries...]，容量取决于 fence 的宽度
+         if (td.variable_length() || kd.size() != 1 || kd.type(0) != type_t::INT)
+             throw std::logic_error("Compressed leaves need fixed-length tuples and a single INT key");
+         if (td.length() > DEFAULT_PAGE_SIZE)
+             throw std::logic_error("Compressed tuples must fit the buffer of row");
+         fence = reinterpret_cast<LeafFence *>(data);
+         data += sizeof(LeafFence);
+         layout();
+         // 乐观读可能看到正在修改的页面，这里不能写入；越界的访问由 entry() 截断
+         return;
+     }
+     if (td.variable_length()) {
+         // 变长元组使用槽页布局：data 为槽目录，capacity 只是元组数量的上界
+         if (td.max_length() > DEFAULT_PAGE_SIZE)
+             throw std::logic_error("Variable-length tuples must fit the buffer of row");
+         capacity = (page_size - sizeof(LeafPageHeader)) / (sizeof(Slot) + td.length());
+         slotted.emplace(page, sizeof(LeafPageHeader), header->size, header->start, page_size);
+     } else {
+         capacity = (page_size - sizeof(LeafPageHeader)) / td.length();
      }
+     // 同样不能写入：size 可能超过 capacity 的乐观读由 size() 截断，随后的 validate 会让它重新开始
  }
 
-bool LeafPage::insertTuple(const Tuple &t) {
-     // 提取待插入元组的 key
-     int key = std::get<int>(t.get_field(key_index));
-     int tupleSize = td.length();
-     // 计算 key 在每个元组中的偏移量（假设 TupleDesc 提供 offset_of 方法）
-     size_t key_offset = td.offset_of(key_index);
+template<typename Key>
+LeafFence BasicLeafPage<Key>::bounds() const {
+     LeafFence range = *fence;
+     if (range.high <= range.low)
+         return {INT_MIN, static_cast<int64_t>(INT_MAX) + 1};
+     return range;
+ }
+
+template<typename Key>
+size_t BasicLeafPage<Key>::keyBytes(const LeafFence &range) const {
+     // 只有一个可能的 key 时不需要存储 key
+     uint64_t largest = static_cast<uint64_t>(range.high - 1 - range.low);
+     return (std::bit_width(largest) + 7) / 8;
+ }
+
+template<typename Key>
+size_t BasicLeafPage<Key>::capacityFor(int64_t low, int64_t high) const {
+     LeafFence range = high <= low ? LeafFence{INT_MIN, static_cast<int64_t>(INT_MAX) + 1} : LeafFence{low, high};
+     size_t size = std::max<size_t>(td.length() - INT_SIZE + keyBytes(range), 1);
+     return (page_size - sizeof(LeafPageHeader) - sizeof(LeafFence)) / size;
+ }
+
+template<typename Key>
+void BasicLeafPage<Key>::layout() {
+     LeafFence range = bounds();
+     key_bytes = keyBytes(range);
+     record = std::max<size_t>(td.length() - INT_SIZE + key_bytes, 1);
+     capacity = capacityFor(range.low, range.high);
+ }
+
+template<typename Key>
+uint8_t *BasicLeafPage<Key>::entry(size_t slot) const {
+     return data + std::min<size_t>(slot, capacity - 1) * record;
+ }
+
+template<typename Key>
+int BasicLeafPage<Key>::decodeKey(size_t slot) const {
+     // 小端存储的 key - low
+     uint64_t delta = 0;
+     std::memcpy(&delta, entry(slot), key_bytes);
+     return static_cast<int>(bounds().low + static_cast<int64_t>(delta));
+ }
+
+template<typename Key>
+void BasicLeafPage<Key>::encode(size_t slot, const uint8_t *row) {
+     size_t offset = kd.offset(0);
+     int key;
+     std::memcpy(&key, row + offset, INT_SIZE);
+     uint64_t delta = static_cast<uint64_t>(key - bounds().low);
+     uint8_t *bytes = entry(slot);
+     std::memcpy(bytes, &delta, key_bytes);
+     std::memcpy(bytes + key_bytes, row, offset);
+     std::memcpy(bytes + key_bytes + offset, row + offset + INT_SIZE, td.length() - offset - INT_SIZE);
+ }
+
+template<typename Key>
+void BasicLeafPage<Key>::decode(size_t slot, uint8_t *row) const {
+     size_t offset = kd.offset(0);
+     int key = decodeKey(slot);
+     const uint8_t *bytes = entry(slot);
+     std::memcpy(row, bytes + key_bytes, offset);
+     std::memcpy(row + offset, &key, INT_SIZE);
+     std::memcpy(row + offset + INT_SIZE, bytes + key_bytes + offset, td.length() - offset - INT_SIZE);
+ }
+
+template<typename Key>
+void BasicLeafPage<Key>::setFence(int64_t low, int64_t high) {
+     // 按新的宽度重新编码所有元组
+     size_t size = header->size;
+     std::vector<uint8_t> rows(size * td.length());
+     for (size_t i = 0; i < size; i++)
+         decode(i, rows.data() + i * td.length());
+     *fence = {low, high};
+     layout();
+     for (size_t i = 0; i < size; i++)
+         encode(i, rows.data() + i * td.length());
+ }
+
+template<typename Key>
+size_t BasicLeafPage<Key>::size() const {
+     return std::min<size_t>(header->size, capacity);
+ }
+
+template<typename Key>
+const uint8_t *BasicLeafPage<Key>::tuple(size_t slot) const {
+     if (compressed)
+         throw std::logic_error("Compressed leaves have no serialized tuples");
+     return slotted ? slotted->tuple(slot) : data + slot * td.length();
+ }
+
+template<typename Key>
+const uint8_t *BasicLeafPage<Key>::row(size_t slot, Page &buffer) const {
+     if (slotted) {
+         // 乐观读可能看到写了一半的槽：先检查它落在页内再复制，越界的槽得到一个空元组，随后的 validate 会丢弃它
+         Slot entry = slotted->slots[std::min<size_t>(slot, capacity - 1)];
+         size_t begin = sizeof(LeafPageHeader) + size() * sizeof(Slot);
+         if (entry.offset < begin || entry.offset + entry.length > page_size || entry.length > td.max_length()) {
+             std::memset(buffer.data(), 0, td.max_length());
+             return buffer.data();
+         }
+         std::memcpy(buffer.data(), reinterpret_cast<const uint8_t *>(header) + entry.offset, entry.length);
+         return buffer.data();
+     }
+     if (!compressed)
+         return tuple(slot);
+     decode(slot, buffer.data());
+     return buffer.data();
+ }
+
+template<typename Key>
+int BasicLeafPage<Key>::compare(size_t slot, const key_type &key) const {
+     if constexpr (std::is_same_v<Key, int>) {
+         if (compressed) {
+             int k = decodeKey(slot);
+             return (k > key) - (k < key);
+         }
+     }
+     return KeyTraits<Key>::compare(tuple(slot), key, kd);
+ }
+
+template<typename Key>
+typename BasicLeafPage<Key>::key_type BasicLeafPage<Key>::key(size_t slot) const {
+     if constexpr (std::is_same_v<Key, int>) {
+         if (compressed)
+             return decodeKey(slot);
+     }
+     return KeyTraits<Key>::extract(tuple(slot), kd);
+ }
+
+template<typename Key>
+bool BasicLeafPage<Key>::nearlyFull() const {
+     if (slotted) {
+         // 插入一个最长的元组之后，是否仍能容纳下一个最长的元组
+         return slotted->freeSpace(2) < 2 * td.max_length();
+     }
+     return header->size >= capacity - 1;
+ }
 
-     // 二分查找：确定应插入的位置 low
-     size_t low = 0, high = header->size;
+template<typename Key>
+bool BasicLeafPage<Key>::full() const {
+     if (slotted) {
+         return header->size >= capacity || slotted->freeSpace(1) < td.max_length();
+     }
+     return header->size == capacity;
+ }
+
+template<typename Key>
+size_t BasicLeafPage<Key>::lowerBound(const key_type &key) const {
+     // 二分查找：确定第一个 key 不小于目标 key 的位置
+     size_t low = 0, high = size();
      while (low < high) {
          size_t mid = (low + high) / 2;
-         int midKey = *reinterpret_cast<int*>(data + mid * tupleSize + key_offset);
-         if (midKey < key)
+         if (compare(mid, key) < 0)
              low = mid + 1;
          else
              high = mid;
      }
-     size_t pos = low;
-     // 若在 pos 处存在相同的 key，则更新已有元组
-     if (pos < header->size) {
-         int currKey = *reinterpret_cast<int*>(data + pos * tupleSize + key_offset);
-         if (currKey == key) {
-             td.serialize(data + pos * tupleSize, t);
-             return (header->size == capacity);
+     return low;
+ }
+
+template<typename Key>
+size_t BasicLeafPage<Key>::upperBound(const key_type &key) const {
+     size_t low = 0, high = size();
+     while (low < high) {
+         size_t mid = (low + high) / 2;
+         if (compare(mid, key) <= 0)
+             low = mid + 1;
+         else
+             high = mid;
+     }
+     return low;
+ }
+
+template<typename Key>
+bool BasicLeafPage<Key>::insertTuple(const Tuple &t) {
+     // 提取待插入元组的 key
+     key_type key = KeyTraits<Key>::extract(t, kd);
+     size_t tupleSize = td.length();
+
+     // 二分查找：确定应插入的位置（允许重复键时插入到相同键之后）
+     size_t pos = duplicates ? upperBound(key) : lowerBound(key);
+     if (slotted) {
+         // 槽页：只移动槽目录，元组写入页尾的空闲空间
+         size_t length = td.length(t);
+         bool replace = !duplicates && pos < header->size && KeyTraits<Key>::compare(tuple(pos), key, kd) == 0;
+         if (!replace && header->size >= capacity)
+             return false;
+         // 被替换元组的空间成为空洞，压缩页面时回收
+         uint8_t *bytes = slotted->allocate(length, !replace);
+         if (!bytes)
+             return false;
+         td.serialize(bytes, t);
+         if (!replace) {
+             std::memmove(slotted->slots + pos + 1, slotted->slots + pos, (header->size - pos) * sizeof(Slot));
+             header->size++;
+         }
+         slotted->slots[pos] = {static_cast<uint16_t>(bytes - reinterpret_cast<uint8_t *>(header)),
+                                static_cast<uint16_t>(length)};
+         return full();
+     }
+     if (compressed) {
+         // 压缩页：key 必须落在 fence 内，元组先序列化再编码
+         LeafFence range = bounds();
+         if constexpr (std::is_same_v<Key, int>) {
+             if (key < range.low || key >= range.high)
+                 throw std::logic_error("Key outside the range of the leaf");
+         }
+         Page row;
+         td.serialize(row.data(), t);
+         if (!duplicates && pos < header->size && compare(pos, key) == 0) {
+             encode(pos, row.data());
+             return full();
          }
+         if (header->size >= capacity)
+             return false;
+         std::memmove(data + (pos + 1) * record, data + pos * record, (header->size - pos) * record);
+         encode(pos, row.data());
+         header->size++;
+         return full();
+     }
+     // 若在 pos 处存在相同的 key，则更新已有元组
+     if (!duplicates && pos < header->size && KeyTraits<Key>::compare(data + pos * tupleSize, key, kd) == 0) {
+         td.serialize(data + pos * tupleSize, t);
+         return full();
      }
      // 如果页面已满，则无法插入（调用者会处理分裂）
      if (header->size >= capacity)
          return false;
      // 将 pos 后的数据向后移动，为新元组腾出空间
-     for (int i = header->size; i > static_cast<int>(pos); i--) {
-         std::memmove(data + i * tupleSize,
-                      data + (i - 1) * tupleSize,
-                      tupleSize);
-     }
+     std::memmove(data + (pos + 1) * tupleSize,
+                  data + pos * tupleSize,
+                  (header->size - pos) * tupleSize);
      // 写入新元组
      td.serialize(data + pos * tupleSize, t);
      header->size++;
-     return (header->size == capacity);
+     return full();
  }
 
 
@@ -71,34 +293,134 @@ bool LeafPage::insertTuple(const Tuple &t) {
   *  - 当前页的 size 调整为前半部分，
   *  - 返回 new_page 中第一个元组的 key 作为分隔键。
   */
- int LeafPage::split(LeafPage &new_page) {
+template<typename Key>
+typename BasicLeafPage<Key>::key_type BasicLeafPage<Key>::split(BasicLeafPage &new_page) {
      int total = header->size;
      int mid = total / 2;
-     new_page.header->size = total - mid;
-     std::memcpy(new_page.data,
-                 data + mid * td.length(),
-                 (total - mid) * td.length());
+     if (slotted) {
+         // 按字节数而不是元组数平分
+         size_t bytes = 0;
+         for (int i = 0; i < total; i++)
+             bytes += slotted->slots[i].length;
+         size_t half = 0;
+         mid = 0;
+         while (mid < total - 1 && half < bytes / 2)
+             half += slotted->slots[mid++].length;
+         mid = std::max(mid, 1);
+     }
+     if (duplicates) {
+         // 寻找离中点最近的键边界，避免把一串相同的键拆到两页
+         auto boundary = [&](int i) {
+             return i > 0 && i < total &&
+                    compare(i, key(i - 1)) != 0;
+         };
+         for (int d = 0; d <= total / 4; d++) {
+             if (boundary(mid - d)) {
+                 mid -= d;
+                 break;
+             }
+             if (boundary(mid + d)) {
+                 mid += d;
+                 break;
+             }
+         }
+     }
+     if (slotted) {
+         // 逐个复制后半部分的元组，再压缩当前页以回收空间
+         new_page.clear();
+         for (int i = mid; i < total; i++) {
+             Slot slot = slotted->slots[i];
+             uint8_t *bytes = new_page.slotted->allocate(slot.length, true);
+             std::memcpy(bytes, slotted->tuple(i), slot.length);
+             new_page.slotted->slots[i - mid] = {
+                 static_cast<uint16_t>(bytes - reinterpret_cast<uint8_t *>(new_page.header)), slot.length};
+             new_page.header->size++;
+         }
+         header->size = mid;
+         slotted->compact();
+     } else if (compressed) {
+         // 两页各自按更窄的 fence 重新编码：当前页 [low, split)，新页 [split, high)
+         std::vector<uint8_t> rows(total * td.length());
+         for (int i = 0; i < total; i++)
+             decode(i, rows.data() + i * td.length());
+         LeafFence range = bounds();
+         int64_t split = decodeKey(mid);
+         // 先缩小 size 再缩小 fence，使并发的乐观读者始终看到 size <= capacity
+         header->size = mid;
+         *fence = {range.low, split};
+         layout();
+         for (int i = 0; i < mid; i++)
+             encode(i, rows.data() + i * td.length());
+         new_page.header->size = 0;
+         *new_page.fence = {split, range.high};
+         new_page.layout();
+         for (int i = mid; i < total; i++)
+             new_page.encode(i - mid, rows.data() + i * td.length());
+         new_page.header->size = total - mid;
+     } else {
+         new_page.header->size = total - mid;
+         std::memcpy(new_page.data,
+                     data + mid * td.length(),
+                     (total - mid) * td.length());
+         header->size = mid;
+     }
      // 新页继承原页的 next_leaf 指针
      new_page.header->next_leaf = header->next_leaf;
-     header->size = mid;
-     Tuple firstTuple = new_page.getTuple(0);
-     int splitKey = std::get<int>(firstTuple.get_field(key_index));
-     return splitKey;
+     return new_page.key(0);
+ }
+
+template<typename Key>
+void BasicLeafPage<Key>::remove(size_t slot) {
+     if (slot >= header->size)
+          throw std::runtime_error("Slot not occupied");
+     if (slotted) {
+         // 元组的空间成为空洞，压缩页面时回收
+         std::memmove(slotted->slots + slot, slotted->slots + slot + 1, (header->size - slot - 1) * sizeof(Slot));
+         if (--header->size == 0)
+             header->start = 0;
+         return;
+     }
+     size_t tupleSize = compressed ? record : td.length();
+     std::memmove(data + slot * tupleSize,
+                  data + (slot + 1) * tupleSize,
+                  (header->size - slot - 1) * tupleSize);
+     header->size--;
  }
 
  /*
   * 反序列化指定 slot 处的元组。
   */
- Tuple LeafPage::getTuple(size_t slot) const {
+template<typename Key>
+Tuple BasicLeafPage<Key>::getTuple(size_t slot) const {
      if (slot >= header->size)
           throw std::runtime_error("Slot not occupied");
-     return td.deserialize(data + slot * td.length());
+     Page buffer;
+     return td.deserialize(row(slot, buffer));
+ }
+
+template<typename Key>
+TupleView BasicLeafPage<Key>::getView(size_t slot) const {
+     if (slot >= header->size)
+          throw std::runtime_error("Slot not occupied");
+     if (compressed)
+         throw std::logic_error("Compressed leaves have no views, see row");
+     return {td, tuple(slot)};
  }
 
  /*
   * 清空叶页，用于分裂时先清空页面后重新插入排好序的元组。
   */
- void LeafPage::clear() {
+template<typename Key>
+void BasicLeafPage<Key>::clear() {
      header->size = 0;
+     header->start = 0;
+     if (compressed) {
+         *fence = {};
+         layout();
+     }
      // 注意：next_leaf 可以保留原值（由上层更新链表）或置 0，视具体设计而定
  }
+
+template struct db::BasicLeafPage<int>;
+template struct db::BasicLeafPage<double>;
+template struct db::BasicLeafPage<NormalizedKey>;
@@ -0,0 +1,77 @@
+#include <db/Database.hpp>
+#include <db/PaxFile.hpp>
+#include <db/PaxPage.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+PaxFile::PaxFile(const std::string &name, const TupleDesc &td)
+    : DbFile(name, td, DEFAULT_PAGE_SIZE, {.format = 'P', .key_indices = {}, .root = 0}) {
+    if (td.variable_length()) {
+        throw std::logic_error("PAX pages only hold fixed-length tuples");
+    }
+}
+
+void PaxFile::insertTuple(const Tuple &t) {
+    if (!td.compatible(t)) {
+        throw std::runtime_error("Tuple not compatible with TupleDesc");
+    }
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PageId pid{name, numPages - 1};
+    if (!PaxPage(bufferPool.getPage(pid), td).insertTuple(t)) {
+        pid.page = numPages++;
+        PaxPage(bufferPool.getPage(pid), td).insertTuple(t);
+    }
+    bufferPool.markDirty(pid);
+}
+
+void PaxFile::deleteTuple(const Iterator &it) {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PageId pid{name, it.page};
+    PaxPage(bufferPool.getPage(pid), td).deleteTuple(it.slot);
+    bufferPool.markDirty(pid);
+}
+
+void PaxFile::scanColumn(size_t field, const std::function<void(const uint8_t *value)> &callback) const {
+    if (field >= td.size()) {
+        throw std::out_of_range("Field out of range");
+    }
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    for (size_t page = 0; page < numPages; page++) {
+        // The page stays pinned while the callback runs.
+        PinnedPage pinned(bufferPool, {name, page});
+        const PaxPage pp(*pinned, td);
+        const uint8_t *values = pp.column(field);
+        size_t width = pp.width(field);
+        for (size_t slot = pp.begin(); slot != pp.end(); pp.next(slot)) {
+            callback(values + slot * width);
+        }
+    }
+}
+
+Tuple PaxFile::getTuple(const Iterator &it) const {
+    return PaxPage(getDatabase().getBufferPool().getPage({name, it.page}), td).getTuple(it.slot);
+}
+
+void PaxFile::next(Iterator &it) const {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    while (it.page < numPages) {
+        const PaxPage pp(bufferPool.getPage({name, it.page}), td);
+        pp.next(it.slot);
+        if (it.slot != pp.end()) {
+            return;
+        }
+        it.page++;
+        // Start before the first slot of the next page.
+        it.slot = -1;
+    }
+    it.slot = 0;
+}
+
+Iterator PaxFile::begin() const {
+    Iterator it{*this, 0, static_cast<size_t>(-1)};
+    next(it);
+    return it;
+}
+
+Iterator PaxFile::end() const { return {*this, numPages, 0}; }
@@ -0,0 +1,82 @@
+#include <db/PaxPage.hpp>
+#include <cstring>
+#include <stdexcept>
+
+using namespace db;
+
+PaxPage::PaxPage(Page &page, const TupleDesc &td) : td(td) {
+    if (td.variable_length()) {
+        throw std::logic_error("PAX pages only hold fixed-length tuples");
+    }
+    capacity = DEFAULT_PAGE_SIZE * 8 / (td.length() * 8 + 1);
+    header = page.data();
+    data = header + DEFAULT_PAGE_SIZE - td.length() * capacity;
+}
+
+size_t PaxPage::begin() const {
+    size_t slot = 0;
+    if (empty(slot)) {
+        next(slot);
+    }
+    return slot;
+}
+
+size_t PaxPage::end() const { return capacity; }
+
+bool PaxPage::insertTuple(const Tuple &t, size_t *inserted) {
+    size_t slot = 0;
+    while (slot < capacity && !empty(slot)) {
+        slot++;
+    }
+    if (slot == capacity) {
+        return false;
+    }
+    // Serialize the row once, then scatter its fields to the minipages.
+    Page row;
+    td.serialize(row.data(), t);
+    for (size_t i = 0; i < td.size(); i++) {
+        std::memcpy(data + capacity * td.offset_of(i) + slot * width(i), row.data() + td.offset_of(i), width(i));
+    }
+    header[slot / 8] |= 1 << (7 - slot % 8);
+    if (inserted) {
+        *inserted = slot;
+    }
+    return true;
+}
+
+void PaxPage::deleteTuple(size_t slot) {
+    if (slot >= capacity) {
+        throw std::runtime_error("Out of index");
+    }
+    if (empty(slot)) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    header[slot / 8] &= ~(1 << (7 - slot % 8));
+}
+
+bool PaxPage::empty(size_t slot) const { return !(header[slot / 8] & (1 << (7 - slot % 8))); }
+
+Tuple PaxPage::getTuple(size_t slot) const {
+    if (slot >= capacity || empty(slot)) {
+        throw std::runtime_error("Slot not occupied");
+    }
+    // Gather the fields into a row, then deserialize it.
+    Page row;
+    for (size_t i = 0; i < td.size(); i++) {
+        std::memcpy(row.data() + td.offset_of(i), column(i) + slot * width(i), width(i));
+    }
+    return td.deserialize(row.data());
+}
+
+void PaxPage::next(size_t &slot) const {
+    while (++slot < capacity && empty(slot));
+}
+
+const uint8_t *PaxPage::column(size_t field) const { return data + capacity * td.offset_of(field); }
+
+size_t PaxPage::width(size_t field) const {
+    size_t end = field + 1 < td.size() ? td.offset_of(field + 1) : td.length();
+    return end - td.offset_of(field);
+}
+
+const uint8_t *PaxPage::bitmap() const { return header; }
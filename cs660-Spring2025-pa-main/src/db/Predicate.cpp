@@ -0,0 +1,53 @@
+#include <db/Predicate.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+void Predicate::check(const TupleDesc &td) const {
+    if (field >= td.size()) {
+        throw std::logic_error("Predicate field out of range");
+    }
+    type_t type = td.type_of(field);
+    bool compatible = (type == type_t::INT && std::holds_alternative<int>(value)) ||
+                      (type == type_t::DOUBLE && std::holds_alternative<double>(value)) ||
+                      ((type == type_t::CHAR || type == type_t::VARCHAR || type == type_t::DICT) &&
+                       std::holds_alternative<std::string>(value));
+    if (!compatible) {
+        throw std::logic_error("Predicate value does not match the field type");
+    }
+}
+
+bool Predicate::matches(const Tuple &t) const { return compare(op, t.get_field(field), value); }
+
+bool Predicate::matches(const TupleView &t) const {
+    switch (t.field_type(field)) {
+        case type_t::INT:
+            return compare(op, t.getInt(field), std::get<int>(value));
+        case type_t::DOUBLE:
+            return compare(op, t.getDouble(field), std::get<double>(value));
+        case type_t::CHAR:
+        case type_t::VARCHAR:
+        case type_t::DICT:
+            return compare(op, t.getString(field), std::string_view(std::get<std::string>(value)));
+    }
+    return false;
+}
+
+bool Predicate::mayMatch(double min, double max) const {
+    double v = std::holds_alternative<int>(value) ? std::get<int>(value) : std::get<double>(value);
+    switch (op) {
+        case op_t::EQ:
+            return min <= v && v <= max;
+        case op_t::NE:
+            return !(min == v && max == v);
+        case op_t::LT:
+            return min < v;
+        case op_t::LE:
+            return min <= v;
+        case op_t::GT:
+            return max > v;
+        case op_t::GE:
+            return max >= v;
+    }
+    return true;
+}
@@ -0,0 +1,139 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/HeapPage.hpp>
+#include <db/SecondaryIndex.hpp>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+    std::vector<size_t> allFields(size_t n) {
+        std::vector<size_t> indices(n);
+        std::iota(indices.begin(), indices.end(), 0);
+        return indices;
+    }
+
+    TupleDesc entryDesc(const TupleDesc &td, const std::vector<size_t> &key_indices) {
+        std::vector<type_t> types;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < key_indices.size(); i++) {
+            if (key_indices[i] >= td.size()) {
+                throw std::logic_error("Key index out of range");
+            }
+            types.push_back(td.type_of(key_indices[i]));
+            names.push_back("key" + std::to_string(i));
+        }
+        types.insert(types.end(), {type_t::INT, type_t::INT});
+        names.insert(names.end(), {"page", "slot"});
+        return {types, names};
+    }
+} // namespace
+
+SecondaryIndex::SecondaryIndex(const std::string &name, HeapFile &heap, const std::vector<size_t> &key_indices)
+    : BasicBTreeFile(name, entryDesc(heap.getTupleDesc(), key_indices), allFields(key_indices.size() + 2)),
+      heap(heap), key_indices(key_indices) {}
+
+HeapFile &SecondaryIndex::getHeapFile() const { return heap; }
+
+const std::vector<size_t> &SecondaryIndex::getKeyIndices() const { return key_indices; }
+
+Tuple SecondaryIndex::entry(const Tuple &t, const RecordId &rid) const {
+    std::vector<field_t> fields;
+    for (size_t index: key_indices) {
+        fields.push_back(t.get_field(index));
+    }
+    fields.emplace_back(static_cast<int>(rid.page));
+    fields.emplace_back(static_cast<int>(rid.slot));
+    return {fields};
+}
+
+RecordId SecondaryIndex::recordId(const Tuple &entry) const {
+    size_t n = key_indices.size();
+    return {static_cast<size_t>(std::get<int>(entry.get_field(n))),
+            static_cast<size_t>(std::get<int>(entry.get_field(n + 1)))};
+}
+
+KeyDesc SecondaryIndex::prefix(const Tuple &key) const {
+    if (key.size() == 0 || key.size() > key_indices.size()) {
+        throw std::logic_error("Key not compatible with the index");
+    }
+    for (size_t i = 0; i < key.size(); i++) {
+        if (key.field_type(i) != td.type_of(i)) {
+            throw std::logic_error("Key not compatible with the index");
+        }
+    }
+    return {td, allFields(key.size())};
+}
+
+void SecondaryIndex::build() {
+    std::vector<std::pair<NormalizedKey, Tuple>> entries;
+    for (auto it = heap.begin(); it != heap.end(); ++it) {
+        Tuple e = entry(*it, {it.page, it.slot});
+        entries.emplace_back(getKeyDesc().normalize(e), std::move(e));
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    std::vector<Tuple> sorted;
+    sorted.reserve(entries.size());
+    for (auto &[key, e]: entries) {
+        sorted.push_back(std::move(e));
+    }
+    bulkLoad(sorted);
+}
+
+void SecondaryIndex::insertEntry(const Tuple &t, const RecordId &rid) { insertTuple(entry(t, rid)); }
+
+bool SecondaryIndex::deleteEntry(const Tuple &t, const RecordId &rid) {
+    return erase(getKeyDesc().normalize(entry(t, rid)));
+}
+
+std::vector<RecordId> SecondaryIndex::lookupIds(const Tuple &key) const {
+    KeyDesc kd_prefix = prefix(key);
+    NormalizedKey normalized = kd_prefix.normalize(key);
+    std::vector<RecordId> rids;
+    for (auto it = lowerBound(normalized); it != end(); ++it) {
+        Tuple e = *it;
+        if (kd_prefix.normalize(e) != normalized) {
+            break;
+        }
+        rids.push_back(recordId(e));
+    }
+    return rids;
+}
+
+std::vector<Tuple> SecondaryIndex::fetch(std::vector<RecordId> &rids) const {
+    std::sort(rids.begin(), rids.end());
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    std::vector<Tuple> tuples;
+    tuples.reserve(rids.size());
+    for (size_t i = 0; i < rids.size();) {
+        // Read all the matches on a page while it is at hand.
+        size_t page = rids[i].page;
+        HeapPage hp(bufferPool.getPage({heap.getName(), page}), heap.getTupleDesc());
+        for (; i < rids.size() && rids[i].page == page; i++) {
+            tuples.push_back(hp.getTuple(rids[i].slot));
+        }
+    }
+    return tuples;
+}
+
+std::vector<Tuple> SecondaryIndex::lookup(const Tuple &key) const {
+    std::vector<RecordId> rids = lookupIds(key);
+    return fetch(rids);
+}
+
+std::vector<Tuple> SecondaryIndex::range(const Tuple &low, const Tuple &high) const {
+    KeyDesc kd_low = prefix(low);
+    KeyDesc kd_high = prefix(high);
+    NormalizedKey high_key = kd_high.normalize(high);
+    std::vector<RecordId> rids;
+    for (auto it = lowerBound(kd_low.normalize(low)); it != end(); ++it) {
+        Tuple e = *it;
+        if (kd_high.normalize(e) > high_key) {
+            break;
+        }
+        rids.push_back(recordId(e));
+    }
+    return fetch(rids);
+}
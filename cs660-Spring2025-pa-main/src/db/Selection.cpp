@@ -0,0 +1,195 @@
+#include <db/Selection.hpp>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define DB_SELECTION_AVX2 1
+#endif
+
+using namespace db;
+
+namespace {
+    template<typename T>
+    void filterScalar(uint64_t *words, const uint8_t *values, size_t stride, size_t from, size_t size, op_t op,
+                      T constant) {
+        for (size_t s = from; s < size; s++) {
+            uint64_t bit = uint64_t{1} << (s % 64);
+            if (!(words[s / 64] & bit)) {
+                continue;
+            }
+            T value;
+            std::memcpy(&value, values + s * stride, sizeof(T));
+            if (!compare(op, value, constant)) {
+                words[s / 64] &= ~bit;
+            }
+        }
+    }
+
+#ifdef DB_SELECTION_AVX2
+    bool hasAvx2() {
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+    }
+
+    // Blocks of 8 slots never straddle two words, and only blocks with a selected slot are loaded. The last
+    // `size % 8` slots are left to the scalar loop so that no gather reads past the last value.
+
+    __attribute__((target("avx2"))) size_t filterInts(uint64_t *words, const uint8_t *values, size_t stride,
+                                                      size_t size, op_t op, int constant) {
+        const __m256i c = _mm256_set1_epi32(constant);
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                   _mm256_set1_epi32(static_cast<int>(stride)));
+        // NE, LE and GE are the complements of EQ, GT and LT.
+        bool negate = op == op_t::NE || op == op_t::LE || op == op_t::GE;
+        size_t s = 0;
+        for (; s + 8 <= size; s += 8) {
+            uint64_t &word = words[s / 64];
+            size_t shift = s % 64;
+            if (!((word >> shift) & 0xff)) {
+                continue;
+            }
+            __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int *>(values + s * stride), offsets, 1);
+            __m256i r;
+            switch (op) {
+                case op_t::EQ:
+                case op_t::NE:
+                    r = _mm256_cmpeq_epi32(v, c);
+                    break;
+                case op_t::GT:
+                case op_t::LE:
+                    r = _mm256_cmpgt_epi32(v, c);
+                    break;
+                case op_t::LT:
+                case op_t::GE:
+                    r = _mm256_cmpgt_epi32(c, v);
+                    break;
+            }
+            uint64_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(r)));
+            if (negate) {
+                mask = ~mask & 0xff;
+            }
+            word &= ~((~mask & 0xff) << shift);
+        }
+        return s;
+    }
+
+    template<int Compare>
+    __attribute__((target("avx2"))) size_t filterDoubles(uint64_t *words, const uint8_t *values, size_t stride,
+                                                         size_t size, double constant) {
+        const __m256d c = _mm256_set1_pd(constant);
+        const __m128i offsets = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(stride)));
+        size_t s = 0;
+        for (; s + 8 <= size; s += 8) {
+            uint64_t &word = words[s / 64];
+            size_t shift = s % 64;
+            if (!((word >> shift) & 0xff)) {
+                continue;
+            }
+            const auto *base = reinterpret_cast<const double *>(values + s * stride);
+            const auto *half = reinterpret_cast<const double *>(values + (s + 4) * stride);
+            __m256d low = _mm256_i32gather_pd(base, offsets, 1);
+            __m256d high = _mm256_i32gather_pd(half, offsets, 1);
+            uint64_t mask = _mm256_movemask_pd(_mm256_cmp_pd(low, c, Compare)) |
+                            _mm256_movemask_pd(_mm256_cmp_pd(high, c, Compare)) << 4;
+            word &= ~((~mask & 0xff) << shift);
+        }
+        return s;
+    }
+
+    size_t filterDoubles(uint64_t *words, const uint8_t *values, size_t stride, size_t size, op_t op,
+                         double constant) {
+        // NE is unordered so that NaN != x holds, as it does for the scalar comparison.
+        switch (op) {
+            case op_t::EQ:
+                return filterDoubles<_CMP_EQ_OQ>(words, values, stride, size, constant);
+            case op_t::NE:
+                return filterDoubles<_CMP_NEQ_UQ>(words, values, stride, size, constant);
+            case op_t::LT:
+                return filterDoubles<_CMP_LT_OQ>(words, values, stride, size, constant);
+            case op_t::LE:
+                return filterDoubles<_CMP_LE_OQ>(words, values, stride, size, constant);
+            case op_t::GT:
+                return filterDoubles<_CMP_GT_OQ>(words, values, stride, size, constant);
+            case op_t::GE:
+                return filterDoubles<_CMP_GE_OQ>(words, values, stride, size, constant);
+        }
+        return 0;
+    }
+#endif
+} // namespace
+
+Selection::Selection(const uint8_t *bitmap, size_t size) : words((size + 63) / 64), slots(size) {
+    for (size_t s = 0; s < size; s++) {
+        if (bitmap[s / 8] & (1 << (7 - s % 8))) {
+            words[s / 64] |= uint64_t{1} << (s % 64);
+        }
+    }
+}
+
+bool Selection::vectorizable(const Predicate &p) {
+    return std::holds_alternative<int>(p.value) || std::holds_alternative<double>(p.value);
+}
+
+void Selection::filter(const Predicate &p, const uint8_t *values, size_t stride) {
+    if (!vectorizable(p)) {
+        throw std::logic_error("Predicate cannot be evaluated on a column");
+    }
+    size_t from = 0;
+    if (std::holds_alternative<int>(p.value)) {
+        int constant = std::get<int>(p.value);
+#ifdef DB_SELECTION_AVX2
+        if (hasAvx2()) {
+            from = filterInts(words.data(), values, stride, slots, p.op, constant);
+        }
+#endif
+        filterScalar(words.data(), values, stride, from, slots, p.op, constant);
+    } else {
+        double constant = std::get<double>(p.value);
+#ifdef DB_SELECTION_AVX2
+        if (hasAvx2()) {
+            from = filterDoubles(words.data(), values, stride, slots, p.op, constant);
+        }
+#endif
+        filterScalar(words.data(), values, stride, from, slots, p.op, constant);
+    }
+}
+
+void Selection::filterCode(uint32_t code, bool equal, const uint8_t *values, size_t stride, size_t width) {
+    size_t from = 0;
+#ifdef DB_SELECTION_AVX2
+    if (width == sizeof(int) && hasAvx2()) {
+        from = filterInts(words.data(), values, stride, slots, equal ? op_t::EQ : op_t::NE, static_cast<int>(code));
+    }
+#endif
+    for (size_t s = from; s < slots; s++) {
+        uint64_t bit = uint64_t{1} << (s % 64);
+        if (!(words[s / 64] & bit)) {
+            continue;
+        }
+        uint32_t value = 0;
+        std::memcpy(&value, values + s * stride, width);
+        if ((value == code) != equal) {
+            words[s / 64] &= ~bit;
+        }
+    }
+}
+
+bool Selection::test(size_t slot) const { return words[slot / 64] & (uint64_t{1} << (slot % 64)); }
+
+size_t Selection::count() const {
+    size_t n = 0;
+    for (uint64_t word: words) {
+        n += std::popcount(word);
+    }
+    return n;
+}
+
+bool Selection::none() const {
+    for (uint64_t word: words) {
+        if (word != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#include <db/SlottedPage.hpp>
+#include <cstring>
+#include <vector>
+
+using namespace db;
+
+SlottedPage::SlottedPage(Page &page, size_t header_size, uint16_t &count, uint16_t &start, size_t page_size)
+    : page(page.data()), page_size(page_size), header_size(header_size), count(count), start(start),
+      slots(reinterpret_cast<Slot *>(page.data() + header_size)) {}
+
+size_t SlottedPage::tuplesBegin() const { return start == 0 ? page_size : start; }
+
+uint8_t *SlottedPage::tuple(size_t slot) const { return page + slots[slot].offset; }
+
+size_t SlottedPage::freeSpace(size_t new_slots) const {
+    size_t used = header_size + (count + new_slots) * sizeof(Slot);
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].offset != 0) {
+            used += slots[i].length;
+        }
+    }
+    return used < page_size ? page_size - used : 0;
+}
+
+uint8_t *SlottedPage::allocate(size_t length, bool new_slot) {
+    size_t directory_end = header_size + (count + new_slot) * sizeof(Slot);
+    if (tuplesBegin() < directory_end + length) {
+        if (freeSpace(new_slot) < length) {
+            return nullptr;
+        }
+        compact();
+    }
+    start = static_cast<uint16_t>(tuplesBegin() - length);
+    return page + start;
+}
+
+void SlottedPage::compact() {
+    std::vector<uint8_t> copy(page, page + page_size);
+    size_t end = page_size;
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].offset == 0) {
+            continue;
+        }
+        end -= slots[i].length;
+        std::memcpy(page + end, copy.data() + slots[i].offset, slots[i].length);
+        slots[i].offset = static_cast<uint16_t>(end);
+    }
+    start = end == page_size ? 0 : static_cast<uint16_t>(end);
+}
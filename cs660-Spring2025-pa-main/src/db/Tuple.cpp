@@ -1,11 +1,36 @@
+#include <algorithm>
 #include <cstring>
+#include <db/Dictionary.hpp>
 #include <db/Tuple.hpp>
 #include <stdexcept>
 
 using namespace db;
 
+namespace {
+    /// Read the VARCHAR value whose offset is stored at `slot`, in a tuple of at most `limit` bytes
+    std::string_view varchar(const uint8_t *tuple, const uint8_t *slot, size_t limit) {
+        uint16_t offset, length;
+        std::memcpy(&offset, slot, sizeof(offset));
+        // Pages may be read optimistically while they change, so never read further than a valid tuple could be.
+        size_t begin = std::min<size_t>(offset, limit - sizeof(length));
+        std::memcpy(&length, tuple + begin, sizeof(length));
+        begin += sizeof(length);
+        return {reinterpret_cast<const char *>(tuple + begin), std::min<size_t>({length, VARCHAR_SIZE, limit - begin})};
+    }
+
+    void assign(field_t &field, std::string_view value) {
+        if (auto *s = std::get_if<std::string>(&field)) {
+            s->assign(value);
+        } else {
+            field = std::string(value);
+        }
+    }
+} // namespace
+
 Tuple::Tuple(const std::vector<field_t> &fields) : fields(fields) {}
 
+Tuple::Tuple(std::vector<field_t> &&fields) noexcept : fields(std::move(fields)) {}
+
 type_t Tuple::field_type(size_t i) const {
     const field_t &field = fields.at(i);
     if (std::holds_alternative<int>(field)) {
@@ -24,15 +49,38 @@ size_t Tuple::size() const { return fields.size(); }
 
 const field_t &Tuple::get_field(size_t i) const { return fields.at(i); }
 
+void Tuple::set_field(size_t i, const field_t &value) {
+    field_t &field = fields.at(i);
+    if (const auto *s = std::get_if<std::string>(&value)) {
+        assign(field, *s);
+    } else {
+        field = value;
+    }
+}
+
 TupleDesc::TupleDesc(const std::vector<type_t> &types, const std::vector<std::string> &names) : types(types) {
     // TODO pa1
     if (types.size() != names.size()) {
         throw std::logic_error("Types and names sizes do not match");
     }
+    for (size_t i = 0; i < types.size(); i++) {
+        if (types[i] == type_t::DICT) {
+            throw std::logic_error("DICT fields are created with withDictionary");
+        }
+        name_to_index[names[i]] = i;
+    }
+    if (name_to_index.size() != names.size()) {
+        throw std::logic_error("Duplicate name");
+    }
+    layout();
+}
+
+void TupleDesc::layout() {
     size_t offset = 0;
+    offsets.clear();
+    varchars = 0;
     for (size_t i = 0; i < types.size(); i++) {
         offsets.push_back(offset);
-        name_to_index[names[i]] = i;
         switch (types[i]) {
             case type_t::INT:
                 offset += INT_SIZE;
@@ -43,11 +91,35 @@ TupleDesc::TupleDesc(const std::vector<type_t> &types, const std::vector<std::st
             case type_t::CHAR:
                 offset += CHAR_SIZE;
                 break;
+            case type_t::VARCHAR:
+                offset += VARCHAR_SLOT_SIZE;
+                varchars++;
+                break;
+            case type_t::DICT:
+                offset += dictionaries[i]->width();
+                break;
         }
     }
-    if (name_to_index.size() != names.size()) {
-        throw std::logic_error("Duplicate name");
+    bytes = offset;
+}
+
+TupleDesc TupleDesc::withDictionary(size_t index, std::shared_ptr<Dictionary> dictionary) const {
+    if (types.at(index) != type_t::CHAR) {
+        throw std::logic_error("Only CHAR fields can be dictionary-encoded");
+    }
+    if (!dictionary) {
+        throw std::logic_error("Missing dictionary");
     }
+    TupleDesc td = *this;
+    td.dictionaries.resize(types.size());
+    td.dictionaries[index] = std::move(dictionary);
+    td.types[index] = type_t::DICT;
+    td.layout();
+    return td;
+}
+
+const Dictionary *TupleDesc::dictionary_of(size_t index) const {
+    return types.at(index) == type_t::DICT ? dictionaries[index].get() : nullptr;
 }
 
 bool TupleDesc::compatible(const Tuple &tuple) const {
@@ -57,7 +129,9 @@ bool TupleDesc::compatible(const Tuple &tuple) const {
     }
 
     for (size_t i = 0; i < tuple.size(); i++) {
-        if (tuple.field_type(i) != types[i]) {
+        // CHAR, VARCHAR and DICT fields all hold strings.
+        type_t type = types[i] == type_t::VARCHAR || types[i] == type_t::DICT ? type_t::CHAR : types[i];
+        if (tuple.field_type(i) != type) {
             return false;
         }
     }
@@ -75,20 +149,44 @@ size_t TupleDesc::offset_of(const size_t &index) const {
     return offsets.at(index);
 }
 
+type_t TupleDesc::type_of(const size_t &index) const { return types.at(index); }
+
+std::vector<std::string> TupleDesc::names() const {
+    std::vector<std::string> all_names(types.size());
+    for (const auto &[name, index]: name_to_index) {
+        all_names[index] = name;
+    }
+    return all_names;
+}
+
 size_t TupleDesc::length() const {
     // TODO pa1
-    size_t length = 0;
-    for (type_t type: types) {
-        switch (type) {
-            case type_t::INT:
-                length += INT_SIZE;
-                break;
-            case type_t::DOUBLE:
-                length += DOUBLE_SIZE;
-                break;
-            case type_t::CHAR:
-                length += CHAR_SIZE;
-                break;
+    return bytes;
+}
+
+bool TupleDesc::variable_length() const { return varchars != 0; }
+
+size_t TupleDesc::max_length() const { return bytes + varchars * (sizeof(uint16_t) + VARCHAR_SIZE); }
+
+size_t TupleDesc::length(const Tuple &t) const {
+    size_t length = bytes;
+    for (size_t i = 0; varchars && i < types.size(); i++) {
+        if (types[i] == type_t::VARCHAR) {
+            size_t size = std::get<std::string>(t.get_field(i)).size();
+            if (size > VARCHAR_SIZE) {
+                throw std::logic_error("VARCHAR value too long");
+            }
+            length += sizeof(uint16_t) + size;
+        }
+    }
+    return length;
+}
+
+size_t TupleDesc::length(const uint8_t *data) const {
+    size_t length = bytes;
+    for (size_t i = 0; varchars && i < types.size(); i++) {
+        if (types[i] == type_t::VARCHAR) {
+            length += sizeof(uint16_t) + varchar(data, data + offsets[i], max_length()).size();
         }
     }
     return length;
@@ -103,27 +201,89 @@ Tuple TupleDesc::deserialize(const uint8_t *data) const {
     // TODO pa1
     std::vector<field_t> fields;
     fields.reserve(types.size());
-    for (const type_t &type: types) {
-        switch (type) {
-            case type_t::INT:
-                fields.emplace_back(*reinterpret_cast<const int *>(data));
-                data += INT_SIZE;
-                break;
-            case type_t::DOUBLE:
-                fields.emplace_back(*reinterpret_cast<const double *>(data));
-                data += DOUBLE_SIZE;
-                break;
-            case type_t::CHAR:
-                fields.emplace_back(std::string(reinterpret_cast<const char *>(data)));
-                data += CHAR_SIZE;
-                break;
+    Tuple t(std::move(fields));
+    deserialize(data, t);
+    return t;
+}
+
+void TupleDesc::deserialize(const uint8_t *data, Tuple &t) const {
+    t.fields.resize(types.size());
+    for (size_t i = 0; i < types.size(); i++) {
+        read(data, i, t.fields[i]);
+    }
+}
+
+void TupleDesc::read(const uint8_t *data, size_t i, field_t &field) const {
+    const uint8_t *value = data + offsets[i];
+    switch (types[i]) {
+        case type_t::INT: {
+            int v;
+            std::memcpy(&v, value, sizeof(v));
+            field = v;
+            break;
+        }
+        case type_t::DOUBLE: {
+            double v;
+            std::memcpy(&v, value, sizeof(v));
+            field = v;
+            break;
+        }
+        case type_t::CHAR: {
+            // A string of exactly CHAR_SIZE characters is stored without a terminator.
+            const char *chars = reinterpret_cast<const char *>(value);
+            assign(field, {chars, strnlen(chars, CHAR_SIZE)});
+            break;
+        }
+        case type_t::VARCHAR:
+            assign(field, varchar(data, value, max_length()));
+            break;
+        case type_t::DICT: {
+            const Dictionary &dictionary = *dictionaries[i];
+            assign(field, dictionary.decode(dictionary.load(value)));
+            break;
         }
     }
-    return {fields};
+}
+
+Tuple TupleDesc::deserialize(const uint8_t *data, const std::vector<size_t> &columns) const {
+    std::vector<field_t> fields;
+    deserialize(data, columns, fields);
+    return {std::move(fields)};
+}
+
+void TupleDesc::deserialize(const uint8_t *data, const std::vector<size_t> &columns,
+                            std::vector<field_t> &fields) const {
+    fields.resize(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i] >= types.size()) {
+            throw std::out_of_range("Column out of range");
+        }
+        read(data, columns[i], fields[i]);
+    }
+}
+
+TupleDesc TupleDesc::project(const std::vector<size_t> &columns) const {
+    std::vector<std::string> all_names = names();
+    std::vector<type_t> projected_types;
+    std::vector<std::string> names;
+    for (size_t column: columns) {
+        type_t type = types.at(column);
+        projected_types.push_back(type == type_t::DICT ? type_t::CHAR : type);
+        names.push_back(all_names[column]);
+    }
+    TupleDesc td(projected_types, names);
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (types[columns[i]] == type_t::DICT) {
+            td = td.withDictionary(i, dictionaries[columns[i]]);
+        }
+    }
+    return td;
 }
 
 void TupleDesc::serialize(uint8_t *data, const Tuple &t) const {
     // TODO pa1
+    uint8_t *tuple = data;
+    size_t end = bytes;
     for (size_t i = 0; i < types.size(); i++) {
         const type_t &type = types[i];
         const field_t &field = t.get_field(i);
@@ -140,6 +300,26 @@ void TupleDesc::serialize(uint8_t *data, const Tuple &t) const {
                 strncpy(reinterpret_cast<char *>(data), std::get<std::string>(field).c_str(), CHAR_SIZE);
                 data += CHAR_SIZE;
                 break;
+            case type_t::VARCHAR: {
+                const std::string &value = std::get<std::string>(field);
+                if (value.size() > VARCHAR_SIZE) {
+                    throw std::logic_error("VARCHAR value too long");
+                }
+                auto offset = static_cast<uint16_t>(end);
+                auto length = static_cast<uint16_t>(value.size());
+                std::memcpy(data, &offset, sizeof(offset));
+                std::memcpy(tuple + end, &length, sizeof(length));
+                std::memcpy(tuple + end + sizeof(length), value.data(), value.size());
+                end += sizeof(length) + value.size();
+                data += VARCHAR_SLOT_SIZE;
+                break;
+            }
+            case type_t::DICT: {
+                Dictionary &dictionary = *dictionaries[i];
+                dictionary.store(data, dictionary.encode(std::get<std::string>(field)));
+                data += dictionary.width();
+                break;
+            }
         }
     }
 }
@@ -148,6 +328,15 @@ db::TupleDesc TupleDesc::merge(const TupleDesc &td1, const TupleDesc &td2) {
     // TODO pa1
     std::vector<type_t> types(td1.types);
     types.insert(types.end(), td2.types.begin(), td2.types.end());
+    std::vector<std::shared_ptr<Dictionary>> dictionaries(types.size());
+    for (size_t i = 0; i < types.size(); i++) {
+        const TupleDesc &td = i < td1.size() ? td1 : td2;
+        size_t index = i < td1.size() ? i : i - td1.size();
+        if (types[i] == type_t::DICT) {
+            dictionaries[i] = td.dictionaries[index];
+            types[i] = type_t::CHAR;
+        }
+    }
     std::vector<std::string> names(types.size());
     for (const auto &[name, index]: td1.name_to_index) {
         names[index] = name;
@@ -155,5 +344,88 @@ db::TupleDesc TupleDesc::merge(const TupleDesc &td1, const TupleDesc &td2) {
     for (const auto &[name, index]: td2.name_to_index) {
         names[td1.size() + index] = name;
     }
-    return {types, names};
+    TupleDesc merged(types, names);
+    for (size_t i = 0; i < types.size(); i++) {
+        if (dictionaries[i]) {
+            merged = merged.withDictionary(i, dictionaries[i]);
+        }
+    }
+    return merged;
 }
+
+TupleView::TupleView(const TupleDesc &td, const uint8_t *data) : td(&td), data(data) {}
+
+TupleView::TupleView(const TupleDesc &td, std::vector<uint8_t> bytes)
+    : td(&td), owned(std::make_shared<const std::vector<uint8_t>>(std::move(bytes))) {
+    data = owned->data();
+}
+
+size_t TupleView::size() const { return td->size(); }
+
+type_t TupleView::field_type(size_t i) const { return td->type_of(i); }
+
+int TupleView::getInt(size_t i) const {
+    if (td->type_of(i) != type_t::INT) {
+        throw std::logic_error("Field is not an INT");
+    }
+    int value;
+    std::memcpy(&value, data + td->offset_of(i), sizeof(value));
+    return value;
+}
+
+double TupleView::getDouble(size_t i) const {
+    if (td->type_of(i) != type_t::DOUBLE) {
+        throw std::logic_error("Field is not a DOUBLE");
+    }
+    double value;
+    std::memcpy(&value, data + td->offset_of(i), sizeof(value));
+    return value;
+}
+
+std::string_view TupleView::getString(size_t i) const {
+    type_t type = td->type_of(i);
+    if (type == type_t::VARCHAR) {
+        return varchar(data, data + td->offset_of(i), td->max_length());
+    }
+    if (type == type_t::DICT) {
+        const Dictionary &dictionary = *td->dictionary_of(i);
+        return dictionary.decode(dictionary.load(data + td->offset_of(i)));
+    }
+    if (type != type_t::CHAR) {
+        throw std::logic_error("Field is not a CHAR");
+    }
+    const char *chars = reinterpret_cast<const char *>(data + td->offset_of(i));
+    return {chars, strnlen(chars, CHAR_SIZE)};
+}
+
+uint32_t TupleView::getCode(size_t i) const {
+    const Dictionary *dictionary = td->dictionary_of(i);
+    if (!dictionary) {
+        throw std::logic_error("Field is not a DICT");
+    }
+    return dictionary->load(data + td->offset_of(i));
+}
+
+field_t TupleView::get_field(size_t i) const {
+    switch (td->type_of(i)) {
+        case type_t::INT:
+            return getInt(i);
+        case type_t::DOUBLE:
+            return getDouble(i);
+        case type_t::CHAR:
+        case type_t::VARCHAR:
+        case type_t::DICT:
+            return std::string(getString(i));
+    }
+    throw std::logic_error("Unknown field type");
+}
+
+Tuple TupleView::toTuple() const { return td->deserialize(data); }
+
+void TupleView::toTuple(Tuple &t) const { td->deserialize(data, t); }
+
+Tuple TupleView::toTuple(const std::vector<size_t> &columns) const { return td->deserialize(data, columns); }
+
+const uint8_t *TupleView::bytes() const { return data; }
+
+const TupleDesc &TupleView::getTupleDesc() const { return *td; }
@@ -0,0 +1,40 @@
+#include <db/TupleArena.hpp>
+#include <cstring>
+
+using namespace db;
+
+TupleArena::TupleArena(size_t initial_size) : buffer(initial_size), arena(buffer.data(), buffer.size()) {}
+
+TupleView TupleArena::copy(const TupleView &t) {
+    const TupleDesc &td = t.getTupleDesc();
+    size_t length = td.length(t.bytes());
+    // Fields are read with memcpy, so tuples need no alignment.
+    auto *bytes = static_cast<uint8_t *>(arena.allocate(length, 1));
+    std::memcpy(bytes, t.bytes(), length);
+    used += length;
+    return {td, bytes};
+}
+
+TupleView TupleArena::copy(const TupleDesc &td, const Tuple &t) {
+    size_t length = td.length(t);
+    auto *bytes = static_cast<uint8_t *>(arena.allocate(length, 1));
+    td.serialize(bytes, t);
+    used += length;
+    return {td, bytes};
+}
+
+std::string_view TupleArena::copy(std::string_view s) {
+    auto *chars = static_cast<char *>(arena.allocate(s.size(), 1));
+    std::memcpy(chars, s.data(), s.size());
+    used += s.size();
+    return {chars, s.size()};
+}
+
+void TupleArena::release() {
+    arena.release();
+    used = 0;
+}
+
+size_t TupleArena::size() const { return used; }
+
+std::pmr::memory_resource *TupleArena::resource() { return &arena; }
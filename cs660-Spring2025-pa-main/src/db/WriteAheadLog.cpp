@@ -0,0 +1,180 @@
+#include <db/DbFile.hpp>
+#include <db/WriteAheadLog.hpp>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+namespace {
+    /**
+     * A record starts with its length and the checksum of the rest, then the length of the file name in two bytes,
+     * the name, the page number and the number of ranges. Each range is its offset in the page, its length and its
+     * bytes.
+     */
+    struct RecordHeader {
+        uint32_t length;
+        uint32_t checksum;
+    };
+
+    uint32_t checksum(const uint8_t *data, size_t size) {
+        // FNV-1a
+        uint32_t hash = 2166136261;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 16777619;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    void put(std::vector<uint8_t> &buffer, T value) {
+        const auto *p = reinterpret_cast<const uint8_t *>(&value);
+        buffer.insert(buffer.end(), p, p + sizeof(T));
+    }
+
+    template<typename T>
+    T get(const uint8_t *&p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string &path) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("fstat");
+    }
+    std::vector<uint8_t> contents(st.st_size);
+    if (pread(fd, contents.data(), contents.size(), 0) != static_cast<ssize_t>(contents.size())) {
+        close(fd);
+        throw std::runtime_error("pread");
+    }
+
+    // Gather the changes of each file, then write them to the file at once.
+    std::map<std::string, std::vector<PageUpdate>> updates;
+    for (size_t pos = 0; pos + sizeof(RecordHeader) <= contents.size();) {
+        RecordHeader header;
+        std::memcpy(&header, contents.data() + pos, sizeof(header));
+        const uint8_t *p = contents.data() + pos + sizeof(header);
+        if (header.length < sizeof(header) || header.length > contents.size() - pos ||
+            checksum(p, header.length - sizeof(header)) != header.checksum) {
+            break;
+        }
+        auto length = get<uint16_t>(p);
+        std::string name(reinterpret_cast<const char *>(p), length);
+        p += length;
+        auto page = get<uint64_t>(p);
+        auto ranges = get<uint32_t>(p);
+        std::vector<PageUpdate> &file = updates[name];
+        for (uint32_t i = 0; i < ranges; i++) {
+            auto offset = get<uint32_t>(p);
+            auto size = get<uint32_t>(p);
+            file.push_back({page, offset, {p, p + size}});
+            p += size;
+        }
+        pos += header.length;
+    }
+    try {
+        for (const auto &[name, file]: updates) {
+            DbFile::redo(name, file);
+        }
+    } catch (const std::runtime_error &) {
+        close(fd);
+        throw;
+    }
+    if (ftruncate(fd, 0) == -1 || fdatasync(fd) == -1) {
+        close(fd);
+        throw std::runtime_error("ftruncate");
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        flush(end());
+    } catch (const std::runtime_error &) {
+        // The records that could not be written are lost, like those of a crash.
+    }
+    close(fd);
+}
+
+lsn_t WriteAheadLog::append(const PageId &pid, const uint8_t *page,
+                            const std::vector<std::pair<size_t, size_t>> &ranges) {
+    std::vector<uint8_t> record(sizeof(RecordHeader));
+    put(record, static_cast<uint16_t>(pid.file.size()));
+    record.insert(record.end(), pid.file.begin(), pid.file.end());
+    put(record, static_cast<uint64_t>(pid.page));
+    put(record, static_cast<uint32_t>(ranges.size()));
+    for (const auto &[offset, length]: ranges) {
+        put(record, static_cast<uint32_t>(offset));
+        put(record, static_cast<uint32_t>(length));
+        record.insert(record.end(), page + offset, page + offset + length);
+    }
+    RecordHeader header{static_cast<uint32_t>(record.size()),
+                        checksum(record.data() + sizeof(RecordHeader), record.size() - sizeof(RecordHeader))};
+    std::memcpy(record.data(), &header, sizeof(header));
+
+    std::lock_guard lock(mutex);
+    buffer.insert(buffer.end(), record.begin(), record.end());
+    appended += record.size();
+    return appended;
+}
+
+lsn_t WriteAheadLog::end() const {
+    std::lock_guard lock(mutex);
+    return appended;
+}
+
+void WriteAheadLog::flush(lsn_t lsn) {
+    std::unique_lock lock(mutex);
+    while (durable < lsn) {
+        if (syncing) {
+            synced.wait(lock);
+            continue;
+        }
+        // Write everything appended so far, so that the threads that append while this one syncs share the next sync.
+        syncing = true;
+        std::vector<uint8_t> records;
+        records.swap(buffer);
+        lsn_t target = appended;
+        off_t offset = static_cast<off_t>(target - records.size() - base);
+        lock.unlock();
+        bool written = pwrite(fd, records.data(), records.size(), offset) == static_cast<ssize_t>(records.size()) &&
+                       fdatasync(fd) == 0;
+        lock.lock();
+        syncing = false;
+        synced.notify_all();
+        if (!written) {
+            // Put the records back, so that a later flush retries them.
+            buffer.insert(buffer.begin(), records.begin(), records.end());
+            throw std::runtime_error("Cannot write the log");
+        }
+        // The waiting threads check the position once this thread releases the lock.
+        durable = target;
+        syncs++;
+    }
+}
+
+void WriteAheadLog::truncate() {
+    flush(end());
+    std::unique_lock lock(mutex);
+    synced.wait(lock, [this] { return !syncing; });
+    if (ftruncate(fd, 0) == -1 || fdatasync(fd) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+    base = durable;
+}
+
+size_t WriteAheadLog::getSyncs() const {
+    std::lock_guard lock(mutex);
+    return syncs;
+}
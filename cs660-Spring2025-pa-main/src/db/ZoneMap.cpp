@@ -0,0 +1,96 @@
+#include <db/ZoneMap.hpp>
+#include <algorithm>
+#include <limits>
+
+using namespace db;
+
+ZoneMap::ZoneMap(const TupleDesc &td) {
+    for (size_t i = 0; i < td.size(); i++) {
+        if (td.type_of(i) == type_t::INT || td.type_of(i) == type_t::DOUBLE) {
+            columns.push_back(i);
+        }
+    }
+}
+
+void ZoneMap::grow(size_t page) {
+    if (page < known.size()) {
+        return;
+    }
+    known.resize(page + 1, false);
+    rows.resize(page + 1, 0);
+    bounds.resize((page + 1) * columns.size() * 2);
+}
+
+bool ZoneMap::isKnown(size_t page) const { return page < known.size() && known[page]; }
+
+size_t ZoneMap::getRows(size_t page) const { return isKnown(page) ? rows[page] : 0; }
+
+void ZoneMap::reset(size_t page) {
+    grow(page);
+    known[page] = true;
+    rows[page] = 0;
+    double *b = bounds.data() + page * columns.size() * 2;
+    for (size_t i = 0; i < columns.size(); i++) {
+        b[2 * i] = std::numeric_limits<double>::infinity();
+        b[2 * i + 1] = -std::numeric_limits<double>::infinity();
+    }
+}
+
+void ZoneMap::insert(size_t page, const Tuple &t) {
+    if (!isKnown(page)) {
+        return;
+    }
+    rows[page]++;
+    double *b = bounds.data() + page * columns.size() * 2;
+    for (size_t i = 0; i < columns.size(); i++) {
+        const field_t &f = t.get_field(columns[i]);
+        double v = std::holds_alternative<int>(f) ? std::get<int>(f) : std::get<double>(f);
+        b[2 * i] = std::min(b[2 * i], v);
+        b[2 * i + 1] = std::max(b[2 * i + 1], v);
+    }
+}
+
+void ZoneMap::insert(size_t page, const TupleView &t) {
+    if (!isKnown(page)) {
+        return;
+    }
+    rows[page]++;
+    double *b = bounds.data() + page * columns.size() * 2;
+    for (size_t i = 0; i < columns.size(); i++) {
+        size_t column = columns[i];
+        double v = t.field_type(column) == type_t::INT ? t.getInt(column) : t.getDouble(column);
+        b[2 * i] = std::min(b[2 * i], v);
+        b[2 * i + 1] = std::max(b[2 * i + 1], v);
+    }
+}
+
+void ZoneMap::remove(size_t page) {
+    if (!isKnown(page)) {
+        return;
+    }
+    if (--rows[page] == 0) {
+        reset(page);
+    }
+}
+
+bool ZoneMap::mayMatch(size_t page, const std::vector<Predicate> &predicates) const {
+    if (!isKnown(page)) {
+        return true;
+    }
+    if (rows[page] == 0) {
+        return false;
+    }
+    const double *b = bounds.data() + page * columns.size() * 2;
+    for (const Predicate &p: predicates) {
+        auto it = std::lower_bound(columns.begin(), columns.end(), p.field);
+        if (it == columns.end() || *it != p.field) {
+            // CHAR and VARCHAR fields are not summarized.
+            continue;
+        }
+        size_t i = it - columns.begin();
+        if (!p.mayMatch(b[2 * i], b[2 * i + 1])) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+#include <db/Batch.hpp>
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc batchDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::VARCHAR},
+                {"id", "name", "price", "note"}};
+    }
+
+    std::string note(int i) { return std::string(i % 30, 'n'); }
+} // namespace
+
+TEST(BatchTest, Columns) {
+    db::TupleDesc td = batchDesc();
+    db::Batch batch(td, {3, 0});
+    std::vector<uint8_t> bytes(td.max_length());
+    for (int i = 0; !batch.full(); i++) {
+        td.serialize(bytes.data(), {{i, "name", 1.0, note(i)}});
+        batch.append(bytes.data());
+    }
+    EXPECT_EQ(batch.size(), db::BATCH_SIZE);
+    EXPECT_THROW(batch.append(bytes.data()), std::logic_error);
+    EXPECT_EQ(batch.ints(1)[100], 100);
+    EXPECT_EQ(batch.strings(0)[29], note(29));
+    EXPECT_THROW(batch.doubles(0), std::logic_error);
+    EXPECT_THROW(db::Batch(td, {4}), std::out_of_range);
+
+    batch.truncate(10);
+    EXPECT_EQ(batch.size(), 10);
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(BatchTest, HeapFile) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, batchDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    constexpr int n = 5000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "name", i * 0.5, note(i)}});
+    }
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        if (it.view().getInt(0) % 3 == 0) {
+            file.deleteTuple(it);
+        }
+    }
+
+    long expected = 0;
+    for (int i = 0; i < n; i++) {
+        expected += i % 3 ? i : 0;
+    }
+    long sum = 0;
+    size_t rows = 0;
+    db::Batch batch(file.getTupleDesc(), {0, 3});
+    db::Iterator it = file.begin();
+    while (file.nextBatch(it, batch)) {
+        const int *ids = batch.ints(0);
+        const std::string_view *notes = batch.strings(1);
+        for (size_t i = 0; i < batch.size(); i++) {
+            sum += ids[i];
+            EXPECT_EQ(notes[i], note(ids[i]));
+        }
+        rows += batch.size();
+    }
+    EXPECT_TRUE(it == file.end());
+    EXPECT_EQ(rows, n - (n + 2) / 3);
+    EXPECT_EQ(sum, expected);
+}
+
+TEST(BatchTest, BTree) {
+    const std::string name = testFile("btree.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, batchDesc(), 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    constexpr int n = 10000;
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    for (int i: keys) {
+        file.insertTuple({{i, "name", i * 0.5, note(i)}});
+    }
+
+    int expected = 0;
+    db::Batch batch(file.getTupleDesc());
+    db::Iterator it = file.begin();
+    while (file.nextBatch(it, batch)) {
+        const int *ids = batch.ints(0);
+        const double *prices = batch.doubles(2);
+        for (size_t i = 0; i < batch.size(); i++) {
+            ASSERT_EQ(ids[i], expected);
+            EXPECT_EQ(prices[i], expected * 0.5);
+            expected++;
+        }
+    }
+    EXPECT_EQ(expected, n);
+    EXPECT_TRUE(it == file.end());
+}
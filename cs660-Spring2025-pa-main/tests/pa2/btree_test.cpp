@@ -1,10 +1,18 @@
 #include <db/BTreeFile.hpp>
+#include <db/Cursor.hpp>
 #include <db/Database.hpp>
+#include <db/HeapFile.hpp>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <thread>
+#include "test_file.hpp"
 
 TEST(BTreeTest, Empty) {
-    const char *name = "test.db";
-    std::remove(name);
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
     db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
     db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
     auto &file = db::getDatabase().get(name);
@@ -14,8 +22,8 @@ TEST(BTreeTest, Empty) {
 }
 
 TEST(BTreeTest, Sorted) {
-    const char *name = "test.db";
-    std::remove(name);
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
     db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
     db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
     auto &file = db::getDatabase().get(name);
@@ -34,8 +42,8 @@ TEST(BTreeTest, Sorted) {
 }
 
 TEST(BTreeTest, SortedAccess) {
-    const char *name = "test.db";
-    std::remove(name);
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
     db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
     db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
     auto &file = db::getDatabase().get(name);
@@ -58,8 +66,8 @@ TEST(BTreeTest, SortedAccess) {
 }
 
 TEST(BTreeTest, Random) {
-    const char *name = "test.db";
-    std::remove(name);
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
     db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
     db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
     auto &file = db::getDatabase().get(name);
@@ -79,8 +87,8 @@ TEST(BTreeTest, Random) {
 }
 
 TEST(BTreeTest, RandomAccess) {
-    const char *name = "test.db";
-    std::remove(name);
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
     db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
     db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
     auto &file = db::getDatabase().get(name);
@@ -102,3 +110,412 @@ TEST(BTreeTest, RandomAccess) {
   // EXPECT_LE(file.getWrites().size(), 47142);
     EXPECT_NEAR(file.getWrites().size(), 45000, 10000);
 }
+
+static void concurrentInserts(const db::BTreeOptions &options) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, options));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    constexpr int num_threads = 4;
+    constexpr int per_thread = 25000;
+    std::vector<std::thread> threads;
+    std::atomic<int> missing = 0;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; i++) {
+                int k = i * num_threads + t;
+                file.insertTuple({{k, "apple", 1.0}});
+                // Keys inserted by this thread must stay visible while the other threads split pages.
+                int probe = (i / 2) * num_threads + t;
+                if (!file.find(probe)) {
+                    missing++;
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    EXPECT_EQ(missing, 0);
+    EXPECT_FALSE(file.find(num_threads * per_thread));
+    int i = 0;
+    for (const auto &t: file) {
+        EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+        i++;
+    }
+    EXPECT_EQ(i, num_threads * per_thread);
+    db::getDatabase().remove(name);
+}
+
+TEST(BTreeTest, Concurrent) {
+    concurrentInserts({});
+}
+
+TEST(BTreeTest, BLinkConcurrent) {
+    concurrentInserts({.blink = true});
+}
+
+static void bulkLoad(const db::BTreeOptions &options) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, options));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    constexpr int n = 100000;
+    std::vector<db::Tuple> tuples;
+    for (int i = 0; i < n; i++) {
+        tuples.push_back({{2 * i, "apple", 1.0}});
+    }
+    file.bulkLoad(tuples);
+    EXPECT_THROW(file.bulkLoad(tuples), std::logic_error);
+    for (int i = 0; i < n; i += 97) {
+        EXPECT_TRUE(file.find(2 * i));
+        EXPECT_FALSE(file.find(2 * i + 1));
+    }
+    // The loaded tree takes inserts and deletes like any other.
+    for (int i = 0; i < n; i += 10) {
+        file.insertTuple({{2 * i + 1, "banana", 2.0}});
+    }
+    EXPECT_TRUE(file.erase(0));
+    EXPECT_FALSE(file.erase(0));
+    int count = 0;
+    int last = -1;
+    for (auto it = file.lowerBound(0); it != file.end(); ++it) {
+        int key = std::get<int>((*it).get_field(0));
+        EXPECT_GT(key, last);
+        last = key;
+        count++;
+    }
+    EXPECT_EQ(count, n + n / 10 - 1);
+    EXPECT_EQ(std::get<int>((*file.lowerBound(101)).get_field(0)), 101);
+    EXPECT_EQ(std::get<int>((*file.lowerBound(103)).get_field(0)), 104);
+    db::getDatabase().remove(name);
+}
+
+TEST(BTreeTest, BulkLoad) {
+    bulkLoad({});
+}
+
+TEST(BTreeTest, BLinkBulkLoad) {
+    bulkLoad({.blink = true});
+}
+
+TEST(BTreeTest, BulkLoadUnsorted) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    EXPECT_THROW(file.bulkLoad({{{2, "apple", 1.0}}, {{1, "apple", 1.0}}}), std::logic_error);
+}
+
+TEST(BTreeTest, BloomFilter) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    constexpr int n = 10000;
+    for (int i = 0; i < n / 2; i++) {
+        file.insertTuple({{2 * i, "apple", 1.0}});
+    }
+    file.enableBloomFilter(n);
+    for (int i = n / 2; i < n; i++) {
+        file.insertTuple({{2 * i, "apple", 1.0}});
+    }
+
+    db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+    bufferPool.flushFile(name);
+    bufferPool.discardFile(name);
+    size_t reads = file.getReads().size();
+    for (int i = 0; i < n; i++) {
+        EXPECT_FALSE(file.find(2 * i + 1));
+    }
+    db::BloomFilterStats stats = file.getBloomFilterStats();
+    EXPECT_EQ(stats.probes, n);
+    EXPECT_EQ(stats.negatives + stats.false_positives, n);
+    EXPECT_LT(stats.false_positive_rate, 0.05);
+    EXPECT_GT(stats.estimated_false_positive_rate, 0);
+    // Only the false positives descend the tree.
+    EXPECT_LE(file.getReads().size() - reads, 4 * stats.false_positives);
+
+    // A filter never hides a key that is in the file.
+    for (int i = 0; i < n; i++) {
+        EXPECT_TRUE(file.find(2 * i));
+    }
+    EXPECT_EQ(file.getBloomFilterStats().false_positives, stats.false_positives);
+}
+
+TEST(BTreeTest, BloomFilterBulkLoad) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::DOUBLE, db::type_t::INT}, {"price", "id"});
+    db::getDatabase().add(std::make_unique<db::BasicBTreeFile<double>>(name, td, 0));
+    auto &file = dynamic_cast<db::BasicBTreeFile<double> &>(db::getDatabase().get(name));
+    file.enableBloomFilter();
+    std::vector<db::Tuple> tuples;
+    for (int i = 0; i < 5000; i++) {
+        tuples.push_back({{i * 1.0, i}});
+    }
+    file.bulkLoad(tuples);
+    EXPECT_TRUE(file.find(-0.0));
+    EXPECT_TRUE(file.find(4999.0));
+    for (int i = 0; i < 5000; i++) {
+        EXPECT_FALSE(file.find(i + 0.5));
+    }
+    EXPECT_GT(file.getBloomFilterStats().negatives, 4500);
+}
+
+TEST(BTreeTest, Duplicates) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::INT}, {"key", "seq"});
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, db::BTreeOptions{.duplicates = true}));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    // Key 50 forms a run that spans many leaves, the other keys have a few duplicates each.
+    constexpr int n = 20000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i % 2 ? 50 : i % 100, i}});
+    }
+    auto run = file.findAll(50);
+    ASSERT_EQ(run.size(), n / 2 + n / 100);
+    for (size_t i = 1; i < run.size(); i++) {
+        EXPECT_LT(std::get<int>(run[i - 1].get_field(1)), std::get<int>(run[i].get_field(1)));
+    }
+    for (int k = 0; k < 100; k += 2) {
+        auto tuples = file.findAll(k);
+        EXPECT_EQ(tuples.size(), k == 50 ? run.size() : n / 100);
+        ASSERT_TRUE(file.find(k));
+        EXPECT_EQ(std::get<int>(file.find(k)->get_field(1)), k == 50 ? 1 : k);
+    }
+    EXPECT_TRUE(file.findAll(51).empty());
+
+    // A full scan returns every tuple in key order, equal keys in insertion order.
+    int count = 0;
+    int last_key = -1, last_seq = -1;
+    for (const auto &t: file) {
+        int key = std::get<int>(t.get_field(0));
+        int seq = std::get<int>(t.get_field(1));
+        EXPECT_LE(last_key, key);
+        if (key == last_key) {
+            EXPECT_LT(last_seq, seq);
+        }
+        last_key = key;
+        last_seq = seq;
+        count++;
+    }
+    EXPECT_EQ(count, n);
+
+    EXPECT_TRUE(file.erase(50));
+    EXPECT_EQ(file.findAll(50).size(), run.size() - 1);
+    EXPECT_THROW(db::BTreeFile(testFile("other.db"), td, 0, {.blink = true, .duplicates = true}), std::logic_error);
+}
+
+TEST(BTreeTest, CompressedConcurrent) {
+    concurrentInserts({.compress = true});
+}
+
+TEST(BTreeTest, CompressedBLinkConcurrent) {
+    concurrentInserts({.blink = true, .compress = true});
+}
+
+TEST(BTreeTest, CompressedBulkLoad) {
+    bulkLoad({.compress = true});
+}
+
+TEST(BTreeTest, Compressed) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::INT}, {"id", "value"});
+    EXPECT_THROW(db::BTreeFile(testFile("test.db"), td, 0, {.duplicates = true, .compress = true}), std::logic_error);
+    EXPECT_THROW(db::BasicBTreeFile<double>(testFile("test.db"), {{db::type_t::DOUBLE}, {"price"}}, 0, {.compress = true}),
+                 std::logic_error);
+
+    // The same random inserts, into a plain and a compressed tree.
+    constexpr int n = 50000;
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = 3 * i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+    size_t pages[2];
+    size_t loaded[2];
+    for (bool compress: {false, true}) {
+        const std::string name = testFile("test.db");
+        std::remove(name.c_str());
+        db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, db::BTreeOptions{.compress = compress}));
+        auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+        for (int k: keys) {
+            file.insertTuple({{k, -k}});
+        }
+        for (int i = 0; i < n; i += 7) {
+            EXPECT_TRUE(file.erase(3 * i));
+            EXPECT_FALSE(file.find(3 * i));
+            EXPECT_EQ(file.find(3 * i + 3)->get_field(1), db::field_t{-3 * i - 3});
+        }
+        int expected = 1;
+        db::Tuple t(std::vector<db::field_t>{});
+        for (auto it = file.lowerBound(2); it != file.end(); ++it) {
+            if (expected % 7 == 0) {
+                expected++;
+            }
+            EXPECT_EQ(file.getView(it).getInt(0), 3 * expected);
+            file.getTuple(it, t);
+            EXPECT_EQ(t.get_field(1), db::field_t{-3 * expected});
+            expected++;
+        }
+        EXPECT_EQ(expected, n);
+        // Views of tuples decoded from compressed leaves do not share a buffer.
+        auto it = file.begin();
+        db::TupleView first = file.getView(it);
+        ++it;
+        EXPECT_NE(file.getView(it).getInt(0), first.getInt(0));
+        // The same goes for the views of a cursor, held across next().
+        auto cursor = file.cursor();
+        db::TupleView current = cursor->view();
+        cursor->next();
+        db::TupleView following = cursor->view();
+        EXPECT_EQ(current.getInt(0), first.getInt(0));
+        EXPECT_EQ(following.getInt(1), -following.getInt(0));
+        EXPECT_LT(current.getInt(0), following.getInt(0));
+        pages[compress] = file.getNumPages();
+        db::getDatabase().remove(name);
+
+        // A bulk load fills the leaves to the capacity their key range allows.
+        std::remove(name.c_str());
+        db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, db::BTreeOptions{.compress = compress}));
+        auto &loaded_file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+        std::vector<db::Tuple> tuples;
+        for (int i = 0; i < n; i++) {
+            tuples.push_back({{3 * i, -3 * i}});
+        }
+        loaded_file.bulkLoad(tuples);
+        EXPECT_EQ(loaded_file.find(3 * (n - 1))->get_field(1), db::field_t{-3 * (n - 1)});
+        loaded_file.insertTuple({{3 * n, 0}});
+        loaded_file.insertTuple({{-1, 0}});
+        int count = 0;
+        for (auto it = loaded_file.begin(); it != loaded_file.end(); ++it) {
+            count++;
+        }
+        EXPECT_EQ(count, n + 2);
+        loaded[compress] = loaded_file.getNumPages();
+        db::getDatabase().remove(name);
+    }
+    // Random inserts leave the leaves of both trees about half full, so compression saves less there.
+    EXPECT_LE(pages[1], pages[0]);
+    // The keys of the loaded leaves take two bytes instead of four.
+    EXPECT_LT(loaded[1], loaded[0] * 4 / 5);
+}
+
+TEST(BTreeTest, PageSize) {
+    const std::string name = testFile("test.db");
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    constexpr int n = 100000;
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    size_t reads[2];
+    for (size_t page_size: {db::DEFAULT_PAGE_SIZE, db::MAX_PAGE_SIZE}) {
+        std::remove(name.c_str());
+        db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, db::BTreeOptions{.page_size = page_size}));
+        auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+        for (int k: keys) {
+            file.insertTuple({{k, "apple", k * 0.5}});
+        }
+        EXPECT_TRUE(file.erase(17));
+        int i = 0;
+        for (const auto &t: file) {
+            i += i == 17;
+            EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+            i++;
+        }
+        EXPECT_EQ(i, n);
+
+        // Look up keys far apart from cold pages: with large pages the tree has fewer levels to read.
+        db::getDatabase().getBufferPool().flushFile(name);
+        db::getDatabase().getBufferPool().discardFile(name);
+        size_t before = file.getReads().size();
+        for (int k = 0; k < n; k += n / 10) {
+            EXPECT_EQ(file.find(k + 1)->get_field(2), db::field_t{(k + 1) * 0.5});
+        }
+        reads[page_size == db::MAX_PAGE_SIZE] = file.getReads().size() - before;
+        db::getDatabase().remove(name);
+    }
+    EXPECT_LT(reads[1], reads[0]);
+    EXPECT_THROW(db::BTreeFile(name, td, 0), std::runtime_error);
+}
+
+TEST(BTreeTest, RootSplitPageSize) {
+    const std::string name = testFile("test.db");
+    // Wide composite keys keep the index pages small enough for the root to split with every page size.
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::CHAR, db::type_t::CHAR, db::type_t::CHAR,
+                      db::type_t::CHAR}, {"id", "a", "b", "c", "d", "e"});
+    std::vector<size_t> key_indices{1, 2, 3, 4, 5};
+    db::KeyDesc kd(td, key_indices);
+    constexpr int n = 40000;
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(11));
+    auto tuple = [](int k) {
+        std::string a = std::to_string(k);
+        return db::Tuple({k, std::string(8 - a.size(), '0') + a, "b", "c", "d", "e"});
+    };
+    for (size_t page_size: {2 * db::DEFAULT_PAGE_SIZE, db::MAX_PAGE_SIZE}) {
+        std::remove(name.c_str());
+        db::getDatabase().add(std::make_unique<db::BasicBTreeFile<db::NormalizedKey>>(
+                name, td, key_indices, db::BTreeOptions{.page_size = page_size}));
+        auto &file = dynamic_cast<db::BasicBTreeFile<db::NormalizedKey> &>(db::getDatabase().get(name));
+        for (int k: keys) {
+            file.insertTuple(tuple(k));
+        }
+        for (int k = 0; k < n; k++) {
+            auto t = file.find(kd.normalize(tuple(k)));
+            ASSERT_TRUE(t.has_value()) << "page size " << page_size << ", key " << k;
+            EXPECT_EQ(t->get_field(0), db::field_t{k});
+        }
+        int i = 0;
+        for (const auto &t: file) {
+            EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+            i++;
+        }
+        EXPECT_EQ(i, n);
+        db::getDatabase().remove(name);
+    }
+}
+
+TEST(BTreeTest, Reopen) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::BTreeOptions options{.blink = true, .page_size = 2 * db::DEFAULT_PAGE_SIZE};
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, options));
+    constexpr int n = 20000;
+    for (int i = 0; i < n; i++) {
+        db::getDatabase().get(name).insertTuple({{i, "apple", i * 0.5}});
+    }
+    size_t pages = db::getDatabase().get(name).getNumPages();
+    db::getDatabase().remove(name);
+
+    // The superblock records what the file was created with.
+    db::TupleDesc renamed({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "label", "price"});
+    EXPECT_THROW(db::BTreeFile(name, td, 0, {.page_size = options.page_size}), std::runtime_error);
+    EXPECT_THROW(db::BTreeFile(name, td, 0, {.blink = true}), std::runtime_error);
+    EXPECT_THROW(db::BTreeFile(name, renamed, 0, options), std::runtime_error);
+    EXPECT_THROW(db::HeapFile(name, td), std::runtime_error);
+    EXPECT_THROW(db::BasicBTreeFile<db::NormalizedKey>(name, td, 0, options), std::runtime_error);
+
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, options));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    EXPECT_EQ(file.getNumPages(), pages);
+    EXPECT_TRUE(file.getReads().empty());
+    EXPECT_EQ(file.find(n / 2)->get_field(2), db::field_t{n / 4.0});
+    file.insertTuple({{n, "banana", 0.0}});
+    int count = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        count++;
+    }
+    EXPECT_EQ(count, n + 1);
+    db::getDatabase().remove(name);
+
+    std::ofstream(name) << "not a database file";
+    EXPECT_THROW(db::BTreeFile(name, td, 0), std::runtime_error);
+}
@@ -0,0 +1,150 @@
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <db/HeapFile.hpp>
+#include <db/SecondaryIndex.hpp>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+namespace {
+    size_t openDescriptors() {
+        auto entries = std::filesystem::directory_iterator("/proc/self/fd");
+        return std::distance(begin(entries), end(entries));
+    }
+} // namespace
+
+TEST(CatalogTest, SaveAndLoad) {
+    const std::string catalog = testFile("catalog.db");
+    const std::string heap = testFile("heap.db");
+    const std::string tree = testFile("tree.db");
+    const std::string hash = testFile("hash.db");
+    for (const std::string &name: {catalog, heap, tree, hash}) {
+        std::remove(name.c_str());
+    }
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::BTreeOptions options{.blink = true, .compress = true, .page_size = 2 * db::DEFAULT_PAGE_SIZE};
+    db::Database &database = db::getDatabase();
+    database.add(std::make_unique<db::HeapFile>(heap, td));
+    database.add(std::make_unique<db::BTreeFile>(tree, td, 0, options));
+    database.add(std::make_unique<db::HashFile>(hash, td, std::vector<size_t>{1, 0}));
+    constexpr int n = 1000;
+    for (int i = 0; i < n; i++) {
+        for (const std::string &name: {heap, tree, hash}) {
+            database.get(name).insertTuple({{i, "apple", i * 0.5}});
+        }
+    }
+    size_t heap_pages = database.get(heap).getNumPages();
+    database.saveCatalog(catalog);
+    for (const std::string &name: {heap, tree, hash}) {
+        database.remove(name);
+    }
+
+    // Loading the catalog does not open the files.
+    size_t descriptors = openDescriptors();
+    database.loadCatalog(catalog);
+    EXPECT_EQ(openDescriptors(), descriptors);
+    EXPECT_THROW(database.loadCatalog(catalog), std::logic_error);
+
+    // Each file is opened the way it was created on first use.
+    auto &reopened = dynamic_cast<db::BTreeFile &>(database.get(tree));
+    EXPECT_EQ(reopened.getPageSize(), options.page_size);
+    EXPECT_EQ(reopened.find(n / 2)->get_field(2), db::field_t{n / 4.0});
+    EXPECT_NE(dynamic_cast<db::HashFile *>(&database.get(hash)), nullptr);
+    for (const std::string &name: {heap, tree, hash}) {
+        const db::DbFile &file = database.get(name);
+        EXPECT_EQ(file.getTupleDesc().names(), td.names());
+        int count = 0;
+        for (auto it = file.begin(); it != file.end(); ++it) {
+            count++;
+        }
+        EXPECT_EQ(count, n);
+    }
+
+    // A file that was never opened is saved from its catalog entry.
+    database.remove(tree);
+    database.remove(hash);
+    database.saveCatalog(catalog);
+    database.remove(heap);
+    database.loadCatalog(catalog);
+    EXPECT_EQ(database.remove(heap)->getNumPages(), heap_pages);
+    EXPECT_THROW(database.get(tree), std::out_of_range);
+
+    std::filesystem::resize_file(catalog, 20);
+    EXPECT_THROW(database.loadCatalog(catalog), std::runtime_error);
+    EXPECT_THROW(database.get(heap), std::out_of_range);
+}
+
+TEST(CatalogTest, Indexes) {
+    const std::string catalog = testFile("catalog.db");
+    const std::string heap_name = testFile("heap.db");
+    const std::string index_name = testFile("heap.name.idx");
+    for (const std::string &name: {catalog, heap_name, index_name}) {
+        std::remove(name.c_str());
+    }
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::Database &database = db::getDatabase();
+    database.add(std::make_unique<db::HeapFile>(heap_name, td));
+    auto &heap = dynamic_cast<db::HeapFile &>(database.get(heap_name));
+    database.add(std::make_unique<db::SecondaryIndex>(index_name, heap, std::vector<size_t>{1}));
+    heap.addIndex(dynamic_cast<db::SecondaryIndex &>(database.get(index_name)));
+    constexpr int n = 600;
+    const char *names[] = {"apple", "banana", "cherry"};
+    for (int i = 0; i < n; i++) {
+        heap.insertTuple({{i, names[i % 3], i * 0.5}});
+    }
+    database.saveCatalog(catalog);
+    heap.dropIndex(dynamic_cast<db::SecondaryIndex &>(database.get(index_name)));
+    database.remove(index_name);
+    database.remove(heap_name);
+
+    // The index reopens as an index of the heap, attached again.
+    database.loadCatalog(catalog);
+    auto &index = dynamic_cast<db::SecondaryIndex &>(database.get(index_name));
+    auto &reopened = dynamic_cast<db::HeapFile &>(database.get(heap_name));
+    EXPECT_EQ(&index.getHeapFile(), &reopened);
+    ASSERT_EQ(reopened.getIndexes().size(), 1);
+    reopened.insertTuple({{n, "banana", 0.0}});
+    EXPECT_EQ(index.lookup({{std::string("banana")}}).size(), n / 3 + 1);
+
+    // A detached index is saved detached.
+    reopened.dropIndex(index);
+    database.saveCatalog(catalog);
+    database.remove(index_name);
+    database.remove(heap_name);
+    database.loadCatalog(catalog);
+    EXPECT_TRUE(dynamic_cast<db::HeapFile &>(database.get(heap_name)).getIndexes().empty());
+    EXPECT_NE(dynamic_cast<db::SecondaryIndex *>(&database.get(index_name)), nullptr);
+    database.remove(index_name);
+    database.remove(heap_name);
+}
+
+TEST(CatalogTest, OpenFiles) {
+    db::TupleDesc td({db::type_t::INT}, {"id"});
+    db::Database &database = db::getDatabase();
+    constexpr size_t n = 2 * db::MAX_OPEN_FILES;
+    size_t descriptors = openDescriptors();
+    for (size_t i = 0; i < n; i++) {
+        std::string name = testFile("open" + std::to_string(i) + ".db");
+        std::remove(name.c_str());
+        database.add(std::make_unique<db::HeapFile>(name, td));
+        database.get(name).insertTuple({{static_cast<int>(i)}});
+        database.getBufferPool().flushFile(name);
+        database.getBufferPool().discardFile(name);
+        EXPECT_LE(openDescriptors(), descriptors + db::MAX_OPEN_FILES);
+    }
+    // Files whose descriptor was closed reopen it.
+    for (size_t i = 0; i < n; i++) {
+        std::string name = testFile("open" + std::to_string(i) + ".db");
+        const db::DbFile &file = database.get(name);
+        EXPECT_EQ(file.getTupleDesc().length(), td.length());
+        EXPECT_EQ((*file.begin()).get_field(0), db::field_t{static_cast<int>(i)});
+        EXPECT_LE(openDescriptors(), descriptors + db::MAX_OPEN_FILES);
+    }
+    for (size_t i = 0; i < n; i++) {
+        std::string name = testFile("open" + std::to_string(i) + ".db");
+        database.remove(name);
+        std::remove(name.c_str());
+    }
+    EXPECT_EQ(openDescriptors(), descriptors);
+}
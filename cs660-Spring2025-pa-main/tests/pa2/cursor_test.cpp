@@ -0,0 +1,87 @@
+#include <db/BTreeFile.hpp>
+#include <db/Cursor.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/PaxFile.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc cursorDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"}};
+    }
+} // namespace
+
+TEST(CursorTest, HeapFile) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, cursorDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    EXPECT_FALSE(file.cursor()->valid());
+    constexpr int n = 2000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "name", i * 0.5}});
+    }
+    // Delete through the position of the cursor, leaving empty slots and empty pages.
+    for (auto c = file.cursor(); c->valid(); c->next()) {
+        int i = c->view().getInt(0);
+        if (i % 3 == 0 || (i >= 500 && i < 1000)) {
+            file.deleteTuple(c->position());
+        }
+    }
+
+    std::vector<int> expected;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        expected.push_back(std::get<int>((*it).get_field(0)));
+    }
+    EXPECT_EQ(expected.size(), n - 500 - (n - 500) / 3);
+    std::vector<int> found;
+    auto c = file.cursor();
+    for (; c->valid(); c->next()) {
+        EXPECT_EQ(c->get().get_field(2), db::field_t(c->view().getInt(0) * 0.5));
+        found.push_back(c->view().getInt(0));
+    }
+    EXPECT_EQ(found, expected);
+    EXPECT_TRUE(c->position() == file.end());
+}
+
+TEST(CursorTest, BTree) {
+    const std::string name = testFile("btree.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, cursorDesc(), 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    EXPECT_FALSE(file.cursor()->valid());
+    constexpr int n = 10000;
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+    for (int i: keys) {
+        file.insertTuple({{i, "name", i * 0.5}});
+    }
+    int expected = 0;
+    auto c = file.cursor();
+    for (; c->valid(); c->next()) {
+        ASSERT_EQ(c->view().getInt(0), expected);
+        EXPECT_EQ(std::get<int>(c->get().get_field(0)), expected);
+        expected++;
+    }
+    EXPECT_EQ(expected, n);
+    EXPECT_TRUE(c->position() == file.end());
+}
+
+TEST(CursorTest, Default) {
+    const std::string name = testFile("pax.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::PaxFile>(name, cursorDesc()));
+    auto &file = db::getDatabase().get(name);
+    for (int i = 0; i < 100; i++) {
+        file.insertTuple({{i, "name", 0.0}});
+    }
+    int expected = 0;
+    for (auto c = file.cursor(); c->valid(); c->next()) {
+        EXPECT_EQ(std::get<int>(c->get().get_field(0)), expected++);
+    }
+    EXPECT_EQ(expected, 100);
+}
@@ -0,0 +1,164 @@
+#include <db/Batch.hpp>
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/Dictionary.hpp>
+#include <db/HeapFile.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+namespace {
+    const std::vector<std::string> statuses{"active", "closed", "pending", "suspended"};
+
+    db::TupleDesc plainDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "status", "price"}};
+    }
+} // namespace
+
+TEST(DictionaryTest, Codes) {
+    const std::string path = testFile("test.dict");
+    std::remove(path.c_str());
+    {
+        db::Dictionary dictionary(path, 1);
+        EXPECT_EQ(dictionary.encode("a"), 0);
+        EXPECT_EQ(dictionary.encode("b"), 1);
+        EXPECT_EQ(dictionary.encode("a"), 0);
+        EXPECT_EQ(dictionary.encode(std::string(db::CHAR_SIZE + 10, 'x')), 2);
+        EXPECT_EQ(dictionary.decode(2), std::string(db::CHAR_SIZE, 'x'));
+        EXPECT_FALSE(dictionary.find("c").has_value());
+        EXPECT_THROW(dictionary.decode(3), std::out_of_range);
+        for (int i = 0; dictionary.size() < 256; i++) {
+            dictionary.encode(std::to_string(i));
+        }
+        EXPECT_THROW(dictionary.encode("full"), std::logic_error);
+    }
+    db::Dictionary reopened(path, 1);
+    EXPECT_EQ(reopened.size(), 256);
+    EXPECT_EQ(reopened.find("b"), 1);
+    EXPECT_EQ(reopened.decode(0), "a");
+    EXPECT_THROW(db::Dictionary("", 3), std::logic_error);
+    std::remove(path.c_str());
+}
+
+TEST(DictionaryTest, HeapFile) {
+    const std::string name = testFile("heap.db");
+    const std::string path = testFile("heap.db.status");
+    std::remove(name.c_str());
+    std::remove(path.c_str());
+    auto dictionary = std::make_shared<db::Dictionary>(path, 1);
+    db::TupleDesc td = plainDesc().withDictionary(1, dictionary);
+    EXPECT_EQ(td.type_of(1), db::type_t::DICT);
+    EXPECT_EQ(td.length(), db::INT_SIZE + 1 + db::DOUBLE_SIZE);
+    EXPECT_THROW(plainDesc().withDictionary(0, dictionary), std::logic_error);
+    EXPECT_THROW(db::KeyDesc(td, {1}), std::logic_error);
+
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    constexpr int n = 5000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, statuses[i % statuses.size()], i * 1.0}});
+    }
+    // 13 bytes per tuple instead of 76.
+    EXPECT_LT(file.getNumPages(), n * 76 / db::DEFAULT_PAGE_SIZE / 4);
+    EXPECT_EQ(dictionary->size(), statuses.size());
+    EXPECT_EQ(std::get<std::string>((*file.begin()).get_field(1)), "active");
+
+    size_t rows = 0;
+    file.scanViews({{1, db::op_t::EQ, std::string("pending")}, {0, db::op_t::LT, 1000}}, [&](const db::TupleView &t) {
+        EXPECT_EQ(t.getString(1), "pending");
+        EXPECT_EQ(t.getCode(1), 2);
+        rows++;
+    });
+    EXPECT_EQ(rows, 250);
+    rows = 0;
+    file.scanViews({{1, db::op_t::NE, std::string("active")}}, [&](const db::TupleView &) { rows++; });
+    EXPECT_EQ(rows, n - n / 4);
+    rows = 0;
+    file.scanViews({{1, db::op_t::EQ, std::string("unknown")}}, [&](const db::TupleView &) { rows++; });
+    EXPECT_EQ(rows, 0);
+    rows = 0;
+    file.scanViews({{1, db::op_t::LT, std::string("closed")}}, [&](const db::TupleView &) { rows++; });
+    EXPECT_EQ(rows, n / 4);
+
+    // Group by code.
+    std::vector<size_t> counts(dictionary->size());
+    db::Batch batch(td, {1});
+    for (db::Iterator it = file.begin(); file.nextBatch(it, batch);) {
+        for (size_t i = 0; i < batch.size(); i++) {
+            counts[batch.codes(0)[i]]++;
+            EXPECT_EQ(batch.strings(0)[i], dictionary->decode(batch.codes(0)[i]));
+        }
+    }
+    EXPECT_EQ(counts, std::vector<size_t>(statuses.size(), n / 4));
+
+    db::TupleDesc projected = td.project({1});
+    std::vector<uint8_t> bytes(projected.length());
+    projected.serialize(bytes.data(), {{std::string("closed")}});
+    EXPECT_EQ(bytes[0], 1);
+
+    // The codes in the pages are decoded with the dictionary read back from its file.
+    db::getDatabase().remove(name);
+    db::TupleDesc reopened = plainDesc().withDictionary(1, std::make_shared<db::Dictionary>(path, 1));
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, reopened));
+    auto &again = db::getDatabase().get(name);
+    int i = 0;
+    for (auto it = again.begin(); it != again.end(); ++it, ++i) {
+        EXPECT_EQ(std::get<std::string>((*it).get_field(1)), statuses[i % statuses.size()]);
+    }
+    EXPECT_EQ(i, n);
+    db::getDatabase().remove(name);
+    std::remove(path.c_str());
+}
+
+TEST(DictionaryTest, BTree) {
+    const std::string name = testFile("btree.db");
+    std::remove(name.c_str());
+    db::TupleDesc td = plainDesc().withDictionary(1, std::make_shared<db::Dictionary>("", 2));
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    for (int i = 1000; i > 0; i--) {
+        file.insertTuple({{i, statuses[i % statuses.size()], 0.0}});
+    }
+    EXPECT_EQ(std::get<std::string>(file.find(7)->get_field(1)), statuses[7 % statuses.size()]);
+    int expected = 1;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_EQ(it.view().getString(1), statuses[expected++ % statuses.size()]);
+    }
+    EXPECT_EQ(expected, 1001);
+    db::getDatabase().remove(name);
+}
+
+TEST(DictionaryTest, Recover) {
+    const std::string name = testFile("recover.db");
+    const std::string path = testFile("recover.db.status");
+    const std::string log = testFile("recover.log");
+    for (const std::string &file: {name, path, log}) {
+        std::remove(file.c_str());
+    }
+    db::Database &database = db::getDatabase();
+    constexpr int n = 2000;
+
+    // Commit, then stop without writing the pages or closing the dictionary.
+    EXPECT_EXIT({
+        database.getBufferPool().openLog(log);
+        auto dictionary = std::make_shared<db::Dictionary>(path, 2);
+        database.add(std::make_unique<db::HeapFile>(name, plainDesc().withDictionary(1, dictionary)));
+        for (int i = 0; i < n; i++) {
+            database.get(name).insertTuple({{i, "status" + std::to_string(i % 100), 0.0}});
+        }
+        database.getBufferPool().commit();
+        std::_Exit(0);
+    }, ::testing::ExitedWithCode(0), "");
+
+    // The logged pages hold codes of values that reached the dictionary file.
+    database.getBufferPool().openLog(log);
+    auto dictionary = std::make_shared<db::Dictionary>(path, 2);
+    EXPECT_EQ(dictionary->size(), 100);
+    database.add(std::make_unique<db::HeapFile>(name, plainDesc().withDictionary(1, dictionary)));
+    int i = 0;
+    for (auto it = database.get(name).begin(); it != database.get(name).end(); ++it, ++i) {
+        EXPECT_EQ(std::get<std::string>((*it).get_field(1)), "status" + std::to_string(i % 100));
+    }
+    EXPECT_EQ(i, n);
+    database.remove(name);
+    std::remove(path.c_str());
+}
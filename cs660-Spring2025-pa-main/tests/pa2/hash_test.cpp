@@ -0,0 +1,95 @@
+#include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+TEST(HashFileTest, Empty) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 0));
+    auto &file = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+    EXPECT_EQ(file.begin(), file.end());
+    EXPECT_FALSE(file.find({{1}}));
+    EXPECT_FALSE(file.erase({{1}}));
+    EXPECT_THROW(file.find({{1.0}}), std::logic_error);
+}
+
+TEST(HashFileTest, InsertFindErase) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 0));
+    auto &file = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+    constexpr int n = 20000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "apple", i * 0.5}});
+    }
+    // 53 tuples fit in a bucket, so the directory had to grow.
+    EXPECT_GE(file.getGlobalDepth(), 9);
+    // Inserting an existing key replaces the tuple.
+    file.insertTuple({{42, "banana", 0.0}});
+    auto t = file.find({{42}});
+    ASSERT_TRUE(t);
+    EXPECT_EQ(std::get<std::string>(t->get_field(1)), "banana");
+    EXPECT_FALSE(file.find({{n}}));
+
+    for (int i = 0; i < n; i += 2) {
+        EXPECT_TRUE(file.erase({{i}}));
+    }
+    std::vector<bool> seen(n);
+    size_t count = 0;
+    for (const auto &tuple: file) {
+        int id = std::get<int>(tuple.get_field(0));
+        EXPECT_EQ(id % 2, 1);
+        EXPECT_FALSE(seen[id]);
+        seen[id] = true;
+        count++;
+    }
+    EXPECT_EQ(count, n / 2);
+}
+
+TEST(HashFileTest, PointReadsOnePage) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+    db::getDatabase().add(std::make_unique<db::HashFile>(name, td, std::vector<size_t>{1, 0}));
+    auto &file = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+    constexpr int n = 10000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "key" + std::to_string(i % 7)}});
+    }
+    db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+    bufferPool.flushFile(name);
+    bufferPool.discardFile(name);
+    for (int i = 0; i < n; i += 1000) {
+        size_t reads = file.getReads().size();
+        EXPECT_TRUE(file.find({{"key" + std::to_string(i % 7), i}}));
+        EXPECT_EQ(file.getReads().size() - reads, 1);
+    }
+}
+
+TEST(HashFileTest, Reopen) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"});
+    db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 0));
+    auto &file = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+    constexpr int n = 5000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, i * 2.0}});
+    }
+    size_t depth = file.getGlobalDepth();
+    db::getDatabase().remove(name);
+
+    db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 0));
+    auto &reopened = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+    EXPECT_EQ(reopened.getGlobalDepth(), depth);
+    for (int i = 0; i < n; i += 7) {
+        auto t = reopened.find({{i}});
+        ASSERT_TRUE(t);
+        EXPECT_EQ(std::get<double>(t->get_field(1)), i * 2.0);
+    }
+    reopened.insertTuple({{n, 0.0}});
+    EXPECT_TRUE(reopened.find({{n}}));
+}
@@ -0,0 +1,114 @@
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/IndexPage.hpp>
+#include <db/Key.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+TEST(KeyTest, NormalizedOrder) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::DOUBLE, db::type_t::CHAR}, {"id", "price", "name"});
+    db::KeyDesc kd(td, {0, 1, 2});
+    EXPECT_EQ(kd.normalizedSize(), db::INT_SIZE + db::DOUBLE_SIZE + db::CHAR_SIZE);
+
+    std::vector<db::Tuple> tuples{
+            {{-5, 1.0, "b"}},
+            {{-5, 2.5, "a"}},
+            {{0, -3.0, "z"}},
+            {{0, -0.5, "a"}},
+            {{0, 0.5, ""}},
+            {{0, 0.5, "a"}},
+            {{0, 0.5, "ab"}},
+            {{7, -1e9, "a"}},
+    };
+    for (size_t i = 1; i < tuples.size(); i++) {
+        EXPECT_LT(kd.normalize(tuples[i - 1]), kd.normalize(tuples[i]));
+    }
+
+    std::vector<uint8_t> buffer(td.length());
+    for (const auto &t: tuples) {
+        td.serialize(buffer.data(), t);
+        db::NormalizedKey key = kd.normalize(t);
+        EXPECT_EQ(kd.normalize(buffer.data()), key);
+        EXPECT_EQ(kd.compare(buffer.data(), key), 0);
+        // A key made of the leading field is a lower bound of every key that starts with it.
+        db::NormalizedKey prefix{key.bytes.substr(0, db::INT_SIZE)};
+        EXPECT_LT(prefix, key);
+        EXPECT_GT(kd.compare(buffer.data(), prefix), 0);
+    }
+}
+
+TEST(KeyTest, IndexPageFanout) {
+    db::Page page{};
+    EXPECT_EQ(db::BasicIndexPage<double>{page}.capacity, 255);
+    EXPECT_EQ(db::BasicIndexPage<db::NormalizedKey>(page, 2 * db::INT_SIZE).capacity, 255);
+    EXPECT_EQ(db::BasicIndexPage<db::NormalizedKey>(page, db::CHAR_SIZE).capacity, 56);
+}
+
+TEST(KeyTest, DoubleKey) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::BasicBTreeFile<double>>(name, td, 2));
+    auto &file = db::getDatabase().get(name);
+    for (int i = 0; i < 100000; i++) {
+        int k = i % 2 ? 100000 - i : i;
+        file.insertTuple({{k, "apple", (k - 50000) / 4.0}});
+    }
+    int i = 0;
+    for (const auto &t: file) {
+        EXPECT_EQ(std::get<double>(t.get_field(2)), (i - 50000) / 4.0);
+        EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+        i++;
+    }
+    EXPECT_EQ(i, 100000);
+    db::getDatabase().remove(name);
+}
+
+TEST(KeyTest, CharKey) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+    db::getDatabase().add(std::make_unique<db::BasicBTreeFile<db::NormalizedKey>>(name, td, 1));
+    auto &file = db::getDatabase().get(name);
+    std::vector<std::string> names;
+    for (int i = 0; i < 20000; i++) {
+        names.push_back("name" + std::to_string(i * 7919 % 20000));
+        file.insertTuple({{i, names.back()}});
+    }
+    std::sort(names.begin(), names.end());
+    size_t i = 0;
+    for (const auto &t: file) {
+        EXPECT_EQ(std::get<std::string>(t.get_field(1)), names[i]);
+        i++;
+    }
+    EXPECT_EQ(i, names.size());
+    db::getDatabase().remove(name);
+}
+
+TEST(KeyTest, CompositeKey) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::CHAR, db::type_t::INT, db::type_t::INT}, {"name", "a", "b"});
+    db::getDatabase().add(std::make_unique<db::BasicBTreeFile<db::NormalizedKey>>(name, td, std::vector<size_t>{1, 2}));
+    auto &file = db::getDatabase().get(name);
+    for (int b = 99; b >= -100; b--) {
+        for (int a = -100; a < 100; a++) {
+            file.insertTuple({{"x", a, b}});
+        }
+    }
+    int count = 0;
+    for (const auto &t: file) {
+        EXPECT_EQ(std::get<int>(t.get_field(1)), count / 200 - 100);
+        EXPECT_EQ(std::get<int>(t.get_field(2)), count % 200 - 100);
+        count++;
+    }
+    EXPECT_EQ(count, 40000);
+    db::getDatabase().remove(name);
+}
+
+TEST(KeyTest, KeyTypeMismatch) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+    EXPECT_THROW(db::BasicBTreeFile<double>(testFile("test.db"), td, 0), std::logic_error);
+    EXPECT_THROW(db::BTreeFile(testFile("test.db"), td, 1), std::logic_error);
+    EXPECT_THROW(db::BTreeFile(testFile("test.db"), td, std::vector<size_t>{0, 1}), std::logic_error);
+}
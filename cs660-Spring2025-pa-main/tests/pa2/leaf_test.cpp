@@ -131,3 +131,64 @@ TEST(LeafTest, Split) {
         EXPECT_EQ(t.get_field(0), db::field_t{(leaf.header->size + i) * 2});
     }
 }
+
+TEST(LeafTest, CompressedSplit) {
+    db::Page page{};
+    db::TupleDesc td({db::type_t::DOUBLE, db::type_t::INT}, {"price", "id"});
+    db::KeyDesc kd(td, {1});
+    db::LeafPage leaf{page, td, kd, false, true};
+    // A new page spans every int, so its keys take four bytes.
+    EXPECT_EQ(leaf.capacity, (db::DEFAULT_PAGE_SIZE - sizeof(db::LeafPageHeader) - sizeof(db::LeafFence)) / 12);
+    leaf.setFence(1000, 1256);
+    int capacity = leaf.capacity;
+    EXPECT_EQ(capacity, (db::DEFAULT_PAGE_SIZE - sizeof(db::LeafPageHeader) - sizeof(db::LeafFence)) / 9);
+    EXPECT_THROW(leaf.insertTuple({{1.0, 999}}), std::logic_error);
+    EXPECT_THROW(leaf.insertTuple({{1.0, 1256}}), std::logic_error);
+    EXPECT_THROW(leaf.getView(0), std::runtime_error);
+    for (int i = 0; i < 256; i++) {
+        EXPECT_FALSE(leaf.insertTuple({{i * 0.5, 1255 - i}}));
+    }
+    EXPECT_EQ(leaf.key(0), 1000);
+    EXPECT_EQ(leaf.lowerBound(1100), 100);
+    EXPECT_EQ(leaf.compare(100, 1100), 0);
+    EXPECT_THROW(leaf.tuple(0), std::logic_error);
+    EXPECT_THROW(leaf.getView(0), std::logic_error);
+
+    db::Page new_page{};
+    db::LeafPage new_leaf{new_page, td, kd, false, true};
+    EXPECT_EQ(leaf.split(new_leaf), 1128);
+    EXPECT_EQ(leaf.bounds().low, 1000);
+    EXPECT_EQ(leaf.bounds().high, 1128);
+    EXPECT_EQ(new_leaf.bounds().low, 1128);
+    EXPECT_EQ(new_leaf.bounds().high, 1256);
+    // Both halves still need one byte per key.
+    EXPECT_EQ(new_leaf.capacity, capacity);
+    for (int i = 0; i < leaf.header->size; i++) {
+        EXPECT_EQ(leaf.getTuple(i).get_field(0), db::field_t{(255 - i) * 0.5});
+        EXPECT_EQ(leaf.getTuple(i).get_field(1), db::field_t{1000 + i});
+    }
+    for (int i = 0; i < new_leaf.header->size; i++) {
+        EXPECT_EQ(new_leaf.getTuple(i).get_field(1), db::field_t{1128 + i});
+    }
+    EXPECT_THROW(new_leaf.insertTuple({{1.0, 1127}}), std::logic_error);
+
+    // Narrowing the fence further re-encodes the keys in place.
+    leaf.remove(0);
+    leaf.setFence(1001, 1128);
+    db::Page buffer;
+    EXPECT_EQ(td.deserialize(leaf.row(0, buffer)).get_field(1), db::field_t{1001});
+    // A fence around a single key leaves no key bytes at all.
+    EXPECT_EQ(new_leaf.capacityFor(1128, 1129), (db::DEFAULT_PAGE_SIZE - sizeof(db::LeafPageHeader) - sizeof(db::LeafFence)) / 8);
+}
+
+TEST(LeafTest, TornSize) {
+    // An optimistic reader may see a size beyond the capacity: constructing the leaf must leave it alone.
+    db::Page page{};
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    reinterpret_cast<db::LeafPageHeader *>(page.data())->size = 1000;
+    db::Page before = page;
+    db::LeafPage leaf{page, td, 0};
+    EXPECT_EQ(page, before);
+    EXPECT_EQ(leaf.size(), leaf.capacity);
+    EXPECT_LE(leaf.lowerBound(1), leaf.capacity);
+}
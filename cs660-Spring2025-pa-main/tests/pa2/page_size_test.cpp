@@ -0,0 +1,52 @@
+#include <db/Database.hpp>
+#include <db/DbFile.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+TEST(PageSizeTest, SizeClasses) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    db::TupleDesc td;
+    EXPECT_THROW(db::DbFile(testFile("small"), td, db::DEFAULT_PAGE_SIZE / 2), std::logic_error);
+    EXPECT_THROW(db::DbFile(testFile("odd"), td, 3 * db::DEFAULT_PAGE_SIZE), std::logic_error);
+
+    std::string small = testFile("small");
+    std::string large = testFile("large");
+    std::remove(small.c_str());
+    std::remove(large.c_str());
+    db.add(std::make_unique<db::DbFile>(small, td));
+    db.add(std::make_unique<db::DbFile>(large, td, db::MAX_PAGE_SIZE));
+    EXPECT_EQ(db.get(large).getPageSize(), db::MAX_PAGE_SIZE);
+
+    // Pin every frame of the large pages: pages of the other size class are still available.
+    std::vector<db::PinnedPage> pinned;
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        pinned.emplace_back(bufferPool, db::PageId{large, i});
+        std::fill_n((*pinned.back()).data(), db::MAX_PAGE_SIZE, static_cast<uint8_t>(i));
+        pinned.back().markDirty();
+    }
+    EXPECT_THROW(bufferPool.pinPage({large, db::DEFAULT_NUM_PAGES}), std::runtime_error);
+    for (size_t i = 0; i < 2 * db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({small, i});
+    }
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        EXPECT_TRUE(bufferPool.contains({large, i}));
+        EXPECT_EQ((*pinned[i]).data()[db::MAX_PAGE_SIZE - 1], i);
+    }
+
+    // Evicted large pages are written and read back whole.
+    pinned.clear();
+    for (size_t i = db::DEFAULT_NUM_PAGES; i < 2 * db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({large, i});
+    }
+    EXPECT_EQ(db.get(large).getWrites().size(), db::DEFAULT_NUM_PAGES);
+    db::Page &page = bufferPool.getPage({large, 7});
+    EXPECT_EQ(page.data()[0], 7);
+    EXPECT_EQ(page.data()[db::MAX_PAGE_SIZE - 1], 7);
+    db.remove(small);
+    db.remove(large);
+
+    // The file remembers its page size.
+    EXPECT_THROW(db::DbFile(large, td), std::runtime_error);
+    EXPECT_NO_THROW(db::DbFile(large, td, db::MAX_PAGE_SIZE));
+}
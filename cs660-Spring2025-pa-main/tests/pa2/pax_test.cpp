@@ -0,0 +1,84 @@
+#include <db/Database.hpp>
+#include <db/PaxFile.hpp>
+#include <db/PaxPage.hpp>
+#include <gtest/gtest.h>
+#include <cstring>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc paxDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"}};
+    }
+} // namespace
+
+TEST(PaxTest, Page) {
+    db::TupleDesc td = paxDesc();
+    db::Page page{};
+    db::PaxPage pp(page, td);
+    EXPECT_EQ(pp.begin(), pp.end());
+    size_t n = 0;
+    while (pp.insertTuple({{static_cast<int>(n), "x" + std::to_string(n), n * 0.5}})) {
+        n++;
+    }
+    // PAX pages hold as many tuples as heap pages.
+    EXPECT_EQ(n, 4096 * 8 / (td.length() * 8 + 1));
+    pp.deleteTuple(3);
+    EXPECT_THROW(pp.deleteTuple(3), std::runtime_error);
+    size_t slot;
+    ASSERT_TRUE(pp.insertTuple({{-3, "y", 0.0}}, &slot));
+    EXPECT_EQ(slot, 3);
+
+    // The values of a field are contiguous.
+    for (size_t s = 0; s < n; s++) {
+        int id;
+        std::memcpy(&id, pp.column(0) + s * pp.width(0), sizeof(id));
+        EXPECT_EQ(id, s == 3 ? -3 : static_cast<int>(s));
+    }
+    db::Tuple t = pp.getTuple(10);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), "x10");
+    EXPECT_EQ(std::get<double>(t.get_field(2)), 5.0);
+    EXPECT_THROW(db::PaxPage(page, db::TupleDesc({db::type_t::VARCHAR}, {"v"})), std::logic_error);
+}
+
+TEST(PaxTest, File) {
+    const std::string name = testFile("pax.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::PaxFile>(name, paxDesc()));
+    auto &file = dynamic_cast<db::PaxFile &>(db::getDatabase().get(name));
+    EXPECT_EQ(file.begin(), file.end());
+    constexpr int n = 3000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "name", i * 1.0}});
+    }
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        if (std::get<int>((*it).get_field(0)) % 3 == 0) {
+            file.deleteTuple(it);
+        }
+    }
+    long sum = 0;
+    size_t count = 0;
+    file.scanColumn(0, [&](const uint8_t *value) {
+        int id;
+        std::memcpy(&id, value, sizeof(id));
+        sum += id;
+        count++;
+    });
+    long expected = 0;
+    for (int i = 0; i < n; i++) {
+        expected += i % 3 ? i : 0;
+    }
+    EXPECT_EQ(count, n - n / 3);
+    EXPECT_EQ(sum, expected);
+
+    int previous = -1;
+    size_t rows = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        int id = std::get<int>((*it).get_field(0));
+        EXPECT_GT(id, previous);
+        EXPECT_EQ(std::get<double>((*it).get_field(2)), id * 1.0);
+        previous = id;
+        rows++;
+    }
+    EXPECT_EQ(rows, count);
+    EXPECT_THROW(file.scanColumn(3, [](const uint8_t *) {}), std::out_of_range);
+}
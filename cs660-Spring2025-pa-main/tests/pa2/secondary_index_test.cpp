@@ -0,0 +1,138 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/SecondaryIndex.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc heapDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"}};
+    }
+
+    const char *names[] = {"apple", "banana", "cherry"};
+} // namespace
+
+TEST(SecondaryIndexTest, Build) {
+    const std::string heap_name = testFile("heap.db");
+    const std::string index_name = testFile("heap.name.idx");
+    std::remove(heap_name.c_str());
+    std::remove(index_name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, heapDesc()));
+    auto &heap = dynamic_cast<db::HeapFile &>(db::getDatabase().get(heap_name));
+    constexpr int n = 3000;
+    for (int i = 0; i < n; i++) {
+        heap.insertTuple({{i, names[i % 3], i * 0.5}});
+    }
+    db::getDatabase().add(std::make_unique<db::SecondaryIndex>(index_name, heap, std::vector<size_t>{1}));
+    auto &index = dynamic_cast<db::SecondaryIndex &>(db::getDatabase().get(index_name));
+    heap.addIndex(index);
+
+    auto bananas = index.lookup({{std::string("banana")}});
+    ASSERT_EQ(bananas.size(), n / 3);
+    for (size_t i = 0; i < bananas.size(); i++) {
+        // Equal keys are ordered by record id, which is insertion order for this heap.
+        EXPECT_EQ(std::get<int>(bananas[i].get_field(0)), static_cast<int>(i * 3 + 1));
+    }
+    EXPECT_TRUE(index.lookup({{std::string("durian")}}).empty());
+    EXPECT_EQ(index.range({{std::string("b")}}, {{std::string("c")}}).size(), n / 3);
+    EXPECT_EQ(index.range({{std::string("apple")}}, {{std::string("banana")}}).size(), 2 * n / 3);
+    EXPECT_THROW(index.lookup({{1}}), std::logic_error);
+}
+
+TEST(SecondaryIndexTest, Maintained) {
+    const std::string heap_name = testFile("heap.db");
+    const std::string index_name = testFile("heap.id.idx");
+    std::remove(heap_name.c_str());
+    std::remove(index_name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, heapDesc()));
+    auto &heap = dynamic_cast<db::HeapFile &>(db::getDatabase().get(heap_name));
+    db::getDatabase().add(std::make_unique<db::SecondaryIndex>(index_name, heap, std::vector<size_t>{0, 1}));
+    auto &index = dynamic_cast<db::SecondaryIndex &>(db::getDatabase().get(index_name));
+    heap.addIndex(index);
+
+    constexpr int n = 2000;
+    for (int i = 0; i < n; i++) {
+        heap.insertTuple({{i % 500, names[i % 3], i * 0.5}});
+    }
+    EXPECT_EQ(index.lookup({{7}}).size(), 4);
+    EXPECT_EQ(index.lookup({{7, std::string("banana")}}).size(), 2);
+
+    // Delete every tuple with an even id.
+    for (auto it = heap.begin(); it != heap.end(); ++it) {
+        if (std::get<int>((*it).get_field(0)) % 2 == 0) {
+            heap.deleteTuple(it);
+        }
+    }
+    EXPECT_TRUE(index.lookup({{8}}).empty());
+    EXPECT_EQ(index.lookup({{7}}).size(), 4);
+    size_t entries = 0;
+    for (auto it = index.begin(); it != index.end(); ++it) {
+        entries++;
+    }
+    EXPECT_EQ(entries, n / 2);
+
+    // Slots freed by the deletes are reused, and the index points to the new tuples.
+    heap.insertTuple({{8, "durian", 1.0}});
+    auto found = index.lookup({{8}});
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(std::get<std::string>(found[0].get_field(1)), "durian");
+    heap.dropIndex(index);
+}
+
+TEST(SecondaryIndexTest, Reattach) {
+    const std::string heap_name = testFile("heap.db");
+    const std::string index_name = testFile("heap.name.idx");
+    std::remove(heap_name.c_str());
+    std::remove(index_name.c_str());
+    db::Database &database = db::getDatabase();
+    database.add(std::make_unique<db::HeapFile>(heap_name, heapDesc()));
+    auto &heap = dynamic_cast<db::HeapFile &>(database.get(heap_name));
+    database.add(std::make_unique<db::SecondaryIndex>(index_name, heap, std::vector<size_t>{1}));
+    heap.addIndex(dynamic_cast<db::SecondaryIndex &>(database.get(index_name)));
+    constexpr int n = 900;
+    for (int i = 0; i < n; i++) {
+        heap.insertTuple({{i, names[i % 3], i * 0.5}});
+    }
+    heap.dropIndex(dynamic_cast<db::SecondaryIndex &>(database.get(index_name)));
+    database.remove(index_name);
+    database.remove(heap_name);
+
+    // The reopened index already has its entries: it is attached without being built again.
+    database.add(std::make_unique<db::HeapFile>(heap_name, heapDesc()));
+    auto &reopened = dynamic_cast<db::HeapFile &>(database.get(heap_name));
+    database.add(std::make_unique<db::SecondaryIndex>(index_name, reopened, std::vector<size_t>{1}));
+    auto &index = dynamic_cast<db::SecondaryIndex &>(database.get(index_name));
+    reopened.addIndex(index);
+    EXPECT_EQ(index.lookup({{std::string("cherry")}}).size(), n / 3);
+    reopened.insertTuple({{n, "cherry", 0.0}});
+    EXPECT_EQ(index.lookup({{std::string("cherry")}}).size(), n / 3 + 1);
+    reopened.dropIndex(index);
+    database.remove(index_name);
+    database.remove(heap_name);
+}
+
+TEST(SecondaryIndexTest, FetchesOnlyHitPages) {
+    const std::string heap_name = testFile("heap.db");
+    const std::string index_name = testFile("heap.id.idx");
+    std::remove(heap_name.c_str());
+    std::remove(index_name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, heapDesc()));
+    auto &heap = dynamic_cast<db::HeapFile &>(db::getDatabase().get(heap_name));
+    constexpr int n = 5000;
+    for (int i = 0; i < n; i++) {
+        heap.insertTuple({{i, "apple", 0.0}});
+    }
+    db::getDatabase().add(std::make_unique<db::SecondaryIndex>(index_name, heap, std::vector<size_t>{0}));
+    auto &index = dynamic_cast<db::SecondaryIndex &>(db::getDatabase().get(index_name));
+    heap.addIndex(index);
+
+    db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+    bufferPool.flushFile(heap_name);
+    bufferPool.discardFile(heap_name);
+    size_t reads = heap.getReads().size();
+    auto found = index.range({{1000}}, {{1009}});
+    ASSERT_EQ(found.size(), 10);
+    // 53 tuples fit in a heap page, so the range spans at most two pages.
+    EXPECT_LE(heap.getReads().size() - reads, 2);
+    EXPECT_GT(heap.getNumPages(), 90);
+}
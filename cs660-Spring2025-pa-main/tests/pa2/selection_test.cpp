@@ -0,0 +1,80 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Selection.hpp>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc selectionDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"}};
+    }
+} // namespace
+
+TEST(SelectionTest, Filter) {
+    // Rows of an INT and a DOUBLE, 12 bytes apart, with every other slot of the bitmap occupied.
+    constexpr size_t size = 203;
+    constexpr size_t stride = 12;
+    std::vector<uint8_t> rows(size * stride);
+    std::vector<uint8_t> bitmap((size + 7) / 8, 0xaa);
+    std::mt19937 rng(1);
+    for (size_t s = 0; s < size; s++) {
+        int i = static_cast<int>(rng() % 21) - 10;
+        double d = i * 0.5;
+        std::memcpy(rows.data() + s * stride, &i, sizeof(i));
+        std::memcpy(rows.data() + s * stride + 4, &d, sizeof(d));
+    }
+    for (db::op_t op: {db::op_t::EQ, db::op_t::NE, db::op_t::LT, db::op_t::LE, db::op_t::GT, db::op_t::GE}) {
+        db::Selection ints(bitmap.data(), size);
+        ints.filter({0, op, 3}, rows.data(), stride);
+        db::Selection doubles(bitmap.data(), size);
+        doubles.filter({2, op, 1.5}, rows.data() + 4, stride);
+        size_t expected = 0;
+        for (size_t s = 0; s < size; s++) {
+            int i;
+            std::memcpy(&i, rows.data() + s * stride, sizeof(i));
+            bool match = s % 2 == 0 && db::compare(op, i, 3);
+            EXPECT_EQ(ints.test(s), match);
+            EXPECT_EQ(doubles.test(s), match);
+            expected += match;
+        }
+        EXPECT_EQ(ints.count(), expected);
+        size_t visited = 0;
+        ints.forEach([&](size_t s) {
+            EXPECT_TRUE(ints.test(s));
+            visited++;
+        });
+        EXPECT_EQ(visited, expected);
+    }
+    db::Selection selection(bitmap.data(), size);
+    EXPECT_THROW(selection.filter({1, db::op_t::EQ, std::string("x")}, rows.data(), stride), std::logic_error);
+}
+
+TEST(SelectionTest, Scan) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, selectionDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    constexpr int n = 3000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, i % 3 ? "b" : "a", (i % 100) * 1.0}});
+    }
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        if (it.view().getInt(0) % 7 == 0) {
+            file.deleteTuple(it);
+        }
+    }
+
+    std::vector<db::Predicate> predicates{
+            {0, db::op_t::GE, 100}, {2, db::op_t::LT, 50.0}, {1, db::op_t::EQ, std::string("a")}};
+    std::vector<int> expected;
+    for (int i = 0; i < n; i++) {
+        if (i % 7 != 0 && i >= 100 && i % 100 < 50 && i % 3 == 0) {
+            expected.push_back(i);
+        }
+    }
+    std::vector<int> found;
+    file.scanViews(predicates, [&](const db::TupleView &t) { found.push_back(t.getInt(0)); });
+    EXPECT_EQ(found, expected);
+}
@@ -0,0 +1,48 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/StaticTupleDesc.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+namespace {
+    using Schema = db::StaticTupleDesc<int, double, db::Char<64>>;
+
+    static_assert(Schema::length() == db::INT_SIZE + db::DOUBLE_SIZE + db::CHAR_SIZE);
+    static_assert(Schema::offsets[2] == db::INT_SIZE + db::DOUBLE_SIZE);
+} // namespace
+
+TEST(StaticTupleDescTest, SameLayout) {
+    db::TupleDesc td = Schema::desc({"id", "price", "name"});
+    EXPECT_TRUE(Schema::matches(td));
+    EXPECT_FALSE(Schema::matches({{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"a", "b", "c"}}));
+
+    // Bytes written by one schema are read back by the other.
+    db::Tuple t({1, 2.5, "apple"});
+    std::vector<uint8_t> runtime(td.length());
+    std::vector<uint8_t> compiled(Schema::length());
+    td.serialize(runtime.data(), t);
+    Schema::serialize(compiled.data(), t);
+    EXPECT_EQ(runtime, compiled);
+
+    Schema::serialize(compiled.data(), 7, 0.5, "pear");
+    EXPECT_EQ(Schema::get<0>(compiled.data()), 7);
+    EXPECT_EQ(Schema::get<2>(compiled.data()), "pear");
+    EXPECT_EQ(Schema::deserialize(compiled.data()), (Schema::value_type{7, 0.5, "pear"}));
+    db::Tuple back = td.deserialize(compiled.data());
+    EXPECT_EQ(std::get<std::string>(back.get_field(2)), "pear");
+    EXPECT_EQ(std::get<double>(Schema::toTuple(runtime.data()).get_field(1)), 2.5);
+    EXPECT_THROW(Schema::serialize(compiled.data(), db::Tuple({1, 2, "x"})), std::logic_error);
+}
+
+TEST(StaticTupleDescTest, SharedFile) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, Schema::desc({"id", "price", "name"})));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    for (int i = 0; i < 500; i++) {
+        file.insertTuple({{i, i * 2.0, std::to_string(i)}});
+    }
+    double sum = 0;
+    file.scanViews({}, [&](const db::TupleView &t) { sum += Schema::get<1>(t.bytes()); });
+    EXPECT_EQ(sum, 499 * 500);
+}
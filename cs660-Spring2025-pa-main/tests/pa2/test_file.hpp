@@ -0,0 +1,15 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <string>
+
+/**
+ * @brief Get the name of a file used by the running test
+ * @details The name is prefixed with the suite and the name of the test, so that tests running in parallel (each in
+ * its own process, see gtest_discover_tests) never share a file.
+ * @param file the name of the file within the test
+ */
+inline std::string testFile(const std::string &file) {
+    const ::testing::TestInfo *info = ::testing::UnitTest::GetInstance()->current_test_info();
+    return std::string(info->test_suite_name()) + "." + info->name() + "." + file;
+}
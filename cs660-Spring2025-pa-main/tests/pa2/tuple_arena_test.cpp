@@ -0,0 +1,49 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/TupleArena.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+TEST(TupleArenaTest, Copies) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::VARCHAR, db::type_t::CHAR}, {"id", "note", "name"});
+    db::TupleArena arena(64);
+    std::pmr::vector<db::TupleView> rows(arena.resource());
+    for (int i = 0; i < 100; i++) {
+        rows.push_back(arena.copy(td, {{i, std::string(i, 'v'), "name" + std::to_string(i)}}));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(rows[i].getInt(0), i);
+        EXPECT_EQ(rows[i].getString(1), std::string(i, 'v'));
+        EXPECT_EQ(rows[i].getString(2), "name" + std::to_string(i));
+    }
+    EXPECT_EQ(arena.copy(std::string_view("text")), "text");
+    EXPECT_GT(arena.size(), 100 * td.length());
+
+    rows = std::pmr::vector<db::TupleView>(arena.resource());
+    arena.release();
+    EXPECT_EQ(arena.size(), 0);
+    EXPECT_EQ(arena.copy(td, {{1, "", ""}}).getInt(0), 1);
+}
+
+TEST(TupleArenaTest, Scan) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    // Many more pages than the buffer pool holds, so the pages of the first rows are evicted during the scan.
+    constexpr int n = 10000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "name" + std::to_string(i)}});
+    }
+    ASSERT_GT(file.getNumPages(), 2 * db::DEFAULT_NUM_PAGES);
+
+    db::TupleArena arena;
+    std::pmr::vector<db::TupleView> rows(arena.resource());
+    file.scanViews({{0, db::op_t::LT, n / 2}}, [&](const db::TupleView &t) { rows.push_back(arena.copy(t)); });
+    ASSERT_EQ(rows.size(), n / 2);
+    for (int i = 0; i < n / 2; i++) {
+        EXPECT_EQ(rows[i].getInt(0), i);
+        EXPECT_EQ(rows[i].getString(1), "name" + std::to_string(i));
+    }
+}
@@ -0,0 +1,69 @@
+#include <db/Cursor.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+TEST(TupleReuseTest, Construction) {
+    std::vector<db::field_t> fields{1, std::string(100, 'x'), 2.5};
+    const char *chars = std::get<std::string>(fields[1]).data();
+    db::Tuple moved(std::move(fields));
+    EXPECT_EQ(std::get<std::string>(moved.get_field(1)).data(), chars);
+
+    db::Tuple in_place(std::in_place, 7, std::string("apple"), 2.5);
+    EXPECT_EQ(in_place.size(), 3);
+    EXPECT_EQ(in_place.field_type(1), db::type_t::CHAR);
+
+    in_place.set_field(1, std::string("pear"));
+    in_place.set_field(0, 8);
+    EXPECT_EQ(in_place.get_field(0), db::field_t(8));
+    EXPECT_EQ(in_place.get_field(1), db::field_t(std::string("pear")));
+    EXPECT_THROW(in_place.set_field(3, 0), std::out_of_range);
+}
+
+TEST(TupleReuseTest, DeserializeInto) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::VARCHAR}, {"id", "name", "note"});
+    std::vector<uint8_t> bytes(td.max_length());
+    db::Tuple t(std::vector<db::field_t>{});
+    td.serialize(bytes.data(), {{1, std::string(db::CHAR_SIZE, 'n'), std::string(100, 'v')}});
+    td.deserialize(bytes.data(), t);
+    const char *name = std::get<std::string>(t.get_field(1)).data();
+    const char *note = std::get<std::string>(t.get_field(2)).data();
+
+    // Shorter strings are written over the ones the Tuple already holds.
+    td.serialize(bytes.data(), {{2, "short", "note"}});
+    td.deserialize(bytes.data(), t);
+    EXPECT_EQ(t.get_field(0), db::field_t(2));
+    EXPECT_EQ(t.get_field(1), db::field_t(std::string("short")));
+    EXPECT_EQ(t.get_field(2), db::field_t(std::string("note")));
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)).data(), name);
+    EXPECT_EQ(std::get<std::string>(t.get_field(2)).data(), note);
+}
+
+TEST(TupleReuseTest, Scan) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, db::TupleDesc({db::type_t::INT, db::type_t::DOUBLE},
+                                                                              {"id", "price"})));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    db::Tuple row(std::in_place, 0, 0.0);
+    for (int i = 0; i < 1000; i++) {
+        row.set_field(0, i);
+        row.set_field(1, i * 0.5);
+        file.insertTuple(row);
+    }
+
+    db::Tuple t(std::vector<db::field_t>{});
+    int expected = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        file.getTuple(it, t);
+        EXPECT_EQ(t.get_field(0), db::field_t(expected++));
+    }
+    EXPECT_EQ(expected, 1000);
+    expected = 0;
+    for (auto c = file.cursor(); c->valid(); c->next()) {
+        c->get(t);
+        EXPECT_EQ(t.get_field(1), db::field_t(expected++ * 0.5));
+    }
+    EXPECT_EQ(expected, 1000);
+}
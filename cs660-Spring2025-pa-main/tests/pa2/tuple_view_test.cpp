@@ -0,0 +1,115 @@
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc viewDesc() {
+        return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"}};
+    }
+} // namespace
+
+TEST(TupleViewTest, Fields) {
+    db::TupleDesc td = viewDesc();
+    std::vector<uint8_t> bytes(td.length());
+    td.serialize(bytes.data(), {{7, "apple", 2.5}});
+    db::TupleView view(td, bytes.data());
+    EXPECT_EQ(view.size(), 3);
+    EXPECT_EQ(view.getInt(0), 7);
+    EXPECT_EQ(view.getString(1), "apple");
+    EXPECT_EQ(view.getDouble(2), 2.5);
+    EXPECT_THROW(view.getInt(2), std::logic_error);
+    EXPECT_EQ(std::get<std::string>(view.get_field(1)), "apple");
+    EXPECT_EQ(view.toTuple().get_field(2), db::field_t(2.5));
+
+    EXPECT_TRUE((db::Predicate{0, db::op_t::EQ, 7}.matches(view)));
+    EXPECT_TRUE((db::Predicate{1, db::op_t::LT, std::string("banana")}.matches(view)));
+    EXPECT_FALSE((db::Predicate{1, db::op_t::GT, std::string("apple")}.matches(view)));
+    EXPECT_FALSE((db::Predicate{2, db::op_t::GT, 2.5}.matches(view)));
+}
+
+TEST(TupleViewTest, Scan) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, viewDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    constexpr int n = 1000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, i % 2 ? "odd" : "even", i * 0.5}});
+    }
+
+    int sum = 0;
+    size_t rows = 0;
+    file.scanViews({{1, db::op_t::EQ, std::string("odd")}, {2, db::op_t::LT, 100.0}}, [&](const db::TupleView &t) {
+        sum += t.getInt(0);
+        rows++;
+    });
+    EXPECT_EQ(rows, 100);
+    EXPECT_EQ(sum, 100 * 100);
+
+    size_t count = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_EQ(it.view().getInt(0), static_cast<int>(count));
+        count++;
+    }
+    EXPECT_EQ(count, n);
+}
+
+TEST(TupleViewTest, BTree) {
+    const std::string name = testFile("btree.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, viewDesc(), 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    for (int i = 0; i < 500; i++) {
+        file.insertTuple({{(i * 7) % 500, "x", 0.0}});
+    }
+    int expected = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_EQ(it.view().getInt(0), expected++);
+    }
+    EXPECT_EQ(expected, 500);
+}
+
+TEST(TupleViewTest, Projection) {
+    db::TupleDesc td = viewDesc();
+    std::vector<uint8_t> bytes(td.length());
+    td.serialize(bytes.data(), {{7, "apple", 2.5}});
+    db::Tuple t = td.deserialize(bytes.data(), {2, 0});
+    ASSERT_EQ(t.size(), 2);
+    EXPECT_EQ(t.get_field(0), db::field_t(2.5));
+    EXPECT_EQ(t.get_field(1), db::field_t(7));
+    EXPECT_THROW(td.deserialize(bytes.data(), {3}), std::out_of_range);
+
+    db::TupleDesc projected = td.project({2, 1});
+    EXPECT_EQ(projected.type_of(0), db::type_t::DOUBLE);
+    EXPECT_EQ(projected.index_of("name"), 1);
+    EXPECT_TRUE(projected.compatible(td.deserialize(bytes.data(), {2, 1})));
+    EXPECT_THROW(td.project({1, 1}), std::logic_error);
+
+    // A reused buffer keeps its strings and overwrites them.
+    std::vector<db::field_t> fields;
+    td.deserialize(bytes.data(), {1}, fields);
+    const char *chars = std::get<std::string>(fields[0]).data();
+    td.serialize(bytes.data(), {{8, "pear", 1.0}});
+    td.deserialize(bytes.data(), {1}, fields);
+    EXPECT_EQ(std::get<std::string>(fields[0]), "pear");
+    EXPECT_EQ(std::get<std::string>(fields[0]).data(), chars);
+}
+
+TEST(TupleViewTest, ProjectedScan) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, viewDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    for (int i = 0; i < 1000; i++) {
+        file.insertTuple({{i, "name" + std::to_string(i % 10), i * 0.5}});
+    }
+    std::vector<std::string> names;
+    file.scan({{0, db::op_t::LT, 3}}, {1}, [&](const std::vector<db::field_t> &fields) {
+        ASSERT_EQ(fields.size(), 1);
+        names.push_back(std::get<std::string>(fields[0]));
+    });
+    EXPECT_EQ(names, (std::vector<std::string>{"name0", "name1", "name2"}));
+    EXPECT_THROW(file.scan({}, {3}, [](const std::vector<db::field_t> &) {}), std::out_of_range);
+}
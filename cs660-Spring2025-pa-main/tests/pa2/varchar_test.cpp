@@ -0,0 +1,152 @@
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/HeapPage.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "test_file.hpp"
+
+namespace {
+    db::TupleDesc varcharDesc() {
+        return {{db::type_t::INT, db::type_t::VARCHAR, db::type_t::DOUBLE, db::type_t::VARCHAR},
+                {"id", "name", "price", "note"}};
+    }
+
+    std::string text(int i) { return std::string(i % 40, static_cast<char>('a' + i % 26)); }
+} // namespace
+
+TEST(VarcharTest, Encoding) {
+    db::TupleDesc td = varcharDesc();
+    EXPECT_TRUE(td.variable_length());
+    EXPECT_EQ(td.length(), db::INT_SIZE + db::DOUBLE_SIZE + 2 * db::VARCHAR_SLOT_SIZE);
+    EXPECT_EQ(td.max_length(), td.length() + 2 * (2 + db::VARCHAR_SIZE));
+
+    db::Tuple t({7, "apple", 2.5, ""});
+    EXPECT_TRUE(td.compatible(t));
+    ASSERT_EQ(td.length(t), td.length() + 2 + 5 + 2);
+    std::vector<uint8_t> bytes(td.length(t));
+    td.serialize(bytes.data(), t);
+    EXPECT_EQ(td.length(bytes.data()), bytes.size());
+    db::Tuple back = td.deserialize(bytes.data());
+    EXPECT_EQ(std::get<std::string>(back.get_field(1)), "apple");
+    EXPECT_EQ(std::get<std::string>(back.get_field(3)), "");
+    EXPECT_EQ(std::get<double>(back.get_field(2)), 2.5);
+    EXPECT_EQ(db::TupleView(td, bytes.data()).getString(1), "apple");
+    EXPECT_EQ(std::get<std::string>(td.deserialize(bytes.data(), {1}).get_field(0)), "apple");
+
+    EXPECT_THROW(td.length(db::Tuple({1, std::string(db::VARCHAR_SIZE + 1, 'x'), 0.0, ""})), std::logic_error);
+    EXPECT_THROW(db::KeyDesc(td, {1}), std::logic_error);
+}
+
+TEST(VarcharTest, HeapFile) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, varcharDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    constexpr int n = 5000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "name" + std::to_string(i), i * 0.5, text(i)}});
+    }
+    // The same rows with two CHAR fields would take 144 bytes each, or 28 per page.
+    EXPECT_LT(file.getNumPages(), n / 28 / 2);
+
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        if (std::get<int>((*it).get_field(0)) % 2 == 0) {
+            file.deleteTuple(it);
+        }
+    }
+    for (int i = 0; i < n; i += 2) {
+        file.insertTuple({{i, "name" + std::to_string(i), i * 0.5, text(i)}});
+    }
+    std::vector<bool> seen(n);
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        db::Tuple t = *it;
+        int i = std::get<int>(t.get_field(0));
+        EXPECT_EQ(std::get<std::string>(t.get_field(1)), "name" + std::to_string(i));
+        EXPECT_EQ(std::get<std::string>(t.get_field(3)), text(i));
+        EXPECT_FALSE(seen[i]);
+        seen[i] = true;
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), n);
+}
+
+TEST(VarcharTest, HeapPage) {
+    db::TupleDesc td = varcharDesc();
+    db::Page page{};
+    db::HeapPage hp(page, td);
+    size_t slot;
+    int n = 0;
+    while (hp.insertTuple({{n, text(n), 0.0, ""}}, &slot)) {
+        EXPECT_EQ(slot, n);
+        n++;
+    }
+    // Deleted tuples leave holes that are reclaimed by compacting the page, and their slots are reused.
+    for (int i = 0; i < n; i += 2) {
+        hp.deleteTuple(i);
+    }
+    for (int i = 0; i < n; i += 2) {
+        ASSERT_TRUE(hp.insertTuple({{-i, text(i), 0.0, ""}}, &slot));
+        EXPECT_EQ(slot, i);
+    }
+    EXPECT_FALSE(hp.insertTuple({{n, text(n), 0.0, ""}}));
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(std::get<int>(hp.getTuple(i).get_field(0)), i % 2 ? i : -i);
+        EXPECT_EQ(hp.getView(i).getString(1), text(i));
+    }
+}
+
+TEST(VarcharTest, BTree) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, varcharDesc(), 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    constexpr int n = 20000;
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    for (int i: keys) {
+        // Long notes make the leaves split by bytes rather than by count.
+        std::string note(i % 7 == 0 ? db::VARCHAR_SIZE : i % 20, 'x');
+        file.insertTuple({{i, text(i), 1.0, note}});
+    }
+    // Replacing a tuple with a longer one.
+    file.insertTuple({{5, "replaced", 2.0, std::string(db::VARCHAR_SIZE, 'y')}});
+
+    int expected = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        db::TupleView t = it.view();
+        ASSERT_EQ(t.getInt(0), expected);
+        if (expected != 5) {
+            EXPECT_EQ(t.getString(1), text(expected));
+        }
+        expected++;
+    }
+    EXPECT_EQ(expected, n);
+    EXPECT_EQ(std::get<std::string>(file.find(5)->get_field(1)), "replaced");
+    EXPECT_TRUE(file.erase(42));
+    EXPECT_FALSE(file.find(42).has_value());
+    EXPECT_EQ(std::get<std::string>(file.find(43)->get_field(1)), text(43));
+}
+
+TEST(VarcharTest, BulkLoad) {
+    const std::string name = testFile("test.db");
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, varcharDesc(), 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+    constexpr int n = 10000;
+    std::vector<db::Tuple> tuples;
+    for (int i = 0; i < n; i++) {
+        tuples.push_back({{i, text(i), 0.0, ""}});
+    }
+    file.bulkLoad(tuples);
+    for (int i = n; i < n + 1000; i++) {
+        file.insertTuple({{i, text(i), 0.0, std::string(db::VARCHAR_SIZE, 'z')}});
+    }
+    int expected = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_EQ(it.view().getInt(0), expected++);
+    }
+    EXPECT_EQ(expected, n + 1000);
+    EXPECT_EQ(std::get<std::string>(file.find(1234)->get_field(1)), text(1234));
+}
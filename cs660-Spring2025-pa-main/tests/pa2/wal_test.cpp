@@ -0,0 +1,141 @@
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <thread>
+#include "test_file.hpp"
+
+namespace {
+    size_t count(const db::DbFile &file) {
+        size_t n = 0;
+        for (auto it = file.begin(); it != file.end(); ++it) {
+            n++;
+        }
+        return n;
+    }
+} // namespace
+
+TEST(WalTest, Recover) {
+    const std::string heap = testFile("heap.db");
+    const std::string tree = testFile("tree.db");
+    const std::string log = testFile("test.log");
+    for (const std::string &name: {heap, tree, log}) {
+        std::remove(name.c_str());
+    }
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::Database &database = db::getDatabase();
+    constexpr int n = 20000;
+
+    // Commit, then stop without writing the pages that are still in the buffer pool.
+    EXPECT_EXIT({
+        database.getBufferPool().openLog(log);
+        database.add(std::make_unique<db::HeapFile>(heap, td));
+        database.add(std::make_unique<db::BTreeFile>(tree, td, 0));
+        for (int i = 0; i < n; i++) {
+            database.get(heap).insertTuple({{i, "apple", i * 0.5}});
+            database.get(tree).insertTuple({{i, "apple", i * 0.5}});
+        }
+        database.getBufferPool().commit();
+        std::_Exit(0);
+    }, ::testing::ExitedWithCode(0), "");
+    EXPECT_GT(std::filesystem::file_size(log), 0);
+
+    database.getBufferPool().openLog(log);
+    EXPECT_EQ(std::filesystem::file_size(log), 0);
+    database.add(std::make_unique<db::HeapFile>(heap, td));
+    database.add(std::make_unique<db::BTreeFile>(tree, td, 0));
+    EXPECT_EQ(count(database.get(heap)), n);
+    EXPECT_EQ(count(database.get(tree)), n);
+    auto &file = dynamic_cast<db::BTreeFile &>(database.get(tree));
+    EXPECT_EQ(file.find(n / 2)->get_field(2), db::field_t{n / 4.0});
+    EXPECT_THROW(database.getBufferPool().openLog(log), std::logic_error);
+}
+
+TEST(WalTest, ChangeDuringCommit) {
+    const std::string name = testFile("pages.db");
+    const std::string log = testFile("test.log");
+    std::remove(name.c_str());
+    std::remove(log.c_str());
+    db::Database &database = db::getDatabase();
+    db::BufferPool &bufferPool = database.getBufferPool();
+
+    // Commit and flush while writers that marked their page dirty are halfway through their change.
+    EXPECT_EXIT({
+        bufferPool.openLog(log);
+        database.add(std::make_unique<db::DbFile>(name, db::TupleDesc()));
+        db::PinnedPage done(bufferPool, {name, 1});
+        done.latch().lock();
+        done.markDirty();
+        std::fill_n((*done).data(), 100, 1);
+        bufferPool.flushPage({name, 1});
+        std::fill_n((*done).data() + 100, 100, 2);
+        done.latch().unlock();
+
+        db::PinnedPage halfway(bufferPool, {name, 0});
+        halfway.latch().lock();
+        halfway.markDirty();
+        std::fill_n((*halfway).data(), 100, 3);
+        bufferPool.commit();
+        std::_Exit(0);
+    }, ::testing::ExitedWithCode(0), "");
+
+    // Only the change that was whole by the commit was logged.
+    bufferPool.openLog(log);
+    database.add(std::make_unique<db::DbFile>(name, db::TupleDesc()));
+    const db::Page &halfway = bufferPool.getPage({name, 0});
+    EXPECT_EQ(std::count(halfway.begin(), halfway.end(), 0), db::DEFAULT_PAGE_SIZE);
+    const db::Page &done = bufferPool.getPage({name, 1});
+    EXPECT_EQ(std::count(done.begin(), done.begin() + 100, 1), 100);
+    EXPECT_EQ(std::count(done.begin() + 100, done.begin() + 200, 2), 100);
+}
+
+TEST(WalTest, GroupCommit) {
+    const std::string name = testFile("tree.db");
+    const std::string log = testFile("test.log");
+    std::remove(name.c_str());
+    std::remove(log.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db::Database &database = db::getDatabase();
+    db::BufferPool &bufferPool = database.getBufferPool();
+    EXPECT_THROW(bufferPool.commit(), std::logic_error);
+    bufferPool.openLog(log);
+    const db::WriteAheadLog &wal = *bufferPool.getLog();
+    database.add(std::make_unique<db::BTreeFile>(name, td, 0, db::BTreeOptions{.blink = true}));
+    db::DbFile &file = database.get(name);
+
+    // Dirty pages are logged before they are evicted.
+    constexpr int n = 20000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "apple", i * 0.5}});
+    }
+    EXPECT_GT(wal.getSyncs(), 0);
+    bufferPool.commit();
+    size_t syncs = wal.getSyncs();
+    bufferPool.commit();
+    EXPECT_EQ(wal.getSyncs(), syncs);
+
+    constexpr int threads = 4;
+    constexpr int commits = 200;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < commits; i++) {
+                file.insertTuple({{n + i * threads + t, "banana", 0.0}});
+                bufferPool.commit();
+            }
+        });
+    }
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+    EXPECT_LE(wal.getSyncs(), syncs + threads * commits);
+    EXPECT_EQ(count(file), n + threads * commits);
+
+    bufferPool.checkpoint();
+    EXPECT_EQ(std::filesystem::file_size(log), 0);
+    file.insertTuple({{-1, "cherry", 0.0}});
+    bufferPool.commit();
+    EXPECT_GT(std::filesystem::file_size(log), 0);
+}
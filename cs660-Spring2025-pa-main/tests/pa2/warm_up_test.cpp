@@ -0,0 +1,56 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+TEST(WarmUpTest, SavedPages) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    std::string name = testFile("warm.db");
+    std::string saved = testFile("warm.pages");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+    db.add(std::make_unique<db::HeapFile>(name, td));
+    db::DbFile &file = db.get(name);
+    for (int i = 0; file.getNumPages() < 30; i++) {
+        file.insertTuple({{i, "apple", i * 0.5}});
+    }
+    bufferPool.flushFile(name);
+    bufferPool.discardFile(name);
+
+    std::vector<size_t> hot{20, 21, 22, 23, 24, 3};
+    for (size_t i = 5; i < 15; i++) {
+        hot.push_back(i);
+    }
+    for (size_t i: hot) {
+        bufferPool.getPage({name, i});
+    }
+    // A page beyond the end of the file is not read back.
+    bufferPool.getPage({name, file.getNumPages() + 5});
+    bufferPool.savePages(saved);
+    bufferPool.discardFile(name);
+
+    // The saved pages are read back in order, and only once.
+    const auto &reads = file.getReads();
+    size_t before = reads.size();
+    EXPECT_EQ(bufferPool.warmUp(saved).get(), hot.size());
+    std::sort(hot.begin(), hot.end());
+    EXPECT_EQ(std::vector<size_t>(reads.begin() + before, reads.end()), hot);
+    for (size_t i: hot) {
+        EXPECT_TRUE(bufferPool.contains({name, i}));
+    }
+    EXPECT_EQ(bufferPool.warmUp(saved).get(), 0);
+
+    // Files removed before or during the warm-up are skipped.
+    bufferPool.discardFile(name);
+    auto loading = bufferPool.warmUp(saved);
+    db.remove(name);
+    EXPECT_LE(loading.get(), hot.size());
+    for (size_t i: hot) {
+        EXPECT_FALSE(bufferPool.contains({name, i}));
+    }
+    EXPECT_EQ(bufferPool.warmUp(saved).get(), 0);
+    std::remove(saved.c_str());
+    EXPECT_EQ(bufferPool.warmUp(saved).get(), 0);
+}
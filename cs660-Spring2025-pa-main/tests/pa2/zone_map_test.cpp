@@ -0,0 +1,76 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <gtest/gtest.h>
+#include "test_file.hpp"
+
+namespace {
+    std::vector<int> scanIds(const db::HeapFile &file, const std::vector<db::Predicate> &predicates) {
+        std::vector<int> ids;
+        file.scan(predicates, [&](const db::Tuple &t) { ids.push_back(std::get<int>(t.get_field(0))); });
+        return ids;
+    }
+} // namespace
+
+TEST(ZoneMapTest, Predicate) {
+    db::Tuple t({3, "apple", 2.5});
+    EXPECT_TRUE((db::Predicate{0, db::op_t::EQ, 3}.matches(t)));
+    EXPECT_TRUE((db::Predicate{1, db::op_t::LT, std::string("banana")}.matches(t)));
+    EXPECT_FALSE((db::Predicate{2, db::op_t::GT, 2.5}.matches(t)));
+    EXPECT_TRUE((db::Predicate{2, db::op_t::GE, 2.5}.mayMatch(0, 2.5)));
+    EXPECT_FALSE((db::Predicate{0, db::op_t::EQ, 3}.mayMatch(4, 10)));
+    EXPECT_FALSE((db::Predicate{0, db::op_t::NE, 3}.mayMatch(3, 3)));
+}
+
+TEST(ZoneMapTest, SkipPages) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"ts", "name", "price"});
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    constexpr int n = 10000;
+    for (int i = 0; i < n; i++) {
+        file.insertTuple({{i, "apple", (i % 10) * 1.0}});
+    }
+    EXPECT_THROW(scanIds(file, {{0, db::op_t::LT, 1.0}}), std::logic_error);
+
+    db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+    bufferPool.flushFile(name);
+    bufferPool.discardFile(name);
+    size_t reads = file.getReads().size();
+    auto ids = scanIds(file, {{0, db::op_t::GE, 5000}, {0, db::op_t::LT, 5100}, {2, db::op_t::EQ, 3.0}});
+    ASSERT_EQ(ids.size(), 10);
+    EXPECT_EQ(ids.front(), 5003);
+    // 53 tuples fit in a page: the range covers three pages, the first of which is only partially in the range.
+    EXPECT_LE(file.getReads().size() - reads, 3);
+
+    // Deleted tuples no longer match, and a page that becomes empty is skipped.
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        int ts = std::get<int>((*it).get_field(0));
+        if (ts >= 5000 && ts < 5100 && ts % 2 == 1) {
+            file.deleteTuple(it);
+        }
+    }
+    EXPECT_EQ(scanIds(file, {{0, db::op_t::GE, 5000}, {0, db::op_t::LT, 5100}}).size(), 50);
+    EXPECT_TRUE(scanIds(file, {{0, db::op_t::GT, n}}).empty());
+}
+
+TEST(ZoneMapTest, Reopen) {
+    const std::string name = testFile("heap.db");
+    std::remove(name.c_str());
+    db::TupleDesc td({db::type_t::INT, db::type_t::DOUBLE}, {"ts", "price"});
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    for (int i = 0; i < 5000; i++) {
+        db::getDatabase().get(name).insertTuple({{i, i * 0.5}});
+    }
+    db::getDatabase().remove(name);
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+
+    // The first scan reads every page and learns the zone maps, the second one skips.
+    EXPECT_EQ(scanIds(file, {{1, db::op_t::LE, 10.0}}).size(), 21);
+    db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+    bufferPool.discardFile(name);
+    size_t reads = file.getReads().size();
+    EXPECT_EQ(scanIds(file, {{1, db::op_t::LE, 10.0}}).size(), 21);
+    EXPECT_EQ(file.getReads().size() - reads, 1);
+}